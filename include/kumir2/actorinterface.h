@@ -1,10 +1,17 @@
 #ifndef ACTORINTERFACE_H
 #define ACTORINTERFACE_H
 #include <QtCore>
+#include <deque>
+#include <string>
 
 class QMenu;
 class QWidget;
 
+namespace VM {
+class AnyValue;
+class Variable;
+}
+
 namespace Shared
 {
 
@@ -83,6 +90,15 @@ public /*types*/:
     /** Function list (for convience usage) */
     typedef QList<Function> FunctionList;
 
+    /** Pure synchronous function called directly by VM thread.
+     * Arguments and return value are native VM values (records as VM::Record),
+     * error text (if any) should be assigned to the last argument
+     */
+    typedef VM::AnyValue (*IntrinsicFunction)(
+            const std::deque<VM::Variable> & arguments,
+            std::wstring * error
+            );
+
 public /*methods*/:
 
     /* === Generic actor information === */
@@ -164,6 +180,13 @@ public /*methods*/:
      */
     virtual EvaluationStatus evaluate(quint32 id, const QVariantList & arguments) { Q_UNUSED(id); Q_UNUSED(arguments); return ES_Error; }
 
+    /** Returns native implementation of method by its internal ID, or null
+     * if method must be evaluated through 'evaluate'.
+     * The function must be pure: no GUI access, no actor state change
+     * and no asynchronous execution
+     */
+    virtual IntrinsicFunction intrinsicFunction(quint32 id) const { Q_UNUSED(id); return 0; }
+
     /** Last evaluated method return-value */
     virtual QVariant result() const { return QVariant::Invalid; }
 
@@ -2,6 +2,7 @@
 #define ANALIZER_COMPILERINTERFACE_H
 
 #include <kumir2-libs/dataformats/ast.h>
+#include <kumir2-libs/dataformats/ast_expression.h>
 #include <QString>
 #include <QList>
 
@@ -17,6 +18,23 @@ enum RunTarget {
 class ASTCompilerInterface {
 public:
     virtual const AST::DataPtr abstractSyntaxTree() const = 0;
+
+    /** Parses boolean expression as if it was written at the given line
+      * of analized source, for example breakpoint condition
+      * @param lineNo IN: line number from 0
+      * @param text IN: expression text
+      * @param module OUT: module containing line
+      * @param algorithm OUT: algorithm containing line
+      * @param error OUT: error message (or empty)
+      * @returns expression tree or null in case of error
+      */
+    inline virtual AST::ExpressionPtr parseExpression(
+            int /*lineNo*/,
+            const QString & /*text*/,
+            AST::ModulePtr & /*module*/,
+            AST::AlgorithmPtr & /*algorithm*/,
+            QString & error
+            ) const { error = "Expressions parsing is not supported"; return AST::ExpressionPtr(); }
 };
 
 class ExternalExecutableCompilerInterface
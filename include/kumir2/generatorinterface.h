@@ -2,6 +2,12 @@
 #define GENERATOR_INTERFACE_H
 
 #include <kumir2-libs/dataformats/ast.h>
+#include <kumir2-libs/dataformats/ast_expression.h>
+
+namespace Kumir {
+class AbstractInputBuffer;
+class AbstractOutputBuffer;
+}
 
 namespace Shared {
 
@@ -27,9 +33,46 @@ public:
             QString & mimeType,
             QString & fileSuffix
             ) = 0;
+    /** Generates breakpoint condition to be evaluated within
+      * executable made by generateExecutable from the same tree
+      * @param tree IN: abstract syntax tree of executable
+      * @param module IN: module containing breakpoint line
+      * @param algorithm IN: algorithm containing breakpoint line
+      * @param condition IN: boolean expression
+      * @param out OUT: output buffer to write
+      * @param error OUT: generation error (or empty)
+      */
+    inline virtual void generateBreakpointCondition(
+            const AST::DataPtr /*tree*/,
+            const AST::ModulePtr /*module*/,
+            const AST::AlgorithmPtr /*algorithm*/,
+            const AST::ExpressionPtr /*condition*/,
+            QByteArray & /*out*/,
+            QString & error
+            ) { error = "Breakpoint conditions are not supported"; }
+
     virtual void setOutputToText(bool flag) = 0;
     virtual void setVerbose(bool v) = 0;
     virtual void setTemporaryDir(const QString & path, bool autoclean) = 0;
+
+    /** Returns true if generator can execute program within current process */
+    inline virtual bool hasInProcessRunSupport() const { return false; }
+
+    /** Compiles AST and runs its entry point within current process
+      * @param tree IN: abstract syntax tree
+      * @param arguments IN: main algorithm arguments
+      * @param input IN: console input buffer or null to use stdin
+      * @param output IN: console output buffer or null to use stdout
+      * @param error OUT: runtime or compilation error (or empty)
+      * @returns program exit status
+      */
+    inline virtual int runInProcess(
+            const AST::DataPtr /*tree*/,
+            const QStringList & /*arguments*/,
+            Kumir::AbstractInputBuffer * /*input*/,
+            Kumir::AbstractOutputBuffer * /*output*/,
+            QString & error
+            ) { error = "In-process run is not supported"; return -1; }
 };
 
 }
@@ -2,6 +2,7 @@
 #define RUN_INTERFACE
 
 #include <QtCore>
+#include <kumir2-libs/dataformats/ast.h>
 #if QT_VERSION >= 0x050000
 #include <QtWidgets>
 #else
@@ -21,6 +22,7 @@ public:
         QString executableFileName;
         QByteArray executableData;
         QString sourceData;
+        AST::DataPtr abstractSyntaxTree; // optional, for native code backends
     };
 
     enum StopReason { SR_Done, SR_UserInteraction, SR_InputRequest, SR_Error, SR_UserTerminated };
@@ -57,6 +57,7 @@ and '|' is 'or'):
         name: class Name
         returnType: class BaseType | None
         async_: bool
+        traits: "pure" | "query" | "gui"
         arguments: (class Argument)*
 
     class BaseType :=
@@ -131,6 +132,16 @@ Some actor methods should be 'Asynchronous', what means that they run in separat
 This class provides transparent and convient layout to developer not to implement this
 feature hisself.
 
+1.2.5. Method execution traits
+
+Each method might declare its "traits" in JSON:
+    "pure"  -- the result depends on arguments only;
+    "query" -- the method reads actor state, but does not change it and does not touch GUI;
+    "gui"   -- (default) the method might change actor state or GUI.
+Non-GUI methods having scalar arguments and return value are called by VM
+directly from its thread using generated static thunks (see
+ActorInterface::intrinsicFunction), without arguments marshalling and waiting.
+
 
                         2. SCRIPT WORKFLOW
 
@@ -754,10 +765,15 @@ class Method:
             self.return_type = BaseType(None, json_node["returnType"])
         else:
             self.return_type = None
+        if "traits" in json_node:
+            self.traits = str(json_node["traits"])
+        else:
+            self.traits = "gui"
+        assert self.traits in ["pure", "query", "gui"]
         if "async" in json_node:
             self.async_ = bool(json_node["async"])
         else:
-            self.async_ = self.return_type is None
+            self.async_ = self.return_type is None and self.traits == "gui"
         self.arguments = []
         if "arguments" in json_node:
             for arg in json_node["arguments"]:
@@ -765,6 +781,26 @@ class Method:
                 argument = Argument(arg)
                 self.arguments.append(argument)
 
+    def is_direct_callable(self):
+        """
+        Checks if method might be called by VM directly from its thread
+
+        rtype:      bool
+        return:     True if method is not GUI-related and uses scalar values only
+        """
+        plain_types = ["int", "qreal", "bool", "QString", "QChar"]
+        if self.traits == "gui" or self.async_:
+            return False
+        if self.return_type and self.return_type.get_qt_name() not in plain_types:
+            return False
+        for argument in self.arguments:
+            assert isinstance(argument, Argument)
+            if argument.dimension > 0 or argument.reference:
+                return False
+            if argument.base_type.get_qt_name() not in plain_types:
+                return False
+        return True
+
     def get_cpp_declaration(self):
         """
         C++ method declaraion
@@ -1455,6 +1491,11 @@ class PluginCppClass(CppClassBase):
             self._module.get_base_cpp_class_name(),
             self._module.get_module_cpp_namespace()
         )
+        direct_methods = list(filter(lambda method: method.is_direct_callable(), module.methods))
+        if direct_methods:
+            self.extra_implementations.append(self._direct_call_instance_implementation())
+        for method in direct_methods:
+            self.extra_implementations.append(self._direct_call_implementation(method))
         self.class_declaration_suffix = """
 private:
     template <typename T> inline static QVector<T> toVector1(const QVariant & v)
@@ -1501,6 +1542,89 @@ private:
     }
         """
 
+    def _direct_call_instance_implementation(self):
+        """
+        Creates an accessor to plugin instance used by direct call thunks
+
+        :rtype:     str
+        :return:    implementation of static PluginClass*& directCallInstance()
+        """
+        return """
+/* public static */ %s*& %s::directCallInstance()
+{
+    static %s* instance = nullptr;
+    return instance;
+}
+        """ % (self.class_name, self.class_name, self.class_name)
+
+    def _direct_call_implementation(self, method):
+        """
+        Creates a static thunk to call non-GUI method directly from VM thread
+
+        :type   method: Method
+        :param  method: direct callable method
+        :rtype:         unicode
+        :return:        implementation of static VM::AnyValue directCall...(args, error)
+        """
+        assert isinstance(method, Method)
+        assert method.is_direct_callable()
+        from_vm = {
+            "int": "args.at(%d).toInt()",
+            "qreal": "args.at(%d).toReal()",
+            "bool": "args.at(%d).toBool()",
+            "QChar": "QChar(uint(args.at(%d).toChar()))",
+            "QString": "QString::fromStdWString(args.at(%d).toString())"
+        }
+        to_vm = {
+            "int": "VM::AnyValue(result)",
+            "qreal": "VM::AnyValue(VM::real(result))",
+            "bool": "VM::AnyValue(result)",
+            "QChar": "VM::AnyValue(Kumir::Char(result.unicode()))",
+            "QString": "VM::AnyValue(result.toStdWString())"
+        }
+        body = "%s* self = directCallInstance();\n" % self.class_name
+        body += "self->errorText_.clear();\n"
+        if not method.arguments:
+            body += "Q_UNUSED(args);\n"
+        args = []
+        for index, argument in enumerate(method.arguments):
+            assert isinstance(argument, Argument)
+            qt_name = argument.base_type.get_qt_name()
+            body += "const %s = %s;\n" % (
+                argument.get_cpp_local_variable_declaration(),
+                from_vm[qt_name] % index
+            )
+            args += [argument.name.get_cpp_value()]
+        # noinspection PyUnresolvedReferences
+        call = "self->module_->run%s(%s)" % (method.name.get_camel_case_cpp_value(), string.join(args, ", "))
+        if method.return_type:
+            body += "const %s result = %s;\n" % (method.return_type.get_qt_name(), call)
+        else:
+            body += call + ";\n"
+        body += "if (self->errorText_.length() > 0) {\n"
+        body += "    if (error) {\n"
+        body += "        error->assign(self->errorText_.toStdWString());\n"
+        body += "    }\n"
+        body += "    return VM::AnyValue();\n"
+        body += "}\n"
+        if method.return_type:
+            body += "return %s;\n" % to_vm[method.return_type.get_qt_name()]
+        else:
+            body += "return VM::AnyValue();\n"
+        return """
+/* public static */ VM::AnyValue %s::directCall%s(const std::deque<VM::Variable> & args, std::wstring * error)
+{
+    /* %s: %s method called from VM thread */
+%s
+}
+        """ % (
+            self.class_name,
+            method.name.get_camel_case_cpp_value(),
+            method.name.get_ascii_value(),
+            method.traits,
+            _add_indent(body)
+        )
+
     # noinspection PyPep8Naming
     def constructorImplementation(self):
         """
@@ -2189,6 +2313,45 @@ private:
 }
         """ % self.class_name
 
+    # noinspection PyPep8Naming
+    def intrinsicFunctionCppImplementation(self):
+        """
+        Creates intrinsicFunction C++ implementation
+
+        :rtype:     str
+        :return:    implementation of IntrinsicFunction intrinsicFunction(quint32) const
+        """
+        switch_body = ""
+        for method in self._module.methods:
+            assert isinstance(method, Method)
+            if method.is_direct_callable():
+                switch_body += "case 0x%04x: return &directCall%s;  /* %s */\n" % (
+                    self._module.methods.index(method),
+                    method.name.get_camel_case_cpp_value(),
+                    method.name.get_ascii_value()
+                )
+        return """
+/* public */ Shared::ActorInterface::IntrinsicFunction %s::intrinsicFunction(quint32 index) const
+{
+    // The module might be not created at a time of call,
+    // so check it propertly
+    if (!module_) {
+        return nullptr;
+    }
+    // Native implementations provided by module have priority
+    Shared::ActorInterface::IntrinsicFunction moduleIntrinsic = module_->intrinsicFunction(index);
+    if (moduleIntrinsic) {
+        return moduleIntrinsic;
+    }
+    switch (index) {
+%s
+        default: {
+            return nullptr;
+        }
+    }
+}
+        """ % (self.class_name, _add_indent(_add_indent(switch_body)))
+
     # noinspection PyPep8Naming
     def connectSyncCppImplementation(self):
         """
@@ -2214,6 +2377,8 @@ private:
         """
         body = "module_ = new %s(this);\n" % self._module.get_module_cpp_class_name()
         methods = self._module.methods
+        if list(filter(lambda method: method.is_direct_callable(), methods)):
+            body += "directCallInstance() = this;\n"
         async_methods = list(filter(lambda method: method.async_, methods))
         if self._module.settings:
             body += self._module.settings.get_settings_page_creation("settingsPage_").strip() + "\n\n"
@@ -2796,6 +2961,23 @@ class ModuleBaseCppClass(CppClassBase):
         return """
 /* public virtual */ void %s::handleGuiReady()
 {
+}
+        """ % self.class_name
+
+    # noinspection PyPep8Naming
+    def intrinsicFunctionCppImplementation(self):
+        """
+        Creates default intrinsicFunction implementation to be overridden
+        by module providing pure native functions
+
+        :rtype:     str
+        :return:    implementation of IntrinsicFunction intrinsicFunction(quint32) const
+        """
+        return """
+/* public virtual */ Shared::ActorInterface::IntrinsicFunction %s::intrinsicFunction(quint32 index) const
+{
+    Q_UNUSED(index);  // By default all methods are evaluated by plugin
+    return nullptr;
 }
         """ % self.class_name
 
@@ -3378,8 +3560,13 @@ def create_plugin_source_file(module, target_dir=""):
     for customType in module.types:
         assert isinstance(customType, BaseType)
         static_functions += customType.get_cpp_custom_type_encode_decode() + "\n"
+    vm_includes = ""
+    if list(filter(lambda method: method.is_direct_callable(), module.methods)):
+        # This is the only translation unit of actor to declare VM and stdlib static data
+        vm_includes = "\n// Kumir VM values for direct calls\n#include <kumir2-libs/vm/variant.hpp>\n"
 
     substitutions = {
+        "vmIncludes": vm_includes,
         "headerFileName": file_base_name + ".h",
         "moduleBaseHeaderFileName": module.get_base_cpp_class_name().lower() + ".h",
         "moduleHeaderFileName": module.get_module_cpp_class_name().lower() + ".h",
@@ -3402,7 +3589,7 @@ every build time
 #include "$headerFileName"
 #include "$moduleBaseHeaderFileName"
 #include "$moduleHeaderFileName"
-
+$vmIncludes
 namespace $namespace {
 
 $staticFunctions
@@ -405,6 +405,16 @@ Right click to navigate target</source>
         <source>Width in characters:</source>
         <translation>Ширина в символах:</translation>
     </message>
+    <message>
+        <location filename="../../../src/plugins/coregui/iosettingseditorpage.ui" line="82"/>
+        <source>Scrollback</source>
+        <translation>Прокрутка</translation>
+    </message>
+    <message>
+        <location filename="../../../src/plugins/coregui/iosettingseditorpage.ui" line="88"/>
+        <source>Lines kept for each launch:</source>
+        <translation>Хранить строк для каждого запуска:</translation>
+    </message>
 </context>
 <context>
     <name>CoreGUI::KumirProgram</name>
@@ -1638,6 +1648,11 @@ p, li { white-space: pre-wrap; }
         <source>&gt;&gt; %1:%2:%3 - %4 - Process started</source>
         <translation>&gt;&gt; %1:%2:%3 - %4 - Начало выполнения</translation>
     </message>
+    <message>
+        <location filename="../../../src/plugins/coregui/terminal_onesession.cpp" line="771"/>
+        <source> - output truncated, first %1 lines are not shown</source>
+        <translation> - вывод сокращён, первые строки (%1) не показаны</translation>
+    </message>
     <message>
         <location filename="../../../src/plugins/coregui/terminal_onesession.cpp" line="769"/>
         <source>&gt;&gt; %1:%2:%3 - %4 - Process finished</source>
@@ -10,9 +10,131 @@ You should change it corresponding to functionality.
 #include <QtGui>
 #include "complexnumbersmodule.h"
 #include <kumir2-libs/stdlib/kumirstdlib.hpp>
+#include <kumir2-libs/vm/variant.hpp>
 
 namespace ActorComplexNumbers {
 
+static Complex plus(const Complex& x, const Complex& y)
+{
+    Complex result;
+    result.re = x.re + y.re;
+    result.im = x.im + y.im;
+    return result;
+}
+
+static Complex minus(const Complex& x, const Complex& y)
+{
+    Complex result;
+    result.re = x.re - y.re;
+    result.im = x.im - y.im;
+    return result;
+}
+
+static Complex multiply(const Complex& x, const Complex& y)
+{
+    Complex result;
+    result.re = x.re*y.re - x.im*y.im;
+    result.im = x.re*y.im + x.im*y.re;
+    return result;
+}
+
+// Returns false in case of division by zero
+static bool divide(const Complex& x, const Complex& y, Complex& result)
+{
+    result.im = result.re = 0.0;
+    if (y.re==0 && y.im==0) {
+        return false;
+    }
+    qreal factor = y.re*y.re + y.im*y.im;
+    result.re = (x.re*y.re+x.im*y.im) / factor;
+    result.im = (x.im*y.re-x.re*y.im) / factor;
+    return true;
+}
+
+static const char * DivisionByZeroError = "Деление на комплексный нуль";
+
+
+/* === Intrinsics: called by VM directly with native record values === */
+
+static Complex fromRecord(const VM::Variable & value)
+{
+    const VM::Record record = value.toRecord();
+    Complex result;
+    result.re = record.fields.at(0).toReal();
+    result.im = record.fields.at(1).toReal();
+    return result;
+}
+
+static VM::AnyValue toRecord(const Complex& x)
+{
+    VM::Record record;
+    record.fields.reserve(2);
+    record.fields.push_back(VM::AnyValue(VM::real(x.re)));
+    record.fields.push_back(VM::AnyValue(VM::real(x.im)));
+    return VM::AnyValue(record);
+}
+
+static VM::AnyValue intrinsicRe(const std::deque<VM::Variable> & args, Kumir::String *)
+{
+    return VM::AnyValue(VM::real(fromRecord(args.at(0)).re));
+}
+
+static VM::AnyValue intrinsicIm(const std::deque<VM::Variable> & args, Kumir::String *)
+{
+    return VM::AnyValue(VM::real(fromRecord(args.at(0)).im));
+}
+
+static VM::AnyValue intrinsicPlus(const std::deque<VM::Variable> & args, Kumir::String *)
+{
+    return toRecord(plus(fromRecord(args.at(0)), fromRecord(args.at(1))));
+}
+
+static VM::AnyValue intrinsicMinus(const std::deque<VM::Variable> & args, Kumir::String *)
+{
+    return toRecord(minus(fromRecord(args.at(0)), fromRecord(args.at(1))));
+}
+
+static VM::AnyValue intrinsicMultiply(const std::deque<VM::Variable> & args, Kumir::String *)
+{
+    return toRecord(multiply(fromRecord(args.at(0)), fromRecord(args.at(1))));
+}
+
+static VM::AnyValue intrinsicDivide(const std::deque<VM::Variable> & args, Kumir::String * error)
+{
+    Complex result;
+    if (!divide(fromRecord(args.at(0)), fromRecord(args.at(1)), result)) {
+        if (error) {
+            error->assign(Kumir::Core::fromUtf8(DivisionByZeroError));
+        }
+        return VM::AnyValue();
+    }
+    return toRecord(result);
+}
+
+static VM::AnyValue intrinsicAssign(const std::deque<VM::Variable> & args, Kumir::String *)
+{
+    Complex result;
+    result.re = args.at(0).toReal();
+    result.im = 0;
+    return toRecord(result);
+}
+
+Shared::ActorInterface::IntrinsicFunction ComplexNumbersModule::intrinsicFunction(quint32 index) const
+{
+    // Indeces are the same as methods order in complexnumbers.json
+    switch (index) {
+    case 0x0000: return &intrinsicRe;
+    case 0x0001: return &intrinsicIm;
+    case 0x0002: return &intrinsicPlus;
+    case 0x0003: return &intrinsicMinus;
+    case 0x0004: return &intrinsicMultiply;
+    case 0x0005: return &intrinsicDivide;
+    case 0x0006: return &intrinsicAssign; // from int
+    case 0x0007: return &intrinsicAssign; // from real
+    default: return nullptr;
+    }
+}
+
 ComplexNumbersModule::ComplexNumbersModule(ExtensionSystem::KPlugin * parent)
     : ComplexNumbersModuleBase(parent)
 {
@@ -54,42 +176,28 @@ qreal ComplexNumbersModule::runIm(const Complex& x)
 
 Complex ComplexNumbersModule::runOperatorPLUS(const Complex& x, const Complex& y)
 {
-    Complex result;
-    result.re = x.re + y.re;
-    result.im = x.im + y.im;
-    return result;
+    return plus(x, y);
 }
 
 
 Complex ComplexNumbersModule::runOperatorMINUS(const Complex& x, const Complex& y)
 {
-    Complex result;
-    result.re = x.re - y.re;
-    result.im = x.im - y.im;
-    return result;
+    return minus(x, y);
 }
 
 
 Complex ComplexNumbersModule::runOperatorASTERISK(const Complex& x, const Complex& y)
 {
-    Complex result;
-    result.re = x.re*y.re - x.im*y.im;
-    result.im = x.re*y.im + x.im*y.re;
-    return result;
+    return multiply(x, y);
 }
 
 
 Complex ComplexNumbersModule::runOperatorSLASH(const Complex& x, const Complex& y)
 {
     Complex result;
-    result.im = result.re = 0.0;
-    if (y.re==0 && y.im==0) {
-        setError(QString::fromUtf8("Деление на комплексный нуль"));
-        return result;
+    if (!divide(x, y, result)) {
+        setError(QString::fromUtf8(DivisionByZeroError));
     }
-    qreal factor = y.re*y.re + y.im*y.im;
-    result.re = (x.re*y.re+x.im*y.im) / factor;
-    result.im = (x.im*y.re-x.re*y.im) / factor;
     return result;
 }
 
@@ -30,6 +30,8 @@ public:
     ComplexNumbersModule(ExtensionSystem::KPlugin * parent);
     inline void reloadSettings(ExtensionSystem::SettingsPtr, const QStringList & ) {}
     inline void changeGlobalState(ExtensionSystem::GlobalState, ExtensionSystem::GlobalState) {}
+    // Native implementations of arithmetic to be called directly by VM
+    Shared::ActorInterface::IntrinsicFunction intrinsicFunction(quint32 index) const;
 
 public slots:
     // Reset actor state before program starts
@@ -16,16 +16,13 @@
 
 namespace Robot25D {
 
-class CellGraphicsItem;
-
+/* Simulation state of a cell only. Graphics items are owned by
+ * RobotView, so the model might be used without any scene. */
 struct RobotCell {
     inline RobotCell() {
         painted = pointed = flag = false;
         wallUp = wallDown = wallLeft = wallRight = false;
-        cellItem = NULL;
-        pointItem = NULL;
-        wallUpItem = wallDownItem = wallLeftItem = wallRightItem = NULL;
-        paintState = 0;
+        baseZOrder = 0.0;
     }
     bool painted;
     bool wallUp;
@@ -34,16 +31,7 @@ struct RobotCell {
     bool wallRight;
     bool pointed;
     bool flag;
-    quint8 paintState;
     qreal baseZOrder;
-    CellGraphicsItem *cellItem;
-
-    QGraphicsItem *pointItem;
-
-    QGraphicsItem *wallUpItem;
-    QGraphicsItem *wallDownItem;
-    QGraphicsItem *wallLeftItem;
-    QGraphicsItem *wallRightItem;
 };
 
 }
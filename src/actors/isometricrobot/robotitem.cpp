@@ -13,12 +13,14 @@ RobotItem::RobotItem(Robot25D::RobotModel * model, const QDir & imagesDir, Robot
     , _timerId(0)
 {
     _model = model;
-    connect(_model, SIGNAL(robotMoved()), this, SLOT(handleModelRobotMoved()));
-    connect(_model, SIGNAL(robotCrashed()), this, SLOT(handleModelRobotCrashed()));
-    connect(_model, SIGNAL(robotTurnedLeft()), this, SLOT(handleModelRobotTurnedLeft()));
-    connect(_model, SIGNAL(robotTurnedRight()), this, SLOT(handleModelRobotTurnedRight()));
-    connect(_model, SIGNAL(cellPainted(int,int)), this, SLOT(handleModelCellPainted(int,int)));
-
+    connect(_model, SIGNAL(robotMoved()), this, SLOT(handleModelRobotMoved()), Qt::DirectConnection);
+    connect(_model, SIGNAL(robotCrashed()), this, SLOT(handleModelRobotCrashed()), Qt::DirectConnection);
+    connect(_model, SIGNAL(robotTurnedLeft()), this, SLOT(handleModelRobotTurnedLeft()), Qt::DirectConnection);
+    connect(_model, SIGNAL(robotTurnedRight()), this, SLOT(handleModelRobotTurnedRight()), Qt::DirectConnection);
+    connect(_model, SIGNAL(cellPainted(int,int)), this, SLOT(handleModelCellPainted(int,int)), Qt::DirectConnection);
+
+    _requestedCount = _completedCount = 0;
+    _processPosted = false;
     _animationType = NoAnimation;
     _pulse = 0.0;
     _currentStep = 0;
@@ -57,6 +59,7 @@ RobotItem::RobotItem(Robot25D::RobotModel * model, const QDir & imagesDir, Robot
 
     _mutex_image = new QMutex;
     _mutex_animation = new QMutex;
+    _animationFinished = new QWaitCondition;
 
     reset();
 }
@@ -64,56 +67,211 @@ RobotItem::RobotItem(Robot25D::RobotModel * model, const QDir & imagesDir, Robot
 void RobotItem::setSpeed(int msec)
 {
     _duration = msec;
-    if (_timerId)
+    if (_timerId) {
         killTimer(_timerId);
-    _timerId = startTimer(msec);
+        _timerId = startTimer(msec);
+    }
 }
 
 void RobotItem::waitForAnimated()
 {
-    forever {
-        _mutex_animation->lock();
-        AnimationType anim = _animationType;
+    if (QThread::currentThread() == thread()) {
+        // Requests are processed by this thread, so can't block here
+        forever {
+            _mutex_animation->lock();
+            bool done = !_animated || _completedCount == _requestedCount;
+            _mutex_animation->unlock();
+            if (done)
+                break;
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+        }
+        return;
+    }
+    QMutexLocker locker(_mutex_animation);
+    while (_animated && _completedCount != _requestedCount) {
+        _animationFinished->wait(_mutex_animation);
+    }
+}
+
+void RobotItem::enqueue(RequestType type, int x, int y)
+{
+    Request request;
+    request.type = type;
+    request.cell.x = x;
+    request.cell.y = y;
+    QMutexLocker locker(_mutex_animation);
+    _requests.enqueue(request);
+    _requestedCount ++;
+    if (!_processPosted) {
+        _processPosted = true;
+        QMetaObject::invokeMethod(this, "processRequests", Qt::QueuedConnection);
+    }
+}
+
+void RobotItem::processRequests()
+{
+    _mutex_animation->lock();
+    _processPosted = false;
+    if (_animated) {
+        if (_animationType==NoAnimation && !_requests.isEmpty()) {
+            startAnimation(_requests.dequeue());
+        }
         _mutex_animation->unlock();
-        if (anim==NoAnimation)
-            QApplication::processEvents();
-            break;
-        msleep(1);
+        return;
+    }
+    // Without animation everything changed since last call
+    // is shown at once
+    const QList<Request> requests = _requests;
+    _requests.clear();
+    _mutex_animation->unlock();
+    if (requests.isEmpty())
+        return;
+
+    applyRequests(requests);
+
+    _mutex_animation->lock();
+    _completedCount += requests.size();
+    _animationFinished->wakeAll();
+    _mutex_animation->unlock();
+    emit evaluationFinished();
+}
+
+void RobotItem::applyRequests(const QList<Request> &requests)
+{
+    const quint8 maxState = _view->_grass.size()-1;
+    bool robotChanged = false;
+    foreach (const Request & request, requests) {
+        if (request.type==PaintRequest) {
+            const Point2Di & pnt = request.cell;
+            setCellPaintState(pnt.x, pnt.y, _model->isPainted(pnt.x, pnt.y)? maxState : 0);
+        }
+        else {
+            robotChanged = true;
+        }
+    }
+    if (robotChanged) {
+        _targetView->setVisible(false);
+        _currentView->setVisible(true);
+        setFrameNo(directionFrameNo());
+        setPosition(calculateRobotPosition(_model->scenePosition()));
+        _currentView->update();
     }
-    QApplication::processEvents();
 }
 
-void RobotItem::handleAnimationFinished()
+void RobotItem::startAnimation(const Request &request)
 {
+    _currentRequest = request;
+    _currentStep = 0;
+    _pulse = 0.0;
+    if (request.type==MoveRequest) {
+        _moveTargetPoint = calculateRobotPosition(_model->scenePosition());
+        _animationType = SetPosition;
+    }
+    else if (request.type==TurnLeftRequest) {
+        _startFrame = frameNo();
+        _endFrame = _startFrame + _framesPerTurn;
+        _animationType = ChangeFrameNo;
+    }
+    else if (request.type==TurnRightRequest) {
+        _startFrame = frameNo();
+        _endFrame = _startFrame - _framesPerTurn;
+        _animationType = ChangeFrameNo;
+    }
+    else if (request.type==PaintRequest) {
+        _animatedCellPosition = request.cell;
+        _animationType = DoPaint;
+    }
+    else {
+        // Crash has no animation, just show broken image
+        setFrameNo(frameNo());
+        _currentView->update();
+        _completedCount ++;
+        _animationFinished->wakeAll();
+        if (!_requests.isEmpty())
+            startAnimation(_requests.dequeue());
+        return;
+    }
+    if (!_timerId)
+        _timerId = startTimer(_duration);
+}
+
+void RobotItem::finishAnimation()
+{
+    stopTimer();
     if (_animationType==SetPosition) {
         _currentView->setVisible(false);
         GraphicsImageItem *tmp = _currentView;
         _currentView = _targetView;
         _targetView = tmp;
+        _currentView->setImage(currentImage());
     }
-    emit evaluationFinished();
+    else if (_animationType==ChangeFrameNo) {
+        setFrameNo(_endFrame);
+    }
+    else if (_animationType==DoPaint) {
+        setCellPaintState(_animatedCellPosition.x, _animatedCellPosition.y, _view->_grass.size()-1);
+    }
+    _animationType = NoAnimation;
+    _pulse = 0.0;
+    _currentStep = 0;
+    _completedCount ++;
+    _animationFinished->wakeAll();
+    if (!_requests.isEmpty())
+        startAnimation(_requests.dequeue());
 }
 
-void RobotItem::handleModelRobotMoved()
+void RobotItem::stopAnimation()
 {
-    Point2Di point = _model->scenePosition();
-    Point3Dr target = calculateRobotPosition(point);
-    if (_animated) {
-        _mutex_animation->lock();
-        _animationType = SetPosition;
-        _moveTargetPoint = target;
-        _mutex_animation->unlock();
+    // Interrupted change will be shown by applyRequests
+    stopTimer();
+    _requests.prepend(_currentRequest);
+    _animationType = NoAnimation;
+    _pulse = 0.0;
+    _currentStep = 0;
+}
+
+void RobotItem::stopTimer()
+{
+    // Timer can't be stopped from VM thread, so it will be stopped
+    // by the next timerEvent
+    if (_timerId && QThread::currentThread()==thread()) {
+        killTimer(_timerId);
+        _timerId = 0;
     }
-    else {
-        setPosition(target);
-        emit evaluationFinished();
+}
+
+void RobotItem::setCellPaintState(int x, int y, quint8 state)
+{
+    if (x<0 || y<0 || x>=_model->sizeX() || y>=_model->sizeY() || _view->_cells.isEmpty())
+        return;
+    RobotView::CellItems & items = _view->cellItems(x, y);
+    if (items.paintState!=state && items.cellItem) {
+        items.paintState = state;
+        items.cellItem->setBrush(_view->_grass[state]);
+        items.cellItem->update();
     }
 }
 
+qint16 RobotItem::directionFrameNo() const
+{
+    qint16 rotationsCount = 0;
+    if (East==_model->direction())
+        rotationsCount = 1;
+    else if (North==_model->direction())
+        rotationsCount = 2;
+    else if (West==_model->direction())
+        rotationsCount = 3;
+    return rotationsCount * _framesPerTurn;
+}
+
+void RobotItem::handleModelRobotMoved()
+{
+    enqueue(MoveRequest);
+}
+
 void RobotItem::handleModelRobotCrashed()
 {
-    setFrameNo(frameNo());
-    _currentView->update();
+    enqueue(CrashRequest);
 }
 
 Point3Dr RobotItem::calculateRobotPosition(const Point2Di point) const
@@ -189,55 +347,17 @@ void RobotItem::setPosition(const Point3Dr &point)
 
 void RobotItem::handleModelRobotTurnedLeft()
 {
-    _startFrame = frameNo();
-    _endFrame = frameNo() + _framesPerTurn;
-
-    if (_animated) {
-        _mutex_animation->lock();
-        _animationType = ChangeFrameNo;
-        _mutex_animation->unlock();
-     }
-    else {
-        setFrameNo(_endFrame);
-        emit evaluationFinished();
-    }
+    enqueue(TurnLeftRequest);
 }
 
 void RobotItem::handleModelRobotTurnedRight()
 {
-    int start = frameNo();
-    int end = start - _framesPerTurn;
-
-    _startFrame = start;
-    _endFrame = end;
-
-    if (_animated) {
-        _mutex_animation->lock();
-        _animationType = ChangeFrameNo;
-        _mutex_animation->unlock();
-    }
-    else {
-        setFrameNo(_endFrame);
-        emit evaluationFinished();
-    }
+    enqueue(TurnRightRequest);
 }
 
 void RobotItem::handleModelCellPainted(int x, int y)
 {
-    if (_animated) {
-        _mutex_animation->lock();
-        _animationType = DoPaint;
-        _animatedCellPosition.x = x;
-        _animatedCellPosition.y = y;
-        _mutex_animation->unlock();
-    }
-    else {
-        _model->cellAt(x, y).paintState = _view->_grass.size()-1;
-        CellGraphicsItem *item = _model->cellAt(x, y).cellItem;
-        item->setBrush(_view->_grass[_model->cellAt(x, y).paintState]);
-        item->update();
-        emit evaluationFinished();
-    }
+    enqueue(PaintRequest, x, y);
 }
 
 
@@ -261,10 +381,15 @@ void RobotItem::setFrameNo(qint16 no)
 void RobotItem::setAnimated(bool v)
 {
     _mutex_animation->lock();
-    _animationType = NoAnimation;
-    //    an_animation->stop();
-    _pulse = 0.0;
+    if (!v && _animationType!=NoAnimation) {
+        stopAnimation();
+    }
     _animated = v;
+    if (!_requests.isEmpty() && !_processPosted) {
+        _processPosted = true;
+        QMetaObject::invokeMethod(this, "processRequests", Qt::QueuedConnection);
+    }
+    _animationFinished->wakeAll();
     _mutex_animation->unlock();
 }
 
@@ -274,8 +399,12 @@ qreal RobotItem::pulse() const
 }
 
 void RobotItem::timerEvent(QTimerEvent *event) {
+    bool finished = false;
     _mutex_animation->lock();
-    if (_animationType==NoAnimation) {
+    if (_animationType==NoAnimation || event->timerId()!=_timerId) {
+        killTimer(event->timerId());
+        if (event->timerId()==_timerId)
+            _timerId = 0;
         event->ignore();
     }
     else {
@@ -284,13 +413,13 @@ void RobotItem::timerEvent(QTimerEvent *event) {
         _currentStep += 8;
         if (_currentStep>=_duration)
         {
-            handleAnimationFinished();
-            _animationType = NoAnimation;
-            _pulse = 0.0;
-            _currentStep = 0;
+            finishAnimation();
+            finished = true;
         }
     }
     _mutex_animation->unlock();
+    if (finished)
+        emit evaluationFinished();
 }
 
 void RobotItem::setPulse(qreal v)
@@ -341,25 +470,23 @@ void RobotItem::setPulse(qreal v)
     }
     else if (_animationType==DoPaint) {
         Point2Di pnt = _animatedCellPosition;
-        quint8 curState = _model->cellAt(pnt.x, pnt.y).paintState;
         quint8 maxState = _view->_grass.size()-1;
-        quint8 newState = qCeil(v * maxState);
-        if (curState!=newState) {
-            CellGraphicsItem *item = _model->cellAt(pnt.x, pnt.y).cellItem;
-            item->setBrush(_view->_grass[newState]);
-            item->update();
-        }
+        setCellPaintState(pnt.x, pnt.y, qCeil(v * maxState));
     }
 }
 
 void RobotItem::prepareForDelete()
 {
+    _model->disconnect(this);
     if (_view->scene()) {
         _view->scene()->removeItem(_currentView);
         _view->scene()->removeItem(_targetView);
     }
-    killTimer(_timerId);
-
+    _mutex_animation->lock();
+    stopTimer();
+    _animated = false;
+    _animationFinished->wakeAll();
+    _mutex_animation->unlock();
 }
 
 RobotItem::~RobotItem()
@@ -368,22 +495,27 @@ RobotItem::~RobotItem()
     delete _targetView;
     delete _mutex_image;
     delete _mutex_animation;
+    delete _animationFinished;
 
 }
 
 void RobotItem::reset()
 {
-    qint8 initialRotationsCount = 0;
-
-    if (East==_model->direction())
-        initialRotationsCount = 1;
-    else if (North==_model->direction())
-        initialRotationsCount = 2;
-    else if (West==_model->direction())
-        initialRotationsCount = 3;
-
+    // Changes queued before reset belong to the old model state, so
+    // they are dropped and everyone waiting for them is released
+    _mutex_animation->lock();
+    stopTimer();
+    _requests.clear();
+    _animationType = NoAnimation;
+    _pulse = 0.0;
+    _currentStep = 0;
+    _completedCount = _requestedCount;
+    _animationFinished->wakeAll();
+    _mutex_animation->unlock();
+    _targetView->setVisible(false);
+    _currentView->setVisible(true);
     setPosition(calculateRobotPosition(_model->scenePosition()));
-    setFrameNo(initialRotationsCount * _framesPerTurn);
+    setFrameNo(directionFrameNo());
 }
 
 }
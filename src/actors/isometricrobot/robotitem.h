@@ -29,6 +29,8 @@ public:
     qreal pulse() const;
     inline int speed() const { return _duration; }
     void prepareForDelete();
+    /** Blocks until all model changes made so far are animated;
+     *  returns immediately when animation is off */
     void waitForAnimated();
     Point3Dr calculateRobotPosition(const Point2Di point) const;
     ~RobotItem();
@@ -46,13 +48,29 @@ protected:
     QImage currentImage() const;
     virtual void timerEvent(QTimerEvent *);
 protected slots:
-    void handleAnimationFinished();
+    void processRequests();
+    /* Model signal handlers are called directly in the thread changing
+     * the model, so they only enqueue requests for the GUI thread */
     void handleModelRobotMoved();
     void handleModelRobotCrashed();
     void handleModelRobotTurnedLeft();
     void handleModelRobotTurnedRight();
     void handleModelCellPainted(int x, int y);
 private:
+    enum RequestType { MoveRequest, TurnLeftRequest, TurnRightRequest, PaintRequest, CrashRequest };
+    struct Request {
+        RequestType type;
+        Point2Di cell;
+    };
+    void enqueue(RequestType type, int x = 0, int y = 0);
+    void startAnimation(const Request &request);
+    void finishAnimation();
+    void stopAnimation();
+    void stopTimer();
+    void applyRequests(const QList<Request> &requests);
+    void setCellPaintState(int x, int y, quint8 state);
+    qint16 directionFrameNo() const;
+
     bool _animated;
     class RobotView *_view;
     QList<QImage> _movie;
@@ -67,6 +85,11 @@ private:
 
     qreal _pulse;
     enum AnimationType { NoAnimation, ChangeFrameNo, SetPosition, DoPaint } _animationType;
+    Request _currentRequest;
+    QQueue<Request> _requests;
+    quint32 _requestedCount;
+    quint32 _completedCount;
+    bool _processPosted;
     qint16 _startFrame, _endFrame;
     Point2Di _animatedCellPosition;
 
@@ -75,6 +98,7 @@ private:
 
     QMutex *_mutex_image;
     QMutex *_mutex_animation;
+    QWaitCondition *_animationFinished;
 
     RobotModel * _model;
 };
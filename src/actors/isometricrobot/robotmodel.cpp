@@ -126,7 +126,7 @@ bool RobotModel::isWall() const
 {
     bool v = false;
     Point2Di rp = scenePosition();
-    RobotCell cell = _field[rp.y][rp.x];
+    const RobotCell & cell = _field[rp.y][rp.x];
     if (direction()==North)
         v = cell.wallUp;
     if (direction()==South)
@@ -141,7 +141,7 @@ bool RobotModel::isWall() const
 bool RobotModel::isPainted() const
 {
     Point2Di rp = scenePosition();
-    RobotCell cell = _field[rp.y][rp.x];
+    const RobotCell & cell = _field[rp.y][rp.x];
     bool v = cell.painted;
     return v;
 }
@@ -152,7 +152,7 @@ bool RobotModel::isPainted(int x, int y) const
         return false;
     if (x>=_field[y].size() || x<0)
         return false;
-    RobotCell cell = _field[y][x];
+    const RobotCell & cell = _field[y][x];
     return cell.painted;
 }
 
@@ -162,7 +162,7 @@ bool RobotModel::isPointed(int x, int y) const
         return false;
     if (x>=_field[y].size() || x<0)
         return false;
-    RobotCell cell = _field[y][x];
+    const RobotCell & cell = _field[y][x];
     return cell.pointed;
 }
 
@@ -256,7 +256,6 @@ bool RobotModel::loadEnvironment(const Schema::Environment &env)
             _field[y][x].wallRight = x==env.size.width()-1;
             _field[y][x].wallUp = y==0;
             _field[y][x].wallDown = y==env.size.height()-1;
-            _field[y][x].cellItem = NULL;
         }
     }
     // Create vertical walls
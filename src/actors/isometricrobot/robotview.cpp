@@ -48,7 +48,6 @@ void RobotView::waitForAnimated()
     if (_robotItem) {
         _robotItem->waitForAnimated();
     }
-    update();
 }
 
 RobotView::~RobotView()
@@ -76,8 +75,11 @@ void RobotView::createField()
         }
     }
     _allItems.clear();
+    _cells.clear();
     if (_model->field().empty())
         return;
+    const CellItems noItems = { NULL, NULL, 0 };
+    _cells = QVector<CellItems>(_model->sizeX() * _model->sizeY(), noItems);
     QPointF sceneTopLeft, sceneBottomRight;
     QRectF rect;
     for (int i=0; i<_model->field().size(); i++) {
@@ -100,12 +102,6 @@ void RobotView::createField()
             QGraphicsItem *wh = createHorizontalWall(x,y,_model->field()[y][x].baseZOrder-0.1);
             QGraphicsItem *wv = createVerticalWall(x,y,_model->field()[y][x].baseZOrder-0.1);
             _allItems << wh << wv;
-            _model->field()[y][x].wallLeftItem = wv;
-            _model->field()[y][x].wallUpItem = wh;
-            if (y>0)
-                _model->field()[y-1][x].wallDownItem = wh;
-            if (x>0)
-                _model->field()[y][x-1].wallRightItem = wv;
             wv->setVisible(_model->field()[y][x].wallLeft);
             wh->setVisible(_model->field()[y][x].wallUp);
         }
@@ -116,7 +112,6 @@ void RobotView::createField()
         QGraphicsItem *w = createHorizontalWall(x, _model->field().size(), _model->field().last()[x].baseZOrder+0.001);
         _allItems << w;
         _model->field().last()[x].wallDown = true;
-        _model->field().last()[x].wallDownItem = w;
 
     }
 
@@ -124,7 +119,6 @@ void RobotView::createField()
         QGraphicsItem *w = createVerticalWall(_model->field()[y].size(), y, _model->field()[y].last().baseZOrder+0.001);
         _allItems << w;
         _model->field()[y].last().wallRight = true;
-        _model->field()[y].last().wallRightItem = w;
     }
 
     for (int y=0; y<_model->field().size(); ++y) {
@@ -136,16 +130,6 @@ void RobotView::createField()
         }
     }
 
-    for (int y=0; y<_model->field().size(); y++) {
-        for (int x=0; x<_model->field()[y].size(); x++) {
-            RobotCell cell = _model->field()[y][x];
-            Q_CHECK_PTR(cell.wallDownItem);
-            Q_CHECK_PTR(cell.wallLeftItem);
-            Q_CHECK_PTR(cell.wallRightItem);
-            Q_CHECK_PTR(cell.wallUpItem);
-        }
-    }
-
     for (int i=0; i<_model->field()[0].size(); i++) {
         createEmptyCell(i,-1,false,false,true);
         createEmptyCell(i,_model->field().size(),false,false,true);
@@ -574,7 +558,7 @@ QRectF RobotView::createEmptyCell(int x, int y,
     result->setParentItem(this);
     result->setZValue(-1000);
     if (y>=0&&y<_model->field().size()&&x>=0&&x<_model->field()[0].size()) {
-        _model->field()[y][x].cellItem = result;
+        cellItems(x, y).cellItem = result;
         updateCell(x,y,painted);
     }
     else {
@@ -615,7 +599,7 @@ QRectF RobotView::createEmptyCell(int x, int y,
 //        scene()->addItem(item);
         item->setParentItem(this);
         _allItems << item;
-        _model->field()[y][x].pointItem = item;
+        cellItems(x, y).pointItem = item;
         item->setVisible(pointed);
     }
 
@@ -626,8 +610,8 @@ QRectF RobotView::createEmptyCell(int x, int y,
 void RobotView::updateCell(int x, int y, bool painted)
 {
     _model->updateCell(x, y, painted);
-    _model->field()[y][x].paintState = painted? _grass.size()-1 : 0;
-    QGraphicsPolygonItem *item = _model->field()[y][x].cellItem;
+    cellItems(x, y).paintState = painted? _grass.size()-1 : 0;
+    QGraphicsPolygonItem *item = cellItems(x, y).cellItem;
     item->setPen(QPen(QColor("black"),CellBorderSize));
     item->setBrush(painted? (_grass.last()) : (_grass.first()));
     item->update();
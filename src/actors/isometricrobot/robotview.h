@@ -18,6 +18,7 @@ class NewEnvironmentDialog;
 namespace Robot25D {
 
 class Plugin;
+class CellGraphicsItem;
 
 class RobotView :
         public QObject,
@@ -85,7 +86,15 @@ signals:
     void sync();
 
 private /* fields */:
+    struct CellItems {
+        CellGraphicsItem *cellItem;
+        QGraphicsItem *pointItem;
+        quint8 paintState;
+    };
+    inline CellItems & cellItems(int x, int y) { return _cells[y * _model->sizeX() + x]; }
+
     RobotModel * _model;
+    QVector<CellItems> _cells; // row-major, same size as model field
     QList<QGraphicsItem*> _allItems;
     QPointF _offset;
     RobotItem *_robotItem;
@@ -2,7 +2,12 @@
 #include <assert.h>
 #include <QDebug>
 #include <QFile>
+#include <QBuffer>
+#include <QCache>
+#include <QMutex>
 #include <QStringList>
+#include <QtEndian>
+#include <string.h>
 
 namespace ActorRobot {
 
@@ -28,6 +33,12 @@ void CFieldItem::setWalls(int wallByte)
 	rightWall = (wallByte & RIGHT_WALL) ? true : false;
 }
 
+int CFieldItem::wallByte() const
+{
+	return (upWall ? UP_WALL : 0) | (downWall ? DOWN_WALL : 0) |
+		(leftWall ? LEFT_WALL : 0) | (rightWall ? RIGHT_WALL : 0);
+}
+
 
 ConsoleField::ConsoleField(uint32_t rows, uint32_t cols)
 {
@@ -163,6 +174,52 @@ bool ConsoleField::goRight()
 	return true;
 }
 
+static const char BINARY_FIELD_MAGIC[4] = { 'K', 'R', 'F', 'B' };
+static const quint16 BINARY_FIELD_VERSION = 1;
+static const int BINARY_HEADER_SIZE = 24;
+static const int BINARY_CELL_SIZE = 16;
+static const int BINARY_MAX_SIZE = 0xFFFF;
+
+enum BinaryCellFlags {
+	WALLS_MASK = 0x0F,
+	COLORED_FLAG = 0x10,
+	MARK_FLAG = 0x20
+};
+
+static float floatFromLittleEndian(const uchar *src)
+{
+	const quint32 bits = qFromLittleEndian<quint32>(src);
+	float result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+static void floatToLittleEndian(float value, uchar *dst)
+{
+	quint32 bits;
+	memcpy(&bits, &value, sizeof(bits));
+	qToLittleEndian<quint32>(bits, dst);
+}
+
+// Parsed fields keyed by source data: the same fields are loaded
+// again and again while checking a task
+static QCache<QByteArray, ConsoleField> &fieldsCache()
+{
+	static QCache<QByteArray, ConsoleField> cache(1 << 20); // cells
+	return cache;
+}
+
+static QMutex &fieldsCacheMutex()
+{
+	static QMutex mutex;
+	return mutex;
+}
+
+bool ConsoleField::isBinary(const char *data, qint64 size)
+{
+	return size >= BINARY_HEADER_SIZE && 0 == memcmp(data, BINARY_FIELD_MAGIC, sizeof(BINARY_FIELD_MAGIC));
+}
+
 int ConsoleField::loadFromFile(const QString &filename)
 {
 	QFile f(filename);
@@ -170,10 +227,128 @@ int ConsoleField::loadFromFile(const QString &filename)
 		qDebug() << QString::fromUtf8("Ошибка открытия обстановки!");
 		return 1;
 	}
+	if (isBinary(f.peek(BINARY_HEADER_SIZE))) {
+		const qint64 size = f.size();
+		uchar *mapped = f.map(0, size);
+		if (mapped) {
+			const int result = loadFromBinary(reinterpret_cast<const char *>(mapped), size);
+			f.unmap(mapped);
+			return result;
+		}
+	}
 	return loadFromDataStream(&f);
 }
 
 int ConsoleField::loadFromDataStream(QIODevice *stream)
+{
+	const QByteArray data = stream->readAll();
+	stream->close();
+	return loadFromData(data);
+}
+
+int ConsoleField::loadFromData(const QByteArray &data)
+{
+	{
+		QMutexLocker locker(&fieldsCacheMutex());
+		const ConsoleField *cached = fieldsCache().object(data);
+		if (cached) {
+			*this = *cached;
+			return 0;
+		}
+	}
+
+	int result;
+	if (isBinary(data)) {
+		result = loadFromBinary(data.constData(), data.size());
+	} else {
+		QBuffer buffer;
+		buffer.setData(data);
+		buffer.open(QIODevice::ReadOnly);
+		result = loadFromText(&buffer);
+	}
+
+	if (0 == result) {
+		QMutexLocker locker(&fieldsCacheMutex());
+		fieldsCache().insert(data, new ConsoleField(*this), roboRows * roboCols);
+	}
+	return result;
+}
+
+int ConsoleField::loadFromBinary(const char *data, qint64 size)
+{
+	if (!isBinary(data, size)) {
+		return 2;
+	}
+	const uchar *header = reinterpret_cast<const uchar *>(data);
+	if (qFromLittleEndian<quint16>(header + 4) != BINARY_FIELD_VERSION) {
+		return 3;
+	}
+	const quint32 rows = qFromLittleEndian<quint32>(header + 8);
+	const quint32 cols = qFromLittleEndian<quint32>(header + 12);
+	const quint32 row = qFromLittleEndian<quint32>(header + 16);
+	const quint32 col = qFromLittleEndian<quint32>(header + 20);
+
+	if (rows == 0 || cols == 0 || rows > BINARY_MAX_SIZE || cols > BINARY_MAX_SIZE) {
+		return 4;
+	}
+	if (size < BINARY_HEADER_SIZE + qint64(rows) * cols * BINARY_CELL_SIZE) {
+		return 4;
+	}
+	if (row >= rows || col >= cols) {
+		return 6;
+	}
+
+	reset(rows, cols);
+	const uchar *cell = header + BINARY_HEADER_SIZE;
+	for (uint32_t r = 0; r < rows; r++) {
+		for (uint32_t c = 0; c < cols; c++, cell += BINARY_CELL_SIZE) {
+			CFieldItem &it = items[r][c];
+			const uchar flags = cell[0];
+			it.setWalls(flags & WALLS_MASK);
+			it.upWall = it.upWall || r == 0;
+			it.downWall = it.downWall || r + 1 == rows;
+			it.leftWall = it.leftWall || c == 0;
+			it.rightWall = it.rightWall || c + 1 == cols;
+			it.isColored = (flags & COLORED_FLAG) != 0;
+			it.mark = (flags & MARK_FLAG) != 0;
+			it.upChar = QChar(qFromLittleEndian<quint16>(cell + 2));
+			it.downChar = QChar(qFromLittleEndian<quint16>(cell + 4));
+			it.radiation = floatFromLittleEndian(cell + 8);
+			it.temperature = floatFromLittleEndian(cell + 12);
+		}
+	}
+	roboRow = row;
+	roboCol = col;
+	return 0;
+}
+
+QByteArray ConsoleField::toBinary() const
+{
+	QByteArray result(BINARY_HEADER_SIZE + int(roboRows * roboCols) * BINARY_CELL_SIZE, '\0');
+	uchar *header = reinterpret_cast<uchar *>(result.data());
+	memcpy(header, BINARY_FIELD_MAGIC, sizeof(BINARY_FIELD_MAGIC));
+	qToLittleEndian<quint16>(BINARY_FIELD_VERSION, header + 4);
+	qToLittleEndian<quint32>(roboRows, header + 8);
+	qToLittleEndian<quint32>(roboCols, header + 12);
+	qToLittleEndian<quint32>(roboRow, header + 16);
+	qToLittleEndian<quint32>(roboCol, header + 20);
+
+	uchar *cell = header + BINARY_HEADER_SIZE;
+	for (uint32_t r = 0; r < roboRows; r++) {
+		for (uint32_t c = 0; c < roboCols; c++, cell += BINARY_CELL_SIZE) {
+			const CFieldItem &it = items[r][c];
+			cell[0] = uchar(it.wallByte() |
+				(it.isColored ? COLORED_FLAG : 0) | (it.mark ? MARK_FLAG : 0));
+			qToLittleEndian<quint16>(it.upChar.unicode(), cell + 2);
+			qToLittleEndian<quint16>(it.downChar.unicode(), cell + 4);
+			floatToLittleEndian(it.radiation, cell + 8);
+			floatToLittleEndian(it.temperature, cell + 12);
+		}
+	}
+	return result;
+}
+
+int ConsoleField::loadFromText(QIODevice *stream)
 {
 	int NStrok = 0;
 
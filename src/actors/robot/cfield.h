@@ -4,6 +4,7 @@
 #include <inttypes.h>
 #include <vector>
 #include <QString>
+#include <QByteArray>
 class QIODevice;
 
 namespace ActorRobot {
@@ -17,10 +18,22 @@ enum WallDir {
 
 static const int MIN_TEMP = -273;
 
+/* Binary field format, little-endian:
+ *   header (24 bytes): 'K','R','F','B', uint16 version, uint16 reserved,
+ *     uint32 rows, uint32 cols, uint32 robot row, uint32 robot col;
+ *   rows*cols cells (16 bytes each) in row-major order:
+ *     uint8 flags: bits 0..3 are walls as WallDir, bit 4 colored, bit 5 mark,
+ *     uint8 reserved, uint16 upChar, uint16 downChar, uint16 reserved,
+ *     float32 radiation, float32 temperature.
+ * Cells are fixed size, so file is loaded without parsing.
+ */
+static const char BINARY_FIELD_SUFFIX[] = "rfb";
+
 struct CFieldItem
 {
 	CFieldItem();
 	void setWalls(int wallByte);
+	int wallByte() const;
 
 	bool isColored;
 	bool mark;
@@ -58,11 +71,20 @@ public:
 	uint32_t  robotRow() const { return roboRow; }
 	uint32_t  Cols() const { return roboCols; }
 	uint32_t  Rows() const { return roboRows; }
+	void setRobotPos(uint32_t row, uint32_t col) { roboRow = row; roboCol = col; }
 
 	int loadFromFile(const QString &filename);
 	int loadFromDataStream(QIODevice *stream);
+	int loadFromData(const QByteArray &data);
+	int loadFromBinary(const char *data, qint64 size);
+	QByteArray toBinary() const;
+
+	static bool isBinary(const char *data, qint64 size);
+	static bool isBinary(const QByteArray &data) { return isBinary(data.constData(), data.size()); }
 
 private:
+	int loadFromText(QIODevice *stream);
+
 	std::vector< std::vector<CFieldItem> > items;
 	uint32_t roboRow, roboCol;
 	uint32_t roboRows, roboCols;
@@ -0,0 +1,315 @@
+#include "fieldgraphics.h"
+#include "cfield.h"
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QtCore/qmath.h>
+
+namespace ActorRobot {
+
+static const int TILE_CELLS = 16;
+static const int MAX_TILE_PIXELS = 1024;
+static const int TILES_CACHE_BYTES = 64 * 1024 * 1024;
+
+FieldGraphics::FieldGraphics(int rows, int cols, int cellSize, const QPointF &origin)
+	: rows(rows), cols(cols), cellSize(cellSize), origin(origin)
+{
+	Cell empty;
+	empty.walls = 0;
+	empty.colored = false;
+	empty.mark = false;
+	empty.upChar = ' ';
+	empty.downChar = ' ';
+	cells = QVector<Cell>(rows * cols, empty);
+
+	font.setPixelSize(9);
+	font.setPointSize(9);
+	font.setStyle(QFont::StyleNormal);
+	font.setBold(true);
+	font.setStyleHint(QFont::SansSerif);
+	font.setWeight(2);
+
+	letterShift = 2;
+	markShift = 3;
+	markShiftLeft = 6;
+
+	wallTiles.setMaxCost(TILES_CACHE_BYTES);
+	tilesScale = 0;
+
+	setFlag(ItemUsesExtendedStyleOption);
+	setZValue(0.2);
+}
+
+void FieldGraphics::setCell(
+	int row, int col, int wallByte,
+	bool colored, bool mark,
+	QChar upChar, QChar downChar
+) {
+	Cell &c = cell(row, col);
+	if (c.walls != wallByte) {
+		c.walls = wallByte;
+		dropTiles();
+	}
+	c.colored = colored;
+	c.mark = mark;
+	c.upChar = upChar;
+	c.downChar = downChar;
+	updateCell(row, col);
+}
+
+void FieldGraphics::setColored(int row, int col, bool colored)
+{
+	cell(row, col).colored = colored;
+	updateCell(row, col);
+}
+
+void FieldGraphics::setMark(int row, int col, bool mark)
+{
+	cell(row, col).mark = mark;
+	updateCell(row, col);
+}
+
+void FieldGraphics::setGridPen(const QPen &pen)
+{
+	prepareGeometryChange();
+	gridPen = pen;
+	dropTiles();
+}
+
+void FieldGraphics::setWallPens(const QPen &bortPen, const QPen &wallPen)
+{
+	prepareGeometryChange();
+	this->bortPen = bortPen;
+	this->wallPen = wallPen;
+	dropTiles();
+}
+
+void FieldGraphics::setColors(const QColor &fillColor, const QColor &textColor)
+{
+	this->fillColor = fillColor;
+	this->textColor = textColor;
+	update();
+}
+
+void FieldGraphics::setShifts(int letterShift, int markShift, int markShiftLeft)
+{
+	this->letterShift = letterShift;
+	this->markShift = markShift;
+	this->markShiftLeft = markShiftLeft;
+	update();
+}
+
+QRectF FieldGraphics::cellRect(int row, int col) const
+{
+	return QRectF(origin.x() + col * cellSize, origin.y() + row * cellSize, cellSize, cellSize);
+}
+
+QRectF FieldGraphics::boundingRect() const
+{
+	// Grid lines stick out of the field by one cell, same as RoboField::drawNet
+	qreal margin = qMax(qMax(bortPen.widthF(), wallPen.widthF()), gridPen.widthF());
+	return QRectF(
+		-cellSize, -cellSize,
+		(cols + 2) * cellSize + 5, (rows + 2) * cellSize
+	).adjusted(-margin, -margin, margin, margin);
+}
+
+void FieldGraphics::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+	const QRectF exposed = option->exposedRect;
+	int row0, row1, col0, col1;
+	bool hasCells = cellRange(exposed, row0, row1, col0, col1);
+
+	if (hasCells) {
+		drawFills(painter, row0, row1, col0, col1);
+	}
+
+	// No widget means rendering to image or printer, so draw as is
+	if (widget) {
+		drawCachedWalls(painter, exposed,
+			QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform()));
+	} else {
+		drawWalls(painter, exposed);
+	}
+
+	if (hasCells) {
+		drawTexts(painter, row0, row1, col0, col1);
+	}
+}
+
+bool FieldGraphics::cellRange(const QRectF &rect, int &row0, int &row1, int &col0, int &col1) const
+{
+	if (rows < 1 || cols < 1 || cellSize < 1) {
+		return false;
+	}
+	// One extra cell around to catch wide pens and shifted texts
+	col0 = qMax(0, qFloor((rect.left() - origin.x()) / cellSize) - 1);
+	col1 = qMin(cols - 1, qFloor((rect.right() - origin.x()) / cellSize) + 1);
+	row0 = qMax(0, qFloor((rect.top() - origin.y()) / cellSize) - 1);
+	row1 = qMin(rows - 1, qFloor((rect.bottom() - origin.y()) / cellSize) + 1);
+	return row0 <= row1 && col0 <= col1;
+}
+
+void FieldGraphics::drawFills(QPainter *painter, int row0, int row1, int col0, int col1) const
+{
+	painter->setPen(fillColor);
+	painter->setBrush(fillColor);
+	for (int i = row0; i <= row1; i++) {
+		for (int j = col0; j <= col1; j++) {
+			if (cell(i, j).colored) {
+				painter->drawRect(cellRect(i, j));
+			}
+		}
+	}
+}
+
+void FieldGraphics::drawWalls(QPainter *painter, const QRectF &rect) const
+{
+	const qreal halfGrid = gridPen.widthF() / 2 + 1;
+	painter->setPen(gridPen);
+	for (int i = -1; i < cols; i++) { // Vertical lines
+		qreal x = i * cellSize + 2 + cellSize / 2 + cellSize / 2 + 2;
+		if (x + halfGrid >= rect.left() && x - halfGrid <= rect.right()) {
+			painter->drawLine(QLineF(x, -cellSize, x, (rows + 1) * cellSize));
+		}
+	}
+	for (int i = -1; i < rows; i++) { // Horizontal lines
+		qreal y = i * cellSize + 2 + cellSize / 2 - 1 + cellSize / 2;
+		if (y + halfGrid >= rect.top() && y - halfGrid <= rect.bottom()) {
+			painter->drawLine(QLineF(-cellSize, y, (cols + 1) * cellSize + 5, y));
+		}
+	}
+
+	int row0, row1, col0, col1;
+	if (!cellRange(rect, row0, row1, col0, col1)) {
+		return;
+	}
+
+	// Each inner wall is drawn once as upper or left side of a cell
+	for (int i = row0; i <= row1; i++) {
+		for (int j = col0; j <= col1; j++) {
+			const QRectF r = cellRect(i, j);
+			const int walls = cell(i, j).walls;
+
+			if (i == 0) {
+				painter->setPen(bortPen);
+				painter->drawLine(r.topLeft(), r.topRight());
+			} else if ((walls & UP_WALL) || (cell(i - 1, j).walls & DOWN_WALL)) {
+				painter->setPen(wallPen);
+				painter->drawLine(r.topLeft(), r.topRight());
+			}
+
+			if (j == 0) {
+				painter->setPen(bortPen);
+				painter->drawLine(r.topLeft(), r.bottomLeft());
+			} else if ((walls & LEFT_WALL) || (cell(i, j - 1).walls & RIGHT_WALL)) {
+				painter->setPen(wallPen);
+				painter->drawLine(r.topLeft(), r.bottomLeft());
+			}
+
+			if (i == rows - 1) {
+				painter->setPen(bortPen);
+				painter->drawLine(r.bottomLeft(), r.bottomRight());
+			}
+			if (j == cols - 1) {
+				painter->setPen(bortPen);
+				painter->drawLine(r.topRight(), r.bottomRight());
+			}
+		}
+	}
+}
+
+void FieldGraphics::drawTexts(QPainter *painter, int row0, int row1, int col0, int col1) const
+{
+	// Positions are the same as of QGraphicsTextItem's created by FieldItm,
+	// which have 4 pixels document margin
+	painter->setFont(font);
+	painter->setPen(textColor);
+	const qreal ascent = painter->fontMetrics().ascent() + 4;
+	const QString markText = QString(QChar(9679));
+
+	for (int i = row0; i <= row1; i++) {
+		for (int j = col0; j <= col1; j++) {
+			const Cell &c = cell(i, j);
+			const qreal ulx = origin.x() + j * cellSize + 4, uly = origin.y() + i * cellSize;
+
+			if (c.upChar.isPrint() && c.upChar != ' ') {
+				painter->drawText(QPointF(ulx, uly - 2 - letterShift + ascent), QString(c.upChar));
+			}
+			if (c.downChar.isPrint() && c.downChar != ' ') {
+#ifdef Q_OS_WIN
+				qreal y = uly + cellSize - 19 - letterShift;
+#else
+				qreal y = uly + cellSize - 17 - letterShift;
+#endif
+				painter->drawText(QPointF(ulx, y + ascent), QString(c.downChar));
+			}
+			if (c.mark) {
+#ifdef Q_OS_WIN
+				QPointF pos(ulx + cellSize - (cellSize / 3) - markShiftLeft, uly - 20 + cellSize - markShift);
+#else
+				QPointF pos(ulx + cellSize - (cellSize / 3) - 2 - markShiftLeft, uly - 18 + cellSize - markShift);
+#endif
+				painter->drawText(pos + QPointF(0, ascent), markText);
+			}
+		}
+	}
+}
+
+void FieldGraphics::drawCachedWalls(QPainter *painter, const QRectF &rect, qreal scale)
+{
+	const qreal tileSize = TILE_CELLS * cellSize;
+	const int tilePixels = qCeil(tileSize * scale);
+	if (tilePixels < 1 || tilePixels > MAX_TILE_PIXELS) {
+		// Zoomed in too much, there are few visible cells to draw anyway
+		drawWalls(painter, rect);
+		return;
+	}
+	if (!qFuzzyCompare(scale, tilesScale)) {
+		wallTiles.clear();
+		tilesScale = scale;
+	}
+
+	const QRectF bounds = boundingRect();
+	const QRectF area = rect & bounds;
+	if (area.isEmpty()) {
+		return;
+	}
+	int tileCol0 = qFloor((area.left() - bounds.left()) / tileSize);
+	int tileCol1 = qFloor((area.right() - bounds.left()) / tileSize);
+	int tileRow0 = qFloor((area.top() - bounds.top()) / tileSize);
+	int tileRow1 = qFloor((area.bottom() - bounds.top()) / tileSize);
+
+	for (int tr = tileRow0; tr <= tileRow1; tr++) {
+		for (int tc = tileCol0; tc <= tileCol1; tc++) {
+			const QRectF tileRect(bounds.left() + tc * tileSize, bounds.top() + tr * tileSize, tileSize, tileSize);
+			const quint32 key = (quint32(tr) << 16) | quint32(tc);
+			QPixmap *tile = wallTiles.object(key);
+			if (!tile) {
+				tile = new QPixmap(tilePixels, tilePixels);
+				tile->fill(Qt::transparent);
+				QPainter tilePainter(tile);
+				tilePainter.setRenderHints(painter->renderHints());
+				tilePainter.scale(tilePixels / tileSize, tilePixels / tileSize);
+				tilePainter.translate(-tileRect.topLeft());
+				drawWalls(&tilePainter, tileRect);
+				tilePainter.end();
+				wallTiles.insert(key, tile, tilePixels * tilePixels * 4);
+			}
+			painter->drawPixmap(tileRect, *tile, QRectF(tile->rect()));
+		}
+	}
+}
+
+void FieldGraphics::updateCell(int row, int col)
+{
+	qreal margin = cellSize / 4 + 1;
+	update(cellRect(row, col).adjusted(-margin, -margin, margin, margin));
+}
+
+void FieldGraphics::dropTiles()
+{
+	wallTiles.clear();
+	update();
+}
+
+} // ActorRobot namespace
@@ -0,0 +1,72 @@
+#ifndef FIELDGRAPHICS_H
+#define FIELDGRAPHICS_H
+
+#include <QGraphicsItem>
+#include <QVector>
+#include <QCache>
+#include <QPixmap>
+#include <QPen>
+#include <QFont>
+
+namespace ActorRobot {
+
+/* Draws the whole field (grid, walls, painted cells, chars and marks)
+ * as a single item from a flat row-major cell array. Only cells
+ * intersecting exposed rect are painted. Grid and walls do not change
+ * in normal mode, so they are rendered into pixmap tiles once per view
+ * scale; painted cells and marks are drawn over the tiles, so changing
+ * a cell repaints just its rect.
+ */
+class FieldGraphics: public QGraphicsItem
+{
+public:
+	FieldGraphics(int rows, int cols, int cellSize, const QPointF &origin);
+
+	void setCell(int row, int col, int wallByte, bool colored, bool mark, QChar upChar, QChar downChar);
+	void setColored(int row, int col, bool colored);
+	void setMark(int row, int col, bool mark);
+
+	void setGridPen(const QPen &pen);
+	void setWallPens(const QPen &bortPen, const QPen &wallPen);
+	void setColors(const QColor &fillColor, const QColor &textColor);
+	void setShifts(int letterShift, int markShift, int markShiftLeft);
+
+	QRectF cellRect(int row, int col) const;
+	QRectF boundingRect() const;
+	void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget);
+
+private:
+	struct Cell {
+		quint8 walls;
+		bool colored;
+		bool mark;
+		QChar upChar, downChar;
+	};
+
+	const Cell &cell(int row, int col) const { return cells[row * cols + col]; }
+	Cell &cell(int row, int col) { return cells[row * cols + col]; }
+
+	bool cellRange(const QRectF &rect, int &row0, int &row1, int &col0, int &col1) const;
+	void drawFills(QPainter *painter, int row0, int row1, int col0, int col1) const;
+	void drawWalls(QPainter *painter, const QRectF &rect) const;
+	void drawTexts(QPainter *painter, int row0, int row1, int col0, int col1) const;
+	void drawCachedWalls(QPainter *painter, const QRectF &rect, qreal scale);
+	void updateCell(int row, int col);
+	void dropTiles();
+
+	int rows, cols, cellSize;
+	QPointF origin;
+	QVector<Cell> cells;
+
+	QPen gridPen, bortPen, wallPen;
+	QColor fillColor, textColor;
+	QFont font;
+	int letterShift, markShift, markShiftLeft;
+
+	QCache<quint32, QPixmap> wallTiles;
+	qreal tilesScale;
+};
+
+} // ActorRobot namespace
+
+#endif // FIELDGRAPHICS_H
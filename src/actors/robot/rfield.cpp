@@ -1,5 +1,6 @@
 #include "rfield.h"
 #include "cfield.h"
+#include "fieldgraphics.h"
 #include "editline.h"
 #include "srobot.h"
 #include "robotview.h"
@@ -825,6 +826,7 @@ RoboField::RoboField(QWidget *parent, RobotModule *actor)
 {
 	old_cell = QPair<int, int>(-1, -1);
 	pressed = false;
+	fieldGraphics = NULL;
 
 	Parent = parent;
 	mode = NORMAL_MODE;
@@ -908,6 +910,17 @@ void RoboField::reloadSettings()
 	for (int i = 0; i < setka.count(); i++) {
 		setka.at(i)->setPen(gridLine);
 	}
+	if (fieldGraphics) {
+		fieldGraphics->setGridPen(gridLine);
+		setupFieldGraphics();
+	}
+}
+
+void RoboField::setupFieldGraphics()
+{
+	fieldGraphics->setWallPens(BortLine, WallLine);
+	fieldGraphics->setColors(FillColor, TextColor);
+	fieldGraphics->setShifts(LetterShift, MarkShift, MarkShiftLeft);
 }
 
 
@@ -933,6 +946,10 @@ void RoboField::setMode(int Mode)
 {
 	mode = Mode;
 	sett = RobotModule::robotSettings();
+	if (mode != NORMAL_MODE && fieldGraphics) {
+		// Editing works with per cell items
+		drawField(fieldSize);
+	}
 	QGraphicsView *view = views().first();
 	if (mode == NORMAL_MODE) {
 		if (this->items().indexOf(keyCursor) > -1) {
@@ -1176,11 +1193,29 @@ void RoboField::drawField(uint FieldSize)
 	fieldSize = FieldSize;
 	int xd = FieldSize, yd = FieldSize;
 
+	if (mode == NORMAL_MODE) {
+		fieldGraphics = new FieldGraphics(rows(), columns(), fieldSize, upLeftCorner(0, 0));
+		setupFieldGraphics();
+		addItem(fieldGraphics);
+	}
+
 	drawNet();
 
 	qDebug() << "Rows:" << rows() << ", Cols:" << columns();
 
-	for (int i = 0; i < rows(); i++) {
+	for (int i = 0; i < rows() && fieldGraphics; i++) {
+		for (int j = 0; j < columns(); j++) {
+			FieldItm *cell = Items[i].at(j);
+			cell->setScene(this);
+			fieldGraphics->setCell(
+				i, j, cell->wallByte(),
+				cell->isColored(), cell->mark,
+				cell->upChar, cell->downChar
+			);
+		}
+	}
+
+	for (int i = 0; i < rows() && !fieldGraphics; i++) {
 		QList<FieldItm *> *row = &Items[i];
 		for (int j = 0; j < columns(); j++) {
 			int ulx = upLeftCorner(i, j).x(), uly = upLeftCorner(i, j).y();
@@ -1341,6 +1376,7 @@ void RoboField::destroyField()
 	clear();
 	setka.clear();
 	robot = NULL;
+	fieldGraphics = NULL;
 	keyCursor = NULL;
 	this->update();
 }
@@ -1626,7 +1662,11 @@ void RoboField::showRightWall(int row, int col)
 
 void RoboField::reverseColor(int row, int col)
 {
-	if (getFieldItem(row, col)->isColored()) {
+	if (fieldGraphics) {
+		FieldItm *cell = getFieldItem(row, col);
+		cell->IsColored = !cell->IsColored;
+		fieldGraphics->setColored(row, col, cell->IsColored);
+	} else if (getFieldItem(row, col)->isColored()) {
 		getFieldItem(row, col)->removeColor();
 	} else {
 		getFieldItem(row, col)->setColorRect(
@@ -1652,7 +1692,11 @@ void RoboField::reverseColorCurrent()
 
 void RoboField::reverseMark(int row, int col)
 {
-	if (getFieldItem(row, col)->mark) {
+	if (fieldGraphics) {
+		FieldItm *cell = getFieldItem(row, col);
+		cell->mark = !cell->mark;
+		fieldGraphics->setMark(row, col, cell->mark);
+	} else if (getFieldItem(row, col)->mark) {
 		getFieldItem(row, col)->removeMark();
 	} else {
 		getFieldItem(row, col)->mark = true;
@@ -1709,6 +1753,11 @@ void RoboField::drawNet()
 	this->setBackgroundBrush(QBrush(bgColor));
 	QPen gridLine = QPen(gridColor, GridWidth);
 
+	if (fieldGraphics) {
+		fieldGraphics->setGridPen(gridLine);
+		return;
+	}
+
 	for (int i = -1; i < columns(); i++) { // Vertical lines
 		setka.append(this->addLine(
 			i * FIELD_SIZE_SMALL + ddx + FIELD_SIZE_SMALL / 2 + 2,
@@ -1755,6 +1804,12 @@ qreal RoboField::m_width() const
  */
 int RoboField::loadFromDataStream(QIODevice *l_File)
 {
+	if (ConsoleField::isBinary(l_File->peek(24))) {
+		ConsoleField source(1, 1);
+		const int error = source.loadFromDataStream(l_File);
+		return error ? error : loadFromConsoleField(source);
+	}
+
 	QString tmp = "";
 	wasEdit = false;
 	int NStrok;
@@ -2217,6 +2272,11 @@ int RoboField::loadFromDataStream(QIODevice *l_File)
  */
 int RoboField::loadFromFile(const QString &fileName)
 {
+	if (QFileInfo(fileName).suffix() == BINARY_FIELD_SUFFIX) {
+		ConsoleField source(1, 1);
+		const int error = source.loadFromFile(fileName);
+		return error ? error : loadFromConsoleField(source);
+	}
 
 	//destroyField();
 
@@ -2672,11 +2732,63 @@ int RoboField::loadFromFile(const QString &fileName)
 	return 0;
 }
 
+/**
+ * Копирование обстановки, загруженной без отображения
+ * (в том числе из двоичного формата)
+ */
+int RoboField::loadFromConsoleField(const ConsoleField &source)
+{
+	createField(source.Rows(), source.Cols());
+	for (uint32_t row = 0; row < source.Rows(); row++) {
+		for (uint32_t col = 0; col < source.Cols(); col++) {
+			const CFieldItem *item = source.getItem(row, col);
+			FieldItm *itm = getFieldItem(row, col);
+			itm->setWalls(item->wallByte());
+			itm->IsColored = item->isColored;
+			itm->mark = item->mark;
+			itm->upChar = item->upChar;
+			itm->downChar = item->downChar;
+			itm->radiation = item->radiation;
+			itm->temperature = item->temperature;
+		}
+	}
+	robo_x = source.robotCol();
+	robo_y = source.robotRow();
+	wasEdit = false;
+	return 0;
+}
+
 int RoboField::saveToFile(QString fileName)
 {
 	QFileInfo fi(fileName);
 	QString name = fi.fileName();
 
+	if (fi.suffix() == BINARY_FIELD_SUFFIX) {
+		ConsoleField binary(rows(), columns());
+		for (int i = 0; i < rows(); i++) {
+			for (int j = 0; j < columns(); j++) {
+				FieldItm *itm = getFieldItem(i, j);
+				CFieldItem *item = binary.getItem(i, j);
+				item->setWalls(itm->wallByte() | item->wallByte());
+				item->isColored = itm->IsColored;
+				item->mark = itm->mark;
+				item->upChar = itm->upChar;
+				item->downChar = itm->downChar;
+				item->radiation = itm->radiation;
+				item->temperature = itm->temperature;
+			}
+		}
+		QFile l_File(fileName);
+		if (!l_File.open(QIODevice::WriteOnly)) {
+			return 1;
+		}
+		binary.setRobotPos(robo_y, robo_x);
+		l_File.write(binary.toBinary());
+		l_File.close();
+		wasEdit = false;
+		return 0;
+	}
+
 	qDebug() << "NewRobot Save file: " << fileName;
 	//QString Title = QString::fromUtf8("Робот - ") + name;
 
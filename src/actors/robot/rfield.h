@@ -16,6 +16,8 @@ namespace ActorRobot {
 class EditLine;
 class RobotModule;
 class SimpleRobot;
+class ConsoleField;
+class FieldGraphics;
 
 class FieldItm: public QGraphicsWidget
 {
@@ -173,6 +175,7 @@ public:
 	void reloadSettings();
 	int loadFromFile(const QString &fileName);
 	int loadFromDataStream(QIODevice *l_File);
+	int loadFromConsoleField(const ConsoleField &source);
 	int saveToFile(QString fileName);
 	void createRobot();
 //	void UpdateColors();
@@ -269,8 +272,10 @@ private:
 	void keyPressEvent(QKeyEvent *keyEvent);
 	void showButtons(bool yes);
 	void createResizeButtons();
+	void setupFieldGraphics();
 
 	SimpleRobot *robot;
+	FieldGraphics *fieldGraphics; // draws field in normal mode instead of per cell items
 	QTimer *timer;
 	QList<QList<FieldItm * > > Items;
 	QList<QGraphicsLineItem *> setka;
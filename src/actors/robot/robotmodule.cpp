@@ -993,7 +993,7 @@ void RobotModule::loadEnv()
 	QString RobotFile = QFileDialog::getOpenFileName(
 		mainWidget(),
 		QString::fromUtf8("Открыть файл"),
-		curDir, "(*.fil)"
+		curDir, "(*.fil *.rfb)"
 	);
 
 	qDebug() << "CurDir" << curDir;
@@ -1160,7 +1160,7 @@ void RobotModule::saveEnv()
 	QString RobotFile = QFileDialog::getSaveFileName(
 		mainWidget(),
 		QString::fromUtf8("Сохранить файл"),
-		curDir, "(*.fil)"
+		curDir, "(*.fil);;(*.rfb)"
 	);
 
 	QFileInfo info(RobotFile);
@@ -1172,7 +1172,7 @@ void RobotModule::saveEnv()
 		return;
 	}
 
-	if (RobotFile.right(4) != ".fil") {
+	if (RobotFile.right(4) != ".fil" && RobotFile.right(4) != ".rfb") {
 		RobotFile += ".fil";
 	}
 
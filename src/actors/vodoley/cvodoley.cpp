@@ -0,0 +1,244 @@
+#include "cvodoley.h"
+
+#include <QFile>
+#include <QIODevice>
+#include <QStringList>
+
+#include <vector>
+
+namespace ActorVodoley {
+
+// 16M states take 64 MB of distances and about a second to search
+static const quint64 MAX_STATES = 1u << 24;
+
+ConsoleVodoley::ConsoleVodoley()
+{
+    setSizes(3, 5, 7);
+    setBaseFill(0, 0, 0);
+    setNeed(1, 1, 1);
+    reset();
+}
+
+void ConsoleVodoley::setSizes(uint a, uint b, uint c)
+{
+    sizes_[A] = a;
+    sizes_[B] = b;
+    sizes_[C] = c;
+}
+
+void ConsoleVodoley::setBaseFill(uint a, uint b, uint c)
+{
+    baseFills_[A] = a;
+    baseFills_[B] = b;
+    baseFills_[C] = c;
+}
+
+void ConsoleVodoley::setNeed(uint a, uint b, uint c)
+{
+    needs_[A] = a;
+    needs_[B] = b;
+    needs_[C] = c;
+}
+
+uint ConsoleVodoley::maxSize() const
+{
+    return qMax(qMax(sizes_[A], sizes_[B]), sizes_[C]);
+}
+
+void ConsoleVodoley::reset()
+{
+    for (int i = 0; i < 3; i++) {
+        fills_[i] = baseFills_[i];
+    }
+    commandsCount_ = 0;
+}
+
+void ConsoleVodoley::pour(int from, int to)
+{
+    commandsCount_ ++;
+    if (OUTSIDE == from) {
+        fills_[to] = sizes_[to];
+    }
+    else if (OUTSIDE == to) {
+        fills_[from] = 0;
+    }
+    else {
+        const uint amount = qMin(fills_[from], sizes_[to] - fills_[to]);
+        fills_[from] -= amount;
+        fills_[to] += amount;
+    }
+}
+
+bool ConsoleVodoley::isReady() const
+{
+    return fills_[A] == needs_[A] || fills_[B] == needs_[A] || fills_[C] == needs_[A];
+}
+
+int ConsoleVodoley::optimalSolution(QList<Command> *solution) const
+{
+    if (solution) {
+        solution->clear();
+    }
+    const uint need = needs_[A];
+    if (baseFills_[A] == need || baseFills_[B] == need || baseFills_[C] == need) {
+        return 0;
+    }
+    if (need > maxSize()) {
+        return -1;
+    }
+    const quint64 statesCount = quint64(sizes_[A] + 1) * (sizes_[B] + 1) * (sizes_[C] + 1);
+    if (statesCount > MAX_STATES) {
+        return -2;
+    }
+
+    // State index is a * (sizeB+1) * (sizeC+1) + b * (sizeC+1) + c;
+    // for each visited state keep its predecessor and command to come
+    const uint strideB = sizes_[C] + 1;
+    const uint strideA = (sizes_[B] + 1) * strideB;
+    std::vector<int> previous(statesCount, -1);
+    std::vector<quint8> commands(statesCount, 0);
+    std::vector<int> queue;
+    queue.reserve(statesCount);
+
+    const int start = baseFills_[A] * strideA + baseFills_[B] * strideB + baseFills_[C];
+    previous[start] = start;
+    queue.push_back(start);
+
+    Command allCommands[12];
+    int commandsCount = 0;
+    for (int from = A; from <= OUTSIDE; from++) {
+        for (int to = A; to <= OUTSIDE; to++) {
+            if (from != to) {
+                allCommands[commandsCount++] = Command(from, to);
+            }
+        }
+    }
+
+    int found = -1;
+    for (size_t head = 0; head < queue.size() && found < 0; head++) {
+        const int state = queue[head];
+        const uint current[3] = {
+            state / strideA, (state % strideA) / strideB, state % strideB
+        };
+        for (int i = 0; i < commandsCount; i++) {
+            const Command & command = allCommands[i];
+            uint next[3] = { current[A], current[B], current[C] };
+            if (OUTSIDE == command.from) {
+                next[command.to] = sizes_[command.to];
+            }
+            else if (OUTSIDE == command.to) {
+                next[command.from] = 0;
+            }
+            else {
+                const uint amount = qMin(next[command.from], sizes_[command.to] - next[command.to]);
+                next[command.from] -= amount;
+                next[command.to] += amount;
+            }
+            const int nextState = next[A] * strideA + next[B] * strideB + next[C];
+            if (previous[nextState] >= 0) {
+                continue;
+            }
+            previous[nextState] = state;
+            commands[nextState] = quint8(i);
+            if (next[A] == need || next[B] == need || next[C] == need) {
+                found = nextState;
+                break;
+            }
+            queue.push_back(nextState);
+        }
+    }
+    if (found < 0) {
+        return -1;
+    }
+
+    int length = 0;
+    for (int state = found; state != start; state = previous[state]) {
+        if (solution) {
+            solution->prepend(allCommands[commands[state]]);
+        }
+        length ++;
+    }
+    return length;
+}
+
+QString ConsoleVodoley::commandName(const Command &command)
+{
+    static const char * Names[3] = { "A", "B", "C" };
+    if (OUTSIDE == command.from) {
+        return QString::fromUtf8("наполни ") + Names[command.to];
+    }
+    else if (OUTSIDE == command.to) {
+        return QString::fromUtf8("вылей ") + Names[command.from];
+    }
+    else {
+        return QString::fromUtf8("перелей из ") + Names[command.from] +
+                QString::fromUtf8(" в ") + Names[command.to];
+    }
+}
+
+QString ConsoleVodoley::loadFromFile(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString::fromUtf8("Ошибка чтения: ") + fileName;
+    }
+    return loadFromDataStream(&file);
+}
+
+QString ConsoleVodoley::loadFromDataStream(QIODevice *source)
+{
+    // Three lines of three numbers: sizes, initial fill and need;
+    // empty lines and lines starting with ';' are skipped
+    uint values[3][3];
+    int linesRead = 0;
+    while (!source->atEnd() && linesRead < 3) {
+        const QString line = QString::fromUtf8(source->readLine()).simplified();
+        if (line.isEmpty() || line[0] == ';') {
+            continue;
+        }
+        const QStringList data = line.split(" ");
+        if (data.count() != 3) {
+            return QString::fromUtf8("Ошибка чтения задания! ");
+        }
+        for (int i = 0; i < 3; i++) {
+            bool ok;
+            values[linesRead][i] = data[i].toUInt(&ok);
+            if (!ok) {
+                static const char * Errors[3] = {
+                    "Ошибка чтения задания: размер не верен!",
+                    "Ошибка чтения: наполненность не верна!",
+                    "Ошибка чтения: необходимое количество!"
+                };
+                return QString::fromUtf8(Errors[linesRead]);
+            }
+        }
+        linesRead ++;
+    }
+    if (linesRead < 3) {
+        return QString::fromUtf8("Ошибка чтения задания! ");
+    }
+    for (int i = 0; i < 3; i++) {
+        if (values[1][i] > values[0][i]) {
+            return QString::fromUtf8("Ошибка чтения: наполненность больше размера!");
+        }
+    }
+    setSizes(values[0][A], values[0][B], values[0][C]);
+    setBaseFill(values[1][A], values[1][B], values[1][C]);
+    setNeed(values[2][A], values[2][B], values[2][C]);
+    reset();
+    return QString();
+}
+
+QByteArray ConsoleVodoley::toData() const
+{
+    QByteArray result;
+    result += ";Capacity\n";
+    result += QByteArray::number(sizes_[A]) + " " + QByteArray::number(sizes_[B]) + " " + QByteArray::number(sizes_[C]);
+    result += "\n;Fullness\n";
+    result += QByteArray::number(baseFills_[A]) + " " + QByteArray::number(baseFills_[B]) + " " + QByteArray::number(baseFills_[C]);
+    result += "\n;Need\n";
+    result += QByteArray::number(needs_[A]) + " " + QByteArray::number(needs_[B]) + " " + QByteArray::number(needs_[C]);
+    return result;
+}
+
+} // namespace ActorVodoley
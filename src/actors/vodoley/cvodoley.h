@@ -0,0 +1,79 @@
+#ifndef CVODOLEY_H
+#define CVODOLEY_H
+
+#include <QString>
+#include <QByteArray>
+#include <QList>
+class QIODevice;
+
+namespace ActorVodoley {
+
+/* Vodoley task and state without any graphics, used by main window
+ * as a model, by the actor directly in console mode and by the
+ * solution checker.
+ *
+ * Every command is pouring from one place to another, where outside
+ * is a tap for filling and a sink for emptying, so there are 12
+ * commands: fill A, empty A, from A to B, etc.
+ */
+class ConsoleVodoley
+{
+public:
+    enum Vessel {
+        A = 0,
+        B = 1,
+        C = 2,
+        OUTSIDE = 3
+    };
+
+    struct Command {
+        int from, to;
+        inline Command(int from = OUTSIDE, int to = OUTSIDE): from(from), to(to) {}
+    };
+
+    ConsoleVodoley();
+
+    void setSizes(uint a, uint b, uint c);
+    void setBaseFill(uint a, uint b, uint c);
+    void setNeed(uint a, uint b, uint c);
+
+    uint size(int vessel) const { return sizes_[vessel]; }
+    uint fill(int vessel) const { return fills_[vessel]; }
+    uint baseFill(int vessel) const { return baseFills_[vessel]; }
+    // Task is done when any vessel contains need(A) liters,
+    // others are stored in file only
+    uint need(int vessel = A) const { return needs_[vessel]; }
+    uint maxSize() const;
+
+    /** Restores initial fill and drops commands counter */
+    void reset();
+    void fillVessel(int vessel) { pour(OUTSIDE, vessel); }
+    void emptyVessel(int vessel) { pour(vessel, OUTSIDE); }
+    void pour(int from, int to);
+    bool isReady() const;
+    /** Commands made since reset */
+    int commandsCount() const { return commandsCount_; }
+
+    /** Returns minimal number of commands to complete the task from
+     *  initial fill and fills solution if not null; -1 if the task
+     *  has no solution, -2 if it is too large to check */
+    int optimalSolution(QList<Command> * solution = 0) const;
+
+    static QString commandName(const Command & command);
+
+    /** Returns error message or empty string on success */
+    QString loadFromDataStream(QIODevice * source);
+    QString loadFromFile(const QString & fileName);
+    QByteArray toData() const;
+
+private:
+    uint sizes_[3];
+    uint baseFills_[3];
+    uint fills_[3];
+    uint needs_[3];
+    int commandsCount_;
+};
+
+} // namespace ActorVodoley
+
+#endif // CVODOLEY_H
@@ -132,7 +132,10 @@ void Menzurka::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
     M->unlock();
 };
 
-Vodoley::Vodoley()
+using ActorVodoley::ConsoleVodoley;
+
+Vodoley::Vodoley(ConsoleVodoley * model)
+    : model(model)
 {
 //	vodHeader=new WHeader();
 	//createActions();
@@ -146,19 +149,10 @@ Vodoley::Vodoley()
         view->setSceneRect(0,0,354,220);
         view->resize(370,245);
 
-	//Asize()=80;Bsize()=7;Csize()=9; //Размер емкости
-	Maxfill.append(8);
-	Maxfill.append(5);
-	Maxfill.append(3);
-
-
-	Afill=0;Bfill=0;Cfill=0;//Сколько  налито изначально
-	Curfill.append(Afill);//Сколько сейчас налито
-	Curfill.append(Bfill);//Сколько сейчас налито
-	Curfill.append(Cfill);//Сколько сейчас налито
-
-
-	AfillR=4,BfillR=4,CfillR=5;
+	model->setSizes(8,5,3);
+	model->setBaseFill(0,0,0);
+	model->setNeed(4,4,5);
+	model->reset();
 
 
 	//	view->resize(500,500);
@@ -234,26 +228,19 @@ Vodoley::Vodoley()
 //--------------------------------
 void Vodoley::CreateDummyTask()
 {
-    Maxfill[0]=3;
-    Maxfill[1]=5;
-    Maxfill[2]=7;
+    model->setSizes(3,5,7);
     qDebug()<<"ASize"<<Asize();
     
     
     
-    AfillR=1;
-    //  BfillR=newZdialog->BNeed();
-    //CfillR=newZdialog->CNeed();
+    model->setNeed(1,model->need(ConsoleVodoley::B),model->need(ConsoleVodoley::C));
     
     Amen->setNeedFill(1);
     Bmen->setNeedFill(1);
     Cmen->setNeedFill(1);
     
-    setBaseFill(0,0,0);
-    Afill=0;Bfill=0;Cfill=0;
-    Curfill[0]=0;
-    Curfill[1]=0;
-    Curfill[2]=0;
+    model->setBaseFill(0,0,0);
+    model->reset();
     updateMenzur();
  
 }
@@ -270,9 +257,9 @@ void Vodoley::CreateVodoley(void)
     Bmen->setCurFill(CurB());
     Cmen->setCurFill(CurC());
 
-    Amen->setNeedFill(AfillR);
-    Bmen->setNeedFill(BfillR);
-    Cmen->setNeedFill(CfillR);
+    Amen->setNeedFill(model->need(ConsoleVodoley::A));
+    Bmen->setNeedFill(model->need(ConsoleVodoley::B));
+    Cmen->setNeedFill(model->need(ConsoleVodoley::C));
 
 
     qDebug()<<CurB();
@@ -332,7 +319,7 @@ void Vodoley::resizeEvent ( QResizeEvent * event )
 void Vodoley::reset()
 {
     mutex.tryLock(30);
-    setBaseFill(Afill,Bfill,Cfill);
+    model->reset();
     mutex.unlock();
     updateMenzur();
 };
@@ -341,20 +328,20 @@ void Vodoley::reset()
 void Vodoley::FillA()
 {
     mutex.lock();
-    Curfill[0]=Asize();
+    model->fillVessel(ConsoleVodoley::A);
     mutex.unlock();
    // updateMenzur();
 };
 void Vodoley::FillB()
 {    mutex.lock();
-    Curfill[1]=Bsize();
+    model->fillVessel(ConsoleVodoley::B);
     mutex.unlock();
    // updateMenzur();
 };
 void Vodoley::FillC()
 {
-    mutex.unlock();
-    Curfill[2]=Csize();
+    mutex.lock();
+    model->fillVessel(ConsoleVodoley::C);
     mutex.unlock();
     //updateMenzur();
 };
@@ -362,16 +349,8 @@ void Vodoley::FillC()
 void Vodoley::MoveFromTo(uint from,uint to)
 {
     mutex.lock();
-    if(to>2){Curfill[from]=0;mutex.unlock();updateMenzur();return;};//Выливаем
-    int svobodno=Maxfill[to]-Curfill[to];
-    Curfill[to]=Curfill[to]+Curfill[from];
-    if(Curfill[to]>Maxfill[to])Curfill[to]=Maxfill[to];
-
-
-    if ((uint)svobodno>Curfill[from])
-        Curfill[from]=0;
-    else
-        Curfill[from]=Curfill[from]-svobodno;
+    if(to>2){model->emptyVessel(from);mutex.unlock();updateMenzur();return;};//Выливаем
+    model->pour(from,to);
     mutex.unlock();
    // updateMenzur();
     QApplication::processEvents();
@@ -389,27 +368,24 @@ void Vodoley::newZ()
     Dialog* newZdialog=new Dialog();
       
     newZdialog->setSizes(Asize(),Bsize(),Csize());
-    newZdialog->setFill(Afill,Bfill,Cfill);
-    newZdialog->setNeed(AfillR);
+    newZdialog->setFill(model->baseFill(ConsoleVodoley::A),model->baseFill(ConsoleVodoley::B),model->baseFill(ConsoleVodoley::C));
+    newZdialog->setNeed(model->need());
 
  	if(!newZdialog->exec())return;
-    Maxfill[0]=newZdialog->ASize();
-    Maxfill[1]=newZdialog->BSize();
-    Maxfill[2]=newZdialog->CSize();
+    model->setSizes(newZdialog->ASize(),newZdialog->BSize(),newZdialog->CSize());
 
 
 
 
-    AfillR=newZdialog->ANeed();
-    //  BfillR=newZdialog->BNeed();
-    //CfillR=newZdialog->CNeed();
+    const uint need=newZdialog->ANeed();
+    model->setNeed(need,model->need(ConsoleVodoley::B),model->need(ConsoleVodoley::C));
 
-    Amen->setNeedFill(AfillR);
-    Bmen->setNeedFill(AfillR);
-    Cmen->setNeedFill(AfillR);
+    Amen->setNeedFill(need);
+    Bmen->setNeedFill(need);
+    Cmen->setNeedFill(need);
 
-    setBaseFill(newZdialog->AFill(),newZdialog->BFill(),newZdialog->CFill());
-    Afill=newZdialog->AFill();Bfill=newZdialog->BFill();Cfill=newZdialog->CFill();
+    model->setBaseFill(newZdialog->AFill(),newZdialog->BFill(),newZdialog->CFill());
+    model->reset();
     updateMenzur();
 //    vodHeader->setWMTitle(QString::fromUtf8("Водолей - новое"));
     setWindowTitle(QString::fromUtf8("Водолей - новое"));
@@ -417,70 +393,12 @@ void Vodoley::newZ()
 
 bool Vodoley::loadIoDevice(QIODevice * source)
 {
-    QString curLine;
-	bool size=false;
-	bool fill=false;
-	bool need=false;
-    
-	while(!source->atEnd()) //Читаем файл
-	{
-		curLine = source->readLine().simplified();
-		if((curLine.isEmpty()) || (curLine[0]==';')){qDebug()<<"Continue";continue;};
-        //		int A,B,C;
-        
-		QStringList data=curLine.split(" ");
-		if(data.count()!=3)
-			QMessageBox::information( 0, "", trUtf8("Ошибка чтения задания! "), 0,0,0);
-		if(!size)//Читаем размер
-		{
-			bool ok;
-			Maxfill[0]=data[0].toInt(&ok);
-			if(!ok)
-				QMessageBox::information( 0, "", trUtf8("Ошибка чтения задания: размер не верен!"), 0,0,0);
-            
-			Maxfill[1]=data[1].toInt(&ok);
-            if(!ok)QMessageBox::information( 0, "", trUtf8("Ошибка чтения задания: размер не верен! ") , 0,0,0);
-			Maxfill[2]=data[2].toInt(&ok);
-			if(!ok)QMessageBox::information( 0, "", trUtf8("Ошибка чтения задания: размер не верен!"), 0,0,0);
-			size=true;
-			continue;
-		};
-        
-		if(!fill)//Читаем наполненность
-		{
-			bool ok;
-			Afill=data[0].toInt(&ok);
-			if(!ok)QMessageBox::information( 0, "", trUtf8("Ошибка чтения:наполненость A не верна! ") , 0,0,0);
-			Bfill=data[1].toInt(&ok);
-			if(!ok)QMessageBox::information( 0, "", trUtf8("Ошибка чтения:наполненость B не верна!") , 0,0,0);
-			Cfill=data[2].toInt(&ok);
-			if(!ok)QMessageBox::information( 0, "", trUtf8("Ошибка чтения:наполненость C не верна!") , 0,0,0);
-			fill=true;
-			continue;
-		};
-		if(!need)//Читаем задание
-		{
-			bool ok;
-			AfillR=data[0].toInt(&ok);
-			if(!ok){
-				QMessageBox::information( 0, "", trUtf8("Ошибка чтения: необходимое количество!") , 0,0,0);
-				return false;
-			};
-			BfillR=data[1].toInt(&ok);
-			if(!ok){
-				QMessageBox::information( 0, "", trUtf8("Ошибка чтения:необходимое количество! ") , 0,0,0);
-				return false;
-			};
-			CfillR=data[2].toInt(&ok);
-			if(!ok){
-				QMessageBox::information( 0, "", trUtf8("Ошибка чтения: необходимое количество!") , 0,0,0);
-				return false;
-			};
-			need=true;
-			continue;
-		};
-	};
-
+    const QString error=model->loadFromDataStream(source);
+    if(!error.isEmpty())
+    {
+        QMessageBox::information( 0, "", error, 0,0,0);
+        return false;
+    };
     return true;
 };
 bool Vodoley::loadFile(QString fileName)
@@ -491,70 +409,11 @@ bool Vodoley::loadFile(QString fileName)
 		QMessageBox::information( 0, "", trUtf8("Ошибка чтения: ") + fileName, 0,0,0);
         return false;
 	};
-	if(VodFile.atEnd())QMessageBox::information( 0, "", trUtf8("Ошибка чтения: ") + fileName, 0,0,0);
-
-	QString curLine;
-	bool size=false;
-	bool fill=false;
-	bool need=false;
-
-	while(!VodFile.atEnd()) //Читаем файл
+	const QString error=model->loadFromDataStream(&VodFile);
+	if(!error.isEmpty())
 	{
-		curLine = VodFile.readLine().simplified();
-		if((curLine.isEmpty()) || (curLine[0]==';')){qDebug()<<"Continue";continue;};
-//		int A,B,C;
-
-		QStringList data=curLine.split(" ");
-		if(data.count()!=3)
-			QMessageBox::information( 0, "", trUtf8("Ошибка чтения: ") + fileName, 0,0,0);
-		if(!size)//Читаем размер
-		{
-			bool ok;
-			Maxfill[0]=data[0].toInt(&ok);
-			if(!ok)
-				QMessageBox::information( 0, "", trUtf8("Ошибка чтения размера: ") + fileName, 0,0,0);
-
-			Maxfill[1]=data[1].toInt(&ok);
-                        if(!ok)QMessageBox::information( 0, "", trUtf8("Ошибка чтения размера:  ") + fileName, 0,0,0);
-			Maxfill[2]=data[2].toInt(&ok);
-			if(!ok)QMessageBox::information( 0, "", trUtf8("Ошибка чтения размера:  ") + fileName, 0,0,0);
-			size=true;
-			continue;
-		};
-
-		if(!fill)//Читаем наполненость
-		{
-			bool ok;
-			Afill=data[0].toInt(&ok);
-			if(!ok)QMessageBox::information( 0, "", trUtf8("Ошибка чтения: ") + fileName, 0,0,0);
-			Bfill=data[1].toInt(&ok);
-			if(!ok)QMessageBox::information( 0, "", trUtf8("Ошибка чтения: ") + fileName, 0,0,0);
-			Cfill=data[2].toInt(&ok);
-			if(!ok)QMessageBox::information( 0, "", trUtf8("Ошибка чтения: ") + fileName, 0,0,0);
-			fill=true;
-			continue;
-		};
-		if(!need)//Читаем задание
-		{
-			bool ok;
-			AfillR=data[0].toInt(&ok);
-			if(!ok){
-				QMessageBox::information( 0, "", trUtf8("Ошибка чтения: ") + fileName, 0,0,0);
-				return false;
-			};
-			BfillR=data[1].toInt(&ok);
-			if(!ok){
-				QMessageBox::information( 0, "", trUtf8("Ошибка чтения: ") + fileName, 0,0,0);
-				return false;
-			};
-			CfillR=data[2].toInt(&ok);
-			if(!ok){
-				QMessageBox::information( 0, "", trUtf8("Ошибка чтения: ") + fileName, 0,0,0);
-				return false;
-			};
-			need=true;
-			continue;
-		};
+		QMessageBox::information( 0, "", error + " " + fileName, 0,0,0);
+		return false;
 	};
 	VodFile.close();
 	QSettings vSett("NIISI RAS","Vodoley");
@@ -563,10 +422,9 @@ bool Vodoley::loadFile(QString fileName)
 	vSett.setValue("Dir",fi.absolutePath());
 	vSett.setValue("File",fileName);
 
-	setBaseFill(Afill,Bfill,Cfill);
-	Amen->setNeedFill(AfillR);
-	Bmen->setNeedFill(BfillR);
-	Cmen->setNeedFill(CfillR);
+	Amen->setNeedFill(model->need(ConsoleVodoley::A));
+	Bmen->setNeedFill(model->need(ConsoleVodoley::B));
+	Cmen->setNeedFill(model->need(ConsoleVodoley::C));
 	updateMenzur();
 //	vodHeader->setWMTitle(QString::fromUtf8("Водолей - ") +  fi.bundleName());
         setWindowTitle(QString::fromUtf8("Водолей - ") +  fi.baseName());
@@ -612,12 +470,7 @@ void Vodoley::saveZ()
 	};
 
 	//Zapis v fayl
-	vFile.write(";Capacity\n");
-	vFile.write((QString::number(Asize())+" "+QString::number(Bsize())+" "+QString::number(Csize())).toLatin1());
-	vFile.write("\n;Fullness\n");
-	vFile.write((QString::number(Afill)+" "+QString::number(Bfill)+" "+QString::number(Cfill)).toLatin1());
-	vFile.write("\n;Need\n");
-	vFile.write((QString::number(AfillR)+" "+QString::number(BfillR)+" "+QString::number(CfillR)).toLatin1());
+	vFile.write(model->toData());
 
 	vFile.close();
 
@@ -685,13 +538,13 @@ void Vodoley::updateNeedBirka()
 //mutex.lock();
     if(needFrame)
 	{
-		if((CurA()==AfillR)||(CurB()==AfillR)||(CurC()==AfillR)){needFrame->setPalette(QPalette(QColor(50,90,50),QColor(100,190,100)));}
+		if(model->isReady()){needFrame->setPalette(QPalette(QColor(50,90,50),QColor(100,190,100)));}
 		else needFrame->setPalette(QPalette(QColor(140,140,160),QColor(140,140,160)));
 
 	}else {qDebug()<<"updateNeedBirka():No needFrame";};
 
-	needLabel->setText(" "+QString::number(AfillR));
-	qDebug()<<"NEED:"<<QString::number(AfillR);
+	needLabel->setText(" "+QString::number(model->need()));
+	qDebug()<<"NEED:"<<QString::number(model->need());
    // mutex.unlock();
 };
 void Vodoley::mousePressEvent(QMouseEvent *event)
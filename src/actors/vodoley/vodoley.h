@@ -22,6 +22,7 @@
 //#include <QtSvg>
 //#include <QGraphicsSvgItem>
 #include "dialog.h"
+#include "cvodoley.h"
 
 //#include "kumfiledialog.h"
 //#include "../../isp_window_header.h"
@@ -117,7 +118,7 @@ class Vodoley:public QMainWindow
     Q_OBJECT
 
 public:
-    Vodoley();
+    explicit Vodoley(ActorVodoley::ConsoleVodoley * model);
     ~Vodoley();
 	QGraphicsScene *scene;
 	QGraphicsView *view;
@@ -127,8 +128,7 @@ public:
 	VodoleyPult* pult;
     bool isReady()
     {
-     if((CurA()==AfillR)||(CurB()==AfillR)||(CurC()==AfillR))return true;
-        else return false;
+        return model->isReady();
     };
 
 	void showVodoley()
@@ -138,36 +138,23 @@ public:
 	}
 	uint CurA() const
 	{
-		return Curfill[0];
+		return model->fill(ActorVodoley::ConsoleVodoley::A);
 	};
 	uint CurB() const
 	{
-		return Curfill[1];
+		return model->fill(ActorVodoley::ConsoleVodoley::B);
 	};
 	uint CurC() const
 	{
-		return Curfill[2];
+		return model->fill(ActorVodoley::ConsoleVodoley::C);
 	};
-	void setBaseFill(int A,int B,int C)
-	{
-		Curfill[0]=A;
-		Curfill[1]=B;
-		Curfill[2]=C;
-
-	};
-	uint Asize() const {return Maxfill[0];};
-	uint Bsize() const {return Maxfill[1];};
-	uint Csize() const {return Maxfill[2];};
+	uint Asize() const {return model->size(ActorVodoley::ConsoleVodoley::A);};
+	uint Bsize() const {return model->size(ActorVodoley::ConsoleVodoley::B);};
+	uint Csize() const {return model->size(ActorVodoley::ConsoleVodoley::C);};
 
 	uint maxSize()
 	{
-		uint max=0;
-		if (Asize()>Bsize())
-			max=Asize();
-		else max=Bsize();
-		if (max<Csize())
-			max=Csize();
-		return max;
+		return model->maxSize();
 	};
     bool loadIoDevice(QIODevice * source);
 	bool loadFile(QString fileName);
@@ -183,7 +170,7 @@ public:
 	QAction * actSave;
     void createActions(QList<QAction*> actions);
     bool ready()
-    {return ((Curfill[0]==AfillR)||(Curfill[1]==AfillR)||(Curfill[2]==AfillR));};
+    {return model->isReady();};
  
 protected:
     void mousePressEvent(QMouseEvent *event);
@@ -242,11 +229,8 @@ private:
     int curTurtleId;
 
     //VODOLEY
-    // uint Asize,Bsize,Csize; //Размер емкости
-    uint Afill,Bfill,Cfill;//Сколько  налито изначально
-    QList<uint> Curfill;//Сколько сейчас налито
-    QList<uint> Maxfill;//Размер емкости
-    uint AfillR,BfillR,CfillR;//Сколько должно быть
+    // Sizes, current and initial fill, need
+    ActorVodoley::ConsoleVodoley * model;
 
     Menzurka* Amen;
     Menzurka* Bmen;
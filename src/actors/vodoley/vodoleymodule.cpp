@@ -30,7 +30,7 @@ VodoleyModule::VodoleyModule(ExtensionSystem::KPlugin * parent)
 
 void VodoleyModule::createGui()
 {
-    MainWindow=new Vodoley();
+    MainWindow=new Vodoley(&consoleVodoley);
     // Module constructor, called once on plugin load
     // TODO implement me
     QList<QAction*> actions;
@@ -85,6 +85,9 @@ QString VodoleyModule::initialize(const QStringList &configurationParameters, co
     using namespace ExtensionSystem;  // not to write "ExtensionSystem::" each time in this method scope
     Q_UNUSED(old);  // Remove this line on implementation
     Q_UNUSED(current);  // Remove this line on implementation
+    if (!MainWindow) {
+        return;
+    }
     MainWindow->redraw();
     if(current==GlobalState::GS_Running)
     {
@@ -98,6 +101,13 @@ QString VodoleyModule::initialize(const QStringList &configurationParameters, co
     // Set actor specific data (like environment)
     // The source should be ready-to-read QIODevice like QBuffer or QFile
     
+    if (!MainWindow) { // console mode
+        const QString error = consoleVodoley.loadFromDataStream(source);
+        if (!error.isEmpty()) {
+            qDebug() << "Vodoley: " << error;
+        }
+        return;
+    }
     MainWindow->loadIoDevice(source);
     MainWindow->pult->pltLogger()->ClearLog();
     MainWindow->reset();
@@ -156,7 +166,10 @@ private:
 /* public slot */ void VodoleyModule::reset()
 {
     // Resets module to initial state before program execution
-    // TODO implement me
+    if (!MainWindow) {
+        consoleVodoley.reset();
+        return;
+    }
     MainWindow->reset();
 }
 
@@ -168,163 +181,135 @@ private:
     Q_UNUSED(enabled);  // Remove this line on implementation
 }
 
+void VodoleyModule::fill(int vessel)
+{
+    if (!MainWindow) { // console mode: no locks and delays
+        consoleVodoley.fillVessel(vessel);
+        return;
+    }
+    mutex.lock();
+    switch (vessel) {
+    case ConsoleVodoley::A: MainWindow->FillA(); break;
+    case ConsoleVodoley::B: MainWindow->FillB(); break;
+    default: MainWindow->FillC(); break;
+    }
+    mutex.unlock();
+    tryToSleep();
+}
+
+void VodoleyModule::moveFromTo(int from, int to)
+{
+    if (!MainWindow) {
+        consoleVodoley.pour(from, to);
+        return;
+    }
+    MainWindow->MoveFromTo(from, to);
+    tryToSleep();
+}
+
 /* public slot */ void VodoleyModule::runFillA()
 {
     /* алг наполни A */
-    // TODO implement me
-    
-     mutex.lock();
-   MainWindow->FillA();
-     mutex.unlock();
-    tryToSleep();
-    
+    fill(ConsoleVodoley::A);
 }
 
 /* public slot */ void VodoleyModule::runFillB()
 {
     /* алг наполни B */
-    // TODO implement me
-      mutex.lock();
-    MainWindow->FillB();
-    mutex.unlock();
-   tryToSleep();
+    fill(ConsoleVodoley::B);
 }
 
 /* public slot */ void VodoleyModule::runFillC()
 {
     /* алг наполни C */
-    // TODO implement me
-    mutex.lock();
-    MainWindow->FillC();
-    mutex.unlock();
-    tryToSleep();
-    
+    fill(ConsoleVodoley::C);
 }
 
 /* public slot */ void VodoleyModule::runEmptyA()
 {
     /* алг вылей A */
-    // TODO implement me
-  
-     mutex.lock();
-    MainWindow->MoveFromTo(0,3);//Move water from A to ....
-     mutex.unlock();
-    tryToSleep();
+    moveFromTo(ConsoleVodoley::A, ConsoleVodoley::OUTSIDE);
 }
 
 /* public slot */ void VodoleyModule::runEmptyB()
 {
     /* алг вылей B */
-    // TODO implement me
-     mutex.lock();
-    MainWindow->MoveFromTo(1,3);
-    //msleep(1);
-    mutex.unlock();
-   tryToSleep();
+    moveFromTo(ConsoleVodoley::B, ConsoleVodoley::OUTSIDE);
 }
 
 /* public slot */ void VodoleyModule::runEmptyC()
 {
     /* алг вылей C */
-    // TODO implement me
-    mutex.lock();
-    MainWindow->MoveFromTo(2,3);
-    tryToSleep();
-    
-     mutex.unlock();
+    moveFromTo(ConsoleVodoley::C, ConsoleVodoley::OUTSIDE);
 }
 
 /* public slot */ void VodoleyModule::runFromAToB()
 {
     /* алг перелей из A в B */
-    // TODO implement me
-  //   mutex.lock();
-    MainWindow->MoveFromTo(0,1);
-    tryToSleep();
-   //  mutex.unlock();
+    moveFromTo(ConsoleVodoley::A, ConsoleVodoley::B);
 }
 
 /* public slot */ void VodoleyModule::runFromAToC()
 {
     /* алг перелей из A в C */
-
-//    mutex.lock();
-    MainWindow->MoveFromTo(0,2);
-    tryToSleep();
-   //mutex.unlock();
+    moveFromTo(ConsoleVodoley::A, ConsoleVodoley::C);
 }
 
 /* public slot */ void VodoleyModule::runFromBToA()
 {
     /* алг перелей из B в A */
- 
-  //   mutex.lock();
-    MainWindow->MoveFromTo(1,0);
-    tryToSleep();
-  //   mutex.unlock();
+    moveFromTo(ConsoleVodoley::B, ConsoleVodoley::A);
 }
 
 /* public slot */ void VodoleyModule::runFromBToC()
 {
     /* алг перелей из B в C */
-    // TODO implement me
-   //  mutex.lock();
-    MainWindow->MoveFromTo(1,2);
-   tryToSleep();
-  //   mutex.unlock();
+    moveFromTo(ConsoleVodoley::B, ConsoleVodoley::C);
 }
 
 /* public slot */ void VodoleyModule::runFromCToB()
 {
     /* алг перелей из C в B */
-    // TODO implement me
-  //   mutex.lock();
-    MainWindow->MoveFromTo(2,1);
-   tryToSleep();
-  //   mutex.unlock();
+    moveFromTo(ConsoleVodoley::C, ConsoleVodoley::B);
 }
 
 /* public slot */ void VodoleyModule::runFromCToA()
 {
     /* алг перелей из C в A */
-    // TODO implement me
-  //   mutex.lock();
-    MainWindow->MoveFromTo(2,0);
-    tryToSleep();
- //    mutex.unlock();
+    moveFromTo(ConsoleVodoley::C, ConsoleVodoley::A);
 }
 
 /* public slot */ bool VodoleyModule::runTaskComplited()
 {
     /* алг лог @@задание выполненно */
     // TODO implement me
-    return MainWindow->ready();
+    return consoleVodoley.isReady();
     
 }
     int VodoleyModule::runSizeA()
     {
-        return MainWindow->Asize();
+        return consoleVodoley.size(ConsoleVodoley::A);
     };
     int VodoleyModule::runSizeB()
     {
-        return MainWindow->Bsize();
+        return consoleVodoley.size(ConsoleVodoley::B);
     };
     int VodoleyModule::runSizeC()
     {
-        return MainWindow->Csize();
+        return consoleVodoley.size(ConsoleVodoley::C);
     };
 
     int VodoleyModule::runInA()
     {
-        return MainWindow->CurA();
+        return consoleVodoley.fill(ConsoleVodoley::A);
     };
     int VodoleyModule::runInB()
     {
-        return MainWindow->CurB();
+        return consoleVodoley.fill(ConsoleVodoley::B);
     };
     int VodoleyModule::runInC()
     {
-        return MainWindow->CurC();
+        return consoleVodoley.fill(ConsoleVodoley::C);
     };
     
     
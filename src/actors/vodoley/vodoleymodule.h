@@ -12,6 +12,7 @@ You should change it corresponding to functionality.
 // Base class include
 #include "vodoleymodulebase.h"
 #include "vodoley.h"
+#include "cvodoley.h"
 // Kumir includes
 #include <kumir2-libs/extensionsystem/kplugin.h>
 
@@ -66,7 +67,11 @@ public slots:
 
 private:
     void createGui();
+    void fill(int vessel);
+    void moveFromTo(int from, int to);
     QMutex mutex;
+    // Task state, drawn by MainWindow if there is GUI
+    ConsoleVodoley consoleVodoley;
     void createRescentMenu();
     Vodoley *MainWindow;
     ExtensionSystem::SettingsPtr my_settings;
@@ -32,19 +32,19 @@ void GuiMessageOutput(QtMsgType type, const char *msg)
 void GuiMessageOutput(QtMsgType type, const QMessageLogContext &, const QString & msg)
 #endif
 {
-    ExtensionSystem::Logger * logger = ExtensionSystem::Logger::instance();
     switch (type) {
     case QtDebugMsg:
-        logger->debug(msg);
+        EXTENSIONSYSTEM_LOG_DEBUG(msg);
         break;
     case QtWarningMsg:
-        logger->warning(msg);
+        EXTENSIONSYSTEM_LOG_WARNING(msg);
         break;
     case QtCriticalMsg:
-        logger->critical(msg);
+        EXTENSIONSYSTEM_LOG_CRITICAL(msg);
         break;
     case QtFatalMsg:
-        logger->fatal(msg);
+        // Writes all queued messages before abort
+        EXTENSIONSYSTEM_LOG_FATAL(msg);
         abort();
     default:
         break;
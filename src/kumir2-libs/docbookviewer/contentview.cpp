@@ -83,6 +83,13 @@ void ContentView::reset()
     clear();    
 }
 
+void ContentView::invalidateRenderedPages()
+{
+    // Page bodies are kept until documents set or appearance changes
+    loadedModel_.clear();
+    renderedPages_.clear();
+}
+
 bool ContentView::isEmpty() const
 {
     return toPlainText().trimmed().isEmpty();
@@ -93,8 +100,11 @@ void ContentView::renderData(ModelPtr data)
     ModelPtr dataToRender = onePageParentModel(data);
     if (dataToRender != loadedModel_) {
         loadedModel_ = dataToRender;
-        const QString html = wrapHTML(renderModel(dataToRender));
-        setHtml(html);
+        QString & body = renderedPages_[dataToRender];
+        if (body.isNull()) {
+            body = renderModel(dataToRender);
+        }
+        setHtml(wrapHTML(body));
     }
     if (dataToRender != data) {
         QString anchor = modelToLink(data);
@@ -655,79 +665,101 @@ QString ContentView::renderInformalTable(ModelPtr data) const
 
 quint16 ContentView::indexInParent(ModelPtr data)
 {
-    quint16 result = 0;
-    if (data->parent()) {
+    if (0u == data->indexInParent_ && data->parent()) {
+        QMap<ModelType,quint16> counters;
         foreach (ModelPtr child, data->parent()->children()) {
-            if (child->modelType() == data->modelType()) {
-                result += 1;
-            }
-            if (child == data) {
-                break;
-            }
+            child->indexInParent_ = ++ counters[child->modelType()];
         }
     }
-    return result;
+    return data->indexInParent_;
 }
 
 QString ContentView::sectionNumber(ModelPtr data)
 {
-    QString result;
-    ModelPtr parent = data->parent();
-    ModelPtr current = data;
-    while (parent) {
-        result = QString("%1.").arg(indexInParent(current)) + result;
-        current = parent;
-        parent = parent->parent();
-        if (current == Book || current == Article) {
-            break;
+    if (data->sectionNumber_.isNull()) {
+        ModelPtr parent = data->parent();
+        QString result = "";
+        if (parent) {
+            if (parent != Book && parent != Article) {
+                result = sectionNumber(parent);
+            }
+            result += QString("%1.").arg(indexInParent(data));
         }
+        data->sectionNumber_ = result;
     }
-    return result;
+    return data->sectionNumber_;
+}
+
+static bool isNumberingRoot(ModelPtr model)
+{
+    return model == Chapter || model == Book || model == Article;
+}
+
+static QPair<int,int> elementKey(ModelPtr model)
+{
+    const ModelType type = model->modelType();
+    return QPair<int,int>(int(type), Section == type ? int(model->sectionLevel()) : 0);
 }
 
 quint16 ContentView::elementNumber(ModelPtr data)
 {
-    ModelPtr root = data->parent();
-    while (root) {
-        if (root == Chapter ||
-                root == Book ||
-                root == Article)
-        {
-            break;
+    if (0u == data->elementNumber_) {
+        ModelPtr root = data->parent();
+        while (root && !isNumberingRoot(root) && root->parent()) {
+            root = root->parent();
+        }
+        if (root) {
+            numberElements(root);
+        }
+        else {
+            data->elementNumber_ = 1u;
         }
-        root = root->parent();
     }
-    bool stop = false;
-    return countOfElements(root, data, stop) + 1;
+    return data->elementNumber_;
 }
 
-quint16 ContentView::countOfElements(ModelPtr root, ModelPtr until, bool &stop)
+void ContentView::numberElements(ModelPtr root)
 {
-    quint16 result = 0;
-    ModelType rt = root->modelType();
-    ModelType ut = until->modelType();
-    quint8 rl = root->sectionLevel();
-    quint8 ul = until->sectionLevel();
-    bool match = rt == ut;
-    if (match && rt == Section) {
-        match = rl == ul;
+    // Numbers all elements having this root in one pass. An element
+    // is numbered among elements of the same type (and level for sections)
+    // in document order, not counting ones nested into the same kind
+    QSet< QPair<int,int> > path;
+    QMap< QPair<int,int>, quint16 > counters;
+    QList<ModelPtr> unreached;
+    const QPair<int,int> rootKey = elementKey(root);
+    path.insert(rootKey);
+    numberElements(root, path, counters, unreached, true);
+    foreach (ModelPtr model, unreached) {
+        const QPair<int,int> key = elementKey(model);
+        model->elementNumber_ = (key == rootKey ? 1u : counters.value(key)) + 1u;
     }
-    if (root == until) {
-        stop = true;
-    }
-    else if (match) {
-        result = 1;
-    }
-    else {
-        for (int i=0; i<root->children().size(); i++) {
-            const ModelPtr & child = root->children()[i];
-            result += countOfElements(child, until, stop);
-            if (stop) {
-                break;
+}
+
+void ContentView::numberElements(ModelPtr parent,
+                                 QSet< QPair<int,int> > & path,
+                                 QMap< QPair<int,int>, quint16 > & counters,
+                                 QList<ModelPtr> & unreached,
+                                 bool owned)
+{
+    foreach (ModelPtr child, parent->children()) {
+        const QPair<int,int> key = elementKey(child);
+        const bool reached = !path.contains(key);
+        if (reached) {
+            const quint16 number = ++ counters[key];
+            if (owned) {
+                child->elementNumber_ = number;
             }
+            path.insert(key);
+        }
+        else if (owned) {
+            unreached.append(child);
+        }
+        numberElements(child, path, counters, unreached,
+                       owned && !isNumberingRoot(child));
+        if (reached) {
+            path.remove(key);
         }
     }
-    return result;
 }
 
 quint16 ContentView::chapterNumber(ModelPtr data)
@@ -1727,6 +1759,14 @@ QString ContentView::formatProgramSourceText(
     return result;
 }
 
+void ContentView::changeEvent(QEvent *e)
+{
+    QTextBrowser::changeEvent(e);
+    if (e->type() == QEvent::PaletteChange || e->type() == QEvent::FontChange) {
+        invalidateRenderedPages();
+    }
+}
+
 void ContentView::resizeEvent(QResizeEvent *e)
 {
     ignoreClearAnchorUrl_ = true;
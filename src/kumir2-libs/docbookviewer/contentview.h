@@ -11,6 +11,8 @@
 #include <QContextMenuEvent>
 #include <QMenu>
 #include <QAction>
+#include <QMap>
+#include <QSet>
 
 namespace DocBookViewer {
 
@@ -28,10 +30,14 @@ public:
     void renderData(ModelPtr data);
     QSize minimumSizeHint() const;
 
+public slots:
+    void invalidateRenderedPages();
+
 signals:
     void itemRequest(ModelPtr model);
 
 private:
+    void changeEvent(QEvent *e);
     void resizeEvent(QResizeEvent *e);
     void wheelEvent(QWheelEvent *e);
     void contextMenuEvent(QContextMenuEvent *e);
@@ -114,8 +120,13 @@ private:
     static quint16 chapterNumber(ModelPtr data);
     static quint16 elementNumber(ModelPtr data);
     static quint16 indexInParent(ModelPtr data);
-    static quint16 countOfElements(ModelPtr root, ModelPtr until, bool &stop);
     static QString sectionNumber(ModelPtr data);
+    static void numberElements(ModelPtr root);
+    static void numberElements(ModelPtr parent,
+                               QSet< QPair<int,int> > & path,
+                               QMap< QPair<int,int>, quint16 > & counters,
+                               QList<ModelPtr> & unreached,
+                               bool owned);
 
 
 
@@ -138,6 +149,7 @@ private:
 
 private /*fields*/:
     ModelPtr loadedModel_;
+    QMap<ModelPtr,QString> renderedPages_;
     QUrl lastAnchorUrl_;
     bool ignoreClearAnchorUrl_;
 
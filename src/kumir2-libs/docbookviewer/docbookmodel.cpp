@@ -10,6 +10,8 @@ DocBookModel::DocBookModel(ModelPtr parent, const ModelType modelType)
     : parent_(parent)
     , modelType_(modelType)
     , sectionLevel_(0)
+    , indexInParent_(0u)
+    , elementNumber_(0u)
 {
     updateSectionLevel();
 }
@@ -30,6 +30,7 @@ class EXTERN DocBookModel
 {
     friend class DocBookFactory;
     friend class MathMLRenderer;
+    friend class ContentView;
 public:    
 
     quint8 sectionLevel() const;
@@ -80,6 +81,12 @@ protected /*fields*/:
     QString format_;
     mutable SvgRendererPtr svgRenderer_;
     mutable QImage cachedImage_;
+
+    // Numbering is filled by ContentView on first use, since it requires
+    // traversal of siblings or the whole chapter
+    mutable quint16 indexInParent_;
+    mutable quint16 elementNumber_;
+    mutable QString sectionNumber_;
 };
 
 }
@@ -56,6 +56,9 @@ DocBookViewImpl::DocBookViewImpl(DocBookView *pClass)
     connect(content_, SIGNAL(itemRequest(ModelPtr)),
             this, SLOT(showAnItem(ModelPtr)));
 
+    connect(sidePanel_, SIGNAL(documentsChanged()),
+            content_, SLOT(invalidateRenderedPages()));
+
     connect(this, SIGNAL(itemSelected(ModelPtr)),
             sidePanel_, SLOT(selectItem(ModelPtr)));
 
@@ -206,6 +209,7 @@ void DocBookViewImpl::updateSettings(ExtensionSystem::SettingsPtr settings, cons
 {
     settings_ = settings;
     settingsPrefix_ = prefix;
+    content_->invalidateRenderedPages();
 }
 
 void DocBookViewImpl::saveState(ExtensionSystem::SettingsPtr settings, const QString &prefix)
@@ -319,7 +323,7 @@ void DocBookViewImpl::clearNavigationFilters()
 
 void DocBookViewImpl::removeDocument(const Document & existingDocument)
 {
-
+    content_->invalidateRenderedPages();
 }
 
 void DocBookViewImpl::showAnItem(ModelPtr model)
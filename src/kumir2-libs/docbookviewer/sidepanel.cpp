@@ -71,6 +71,7 @@ void SidePanel::addDocument(Document document, bool bookSetItemsAsTopLevel)
                          : model->title()
                            );
         createNavigationItems(item, model);
+        createTextIndex(item, model);
         createListOfExamples(model);
         createListOfTables(model);
         createListOfAlgorithms(model);
@@ -78,6 +79,7 @@ void SidePanel::addDocument(Document document, bool bookSetItemsAsTopLevel)
         modelsOfItems_[item] = model;
         itemsOfModels_[model] = item;
     }
+    emit documentsChanged();
 }
 
 void SidePanel::hadleButtonPressed()
@@ -426,6 +428,10 @@ void SidePanel::doFilter(const QString &text)
 
     QSet<QTreeWidgetItem*> matchedItems = findFilteredItems(text.simplified(), tree, nullptr);
 
+    if (tree == ui->contentsNavigator && !text.simplified().isEmpty()) {
+        matchedItems += findTextItems(text);
+    }
+
     QSet<QTreeWidgetItem*> unmatchedItems = allItems - matchedItems;
 
     foreach (QTreeWidgetItem* item, unmatchedItems) {
@@ -470,6 +476,54 @@ SidePanel::findFilteredItems(const QString &text,
     return result;
 }
 
+void SidePanel::createTextIndex(QTreeWidgetItem *item, ModelPtr model)
+{
+    // Each word of text belongs to the nearest contents item,
+    // so search result is a section to be shown
+    static const QRegExp rxNonWord("\\W+");
+    const QStringList words = (model->title() + " " + model->text())
+            .toLower().split(rxNonWord, Qt::SkipEmptyParts);
+    foreach (const QString & word, words) {
+        textIndex_[word].insert(item);
+    }
+    foreach (ModelPtr child, model->children()) {
+        QTreeWidgetItem * childItem = itemsOfModels_.value(child, item);
+        createTextIndex(childItem, child);
+    }
+}
+
+QSet<QTreeWidgetItem*> SidePanel::findTextItems(const QString &text) const
+{
+    // Items containing all the words of text, the last word might be incomplete
+    static const QRegExp rxNonWord("\\W+");
+    const QStringList words = text.toLower().split(rxNonWord, Qt::SkipEmptyParts);
+    QSet<QTreeWidgetItem*> result;
+    for (int i=0; i<words.size(); i++) {
+        const QString & word = words[i];
+        QSet<QTreeWidgetItem*> wordItems;
+        if (i < words.size() - 1) {
+            wordItems = textIndex_.value(word);
+        }
+        else {
+            QMap<QString, QSet<QTreeWidgetItem*> >::const_iterator it =
+                    textIndex_.lowerBound(word);
+            for ( ; it != textIndex_.end() && it.key().startsWith(word); ++it) {
+                wordItems += it.value();
+            }
+        }
+        if (0 == i) {
+            result = wordItems;
+        }
+        else {
+            result &= wordItems;
+        }
+        if (result.isEmpty()) {
+            break;
+        }
+    }
+    return result;
+}
+
 SidePanel::~SidePanel()
 {
     delete ui;
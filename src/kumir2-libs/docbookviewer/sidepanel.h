@@ -48,6 +48,7 @@ public slots:
 
 signals:
     void itemPicked(ModelPtr model);
+    void documentsChanged();
     
 private:
     void createNavigationItems(QTreeWidgetItem * item, ModelPtr model);
@@ -55,6 +56,8 @@ private:
     void createListOfTables(ModelPtr root);
     void createListOfAlgorithms(ModelPtr root);
     void createIndex(ModelPtr root);
+    void createTextIndex(QTreeWidgetItem * item, ModelPtr model);
+    QSet<QTreeWidgetItem*> findTextItems(const QString & text) const;
 
     static QSet<QTreeWidgetItem*> findFilteredItems(
             const QString & text,
@@ -70,6 +73,7 @@ private:
     QMap<ModelPtr, QTreeWidgetItem*> itemsOfModels_;
     QMap<FunctionName, ModelPtr> functionsIndex_;
     QMap<QString, ModelPtr> keywordsIndex_;
+    QMap<QString, QSet<QTreeWidgetItem*> > textIndex_; // lower case word -> contents items
     QList<Document> loadedDocuments_;
     QList<ModelPtr> topLevelItems_;
 
@@ -7,6 +7,9 @@
 #include <QBuffer>
 #include <QTextStream>
 #include <QDir>
+#include <QThread>
+#include <QMutex>
+#include <QSemaphore>
 
 extern "C" {
 #include <stdio.h>
@@ -16,6 +19,39 @@ namespace ExtensionSystem {
 
 Logger* Logger::self_ = 0;
 
+// Serializes writers: background thread and synchronous flush
+static QMutex WriteLock;
+
+struct Logger::Entry {
+    Entry * next;
+    qint64 time;
+    const char * type;
+    QString message;
+};
+
+class Logger::Writer
+        : public QThread
+{
+public:
+    inline explicit Writer(Logger * logger)
+        : logger_(logger), stopping_(false) {}
+    inline void wake() { wakeUp_.release(); }
+    inline void stop() { stopping_ = true; wake(); wait(); }
+protected:
+    void run() {
+        while (!stopping_) {
+            // Producer wakes writer on every push into empty queue, and
+            // semaphore keeps the wake up even if writer is busy now
+            wakeUp_.acquire();
+            logger_->flush();
+        }
+    }
+private:
+    Logger * logger_;
+    std::atomic<bool> stopping_;
+    QSemaphore wakeUp_;
+};
+
 Logger* Logger::instance()
 {    
     if (!self_) {
@@ -35,37 +71,56 @@ Logger* Logger::instance()
         }
 #endif
         self_ = new Logger(path, qApp->arguments().contains("--debug")? Debug : Release);
+        qAddPostRoutine(&Logger::shutdown);
     }
     return self_;
 }
 
 Logger::Logger(const QString & filePath, LogLevel logLevel)
-    : loggerFile_(0), logLevel_(logLevel)
+    : loggerFile_(0), logLevel_(logLevel), queue_(0), async_(false), writer_(0)
 {
     if (filePath.length() > 0) {
         loggerFile_ = new QFile(filePath);
         loggerFile_->open(QIODevice::WriteOnly|QIODevice::Text|QIODevice::Append);
     }
 #ifdef NDEBUG
-    bool process = Debug == logLevel_;
+    verbose_ = Debug == logLevel_;
 #else
-    bool process = isDebugOnLinux();
+    verbose_ = isDebugOnLinux();
 #endif
-    if (process) {
+    writer_ = new Writer(this);
+    writer_->start();
+    async_ = true;
+    if (verbose_) {
         writeLog("STARTED", "");
     }
 }
 
-Logger::~Logger()
+void Logger::shutdown()
 {
-#ifdef NDEBUG
-    bool process = Debug == logLevel_;
-#else
-    bool process = isDebugOnLinux();
-#endif
-    if (process) {
-        writeLog("EXITING", "");
+    // Called on application exit. Logger itself is still alive, as
+    // some objects might write log while being destroyed after that
+    if (self_) {
+        if (self_->verbose_) {
+            self_->writeLog("EXITING", "");
+        }
+        self_->stopWriter();
     }
+}
+
+void Logger::stopWriter()
+{
+    // Messages logged after this point are written synchronously
+    if (async_.exchange(false)) {
+        writer_->stop();
+    }
+    flush();
+}
+
+Logger::~Logger()
+{
+    stopWriter();
+    delete writer_;
     if (loggerFile_) {
         loggerFile_->close();
         delete loggerFile_;
@@ -108,42 +163,77 @@ bool Logger::isDebugOnLinux()
 
 void Logger::writeLog(const char *type, const QString &message)
 {
+    // Formatting is done by writer, here just remember time
+    Entry * entry = new Entry;
+    entry->time = QDateTime::currentMSecsSinceEpoch();
+    entry->type = type;
+    entry->message = message;
+    Entry * head = queue_.load(std::memory_order_relaxed);
+    do {
+        entry->next = head;
+    } while (!queue_.compare_exchange_weak(head, entry));
+    if (!async_) {
+        flush();
+    }
+    else if (!head) {
+        // Queue was empty, so writer might be sleeping
+        writer_->wake();
+    }
+}
+
+void Logger::flush()
+{
+    QMutexLocker lock(&WriteLock);
+    writeQueued();
+}
+
+void Logger::writeQueued()
+{
+    // Take all the queue at once, so there is no contention with
+    // producers pushing new entries
+    Entry * entry = queue_.exchange(0);
+    if (!entry) {
+        return;
+    }
+    Entry * ordered = 0;
+    while (entry) {
+        Entry * next = entry->next;
+        entry->next = ordered;
+        ordered = entry;
+        entry = next;
+    }
     QByteArray buffer;
-    buffer.append(QDateTime::currentDateTime().toString("hh:mm:ss").toLocal8Bit());
-    buffer.append("\t");
-    buffer.append(QByteArray(type));
-    buffer.append("\t");
-    buffer.append(message.toUtf8());
-    buffer.append("\r\n");
+    while (ordered) {
+        buffer.append(QDateTime::fromMSecsSinceEpoch(ordered->time).toString("hh:mm:ss").toLocal8Bit());
+        buffer.append("\t");
+        buffer.append(ordered->type);
+        buffer.append("\t");
+        buffer.append(ordered->message.toUtf8());
+        buffer.append("\r\n");
+        Entry * next = ordered->next;
+        delete ordered;
+        ordered = next;
+    }
     if (loggerFile_) {
         loggerFile_->write(buffer);
         loggerFile_->flush();
     }
     else {
-        fprintf(stderr, "%s", buffer.data());
+        fwrite(buffer.constData(), 1, buffer.size(), stderr);
+        fflush(stderr);
     }
 }
 
 void Logger::debug(const QString &message)
 {
-#ifdef NDEBUG
-    bool process = Debug == logLevel_;
-#else
-    bool process = isDebugOnLinux();
-#endif
-    if (process) {
+    if (verbose_) {
         writeLog("DEBUG", message);
     }
 }
 
 void Logger::warning(const QString &message)
 {
-#ifdef NDEBUG
-    bool process = Debug == logLevel_;
-#else
-    bool process = isDebugOnLinux();
-#endif
-    if (process) {
+    if (verbose_) {
         writeLog("WARNING", message);
     }
 }
@@ -155,7 +245,9 @@ void Logger::critical(const QString &message)
 
 void Logger::fatal(const QString &message)
 {
+    // Application is going to abort, so write everything right now
     writeLog("FATAL", message);
+    flush();
 }
 
 
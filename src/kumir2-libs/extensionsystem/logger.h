@@ -5,14 +5,42 @@ class QFile;
 
 #include <QString>
 
+#include <atomic>
+
 #ifdef EXTENSIONSYSTEM_LIBRARY
 #define EXTENSIONSYSTEM_EXPORT Q_DECL_EXPORT
 #else
 #define EXTENSIONSYSTEM_EXPORT Q_DECL_IMPORT
 #endif
 
+/* Messages of levels below this one are compiled out when logged using
+ * EXTENSIONSYSTEM_LOG_* macros: 0 - debug, 1 - warning, 2 - critical,
+ * 3 - fatal. Message expression is not evaluated in this case, as well
+ * as when the level is disabled at runtime.
+ */
+#ifndef EXTENSIONSYSTEM_LOG_MIN_LEVEL
+#define EXTENSIONSYSTEM_LOG_MIN_LEVEL 0
+#endif
+
+#define EXTENSIONSYSTEM_LOG_DEBUG(message) \
+    do { if (EXTENSIONSYSTEM_LOG_MIN_LEVEL <= 0 && ExtensionSystem::Logger::instance()->isVerbose()) \
+        ExtensionSystem::Logger::instance()->debug(message); } while (0)
+#define EXTENSIONSYSTEM_LOG_WARNING(message) \
+    do { if (EXTENSIONSYSTEM_LOG_MIN_LEVEL <= 1 && ExtensionSystem::Logger::instance()->isVerbose()) \
+        ExtensionSystem::Logger::instance()->warning(message); } while (0)
+#define EXTENSIONSYSTEM_LOG_CRITICAL(message) \
+    do { if (EXTENSIONSYSTEM_LOG_MIN_LEVEL <= 2) \
+        ExtensionSystem::Logger::instance()->critical(message); } while (0)
+#define EXTENSIONSYSTEM_LOG_FATAL(message) \
+    ExtensionSystem::Logger::instance()->fatal(message)
+
 namespace ExtensionSystem {
 
+/* Log messages are put into lock-free queue and written to file (or
+ * stderr) in batches by background thread, so logging thread does not
+ * wait for disk. Fatal messages and shutdown flush the queue
+ * synchronously.
+ */
 class EXTENSIONSYSTEM_EXPORT Logger
 {
 public:
@@ -22,6 +50,13 @@ public:
     };
 
     static Logger * instance();
+
+    /** Debug and warning messages are written */
+    inline bool isVerbose() const { return verbose_; }
+
+    /** Writes all queued messages before return */
+    void flush();
+
     inline void debug(const char * message) { debug(QString::fromLocal8Bit(message)); }
     inline void warning(const char * message) { warning(QString::fromLocal8Bit(message)); }
     inline void critical(const char * message) { critical(QString::fromLocal8Bit(message)); }
@@ -34,12 +69,22 @@ public:
 
     ~Logger();
 private:
+    struct Entry;
+    class Writer;
+
     static bool isDebugOnLinux();
+    static void shutdown();
     void writeLog(const char * type, const QString &message);
+    void writeQueued();
+    void stopWriter();
 
     Logger(const QString & filePath, LogLevel logLevel);
     QFile * loggerFile_;
     LogLevel logLevel_;
+    bool verbose_;
+    std::atomic<Entry*> queue_; // most recent first
+    std::atomic<bool> async_;
+    Writer * writer_;
     static Logger * self_;
 };
 
@@ -89,6 +89,7 @@ void PluginManager::destroy()
         delete o;
     }
     pm->pImpl_->objects.clear();
+    pm->pImpl_->invalidateLookupCache();
 }
 
 SettingsPtr PluginManager::globalSettings() const
@@ -416,38 +417,25 @@ QDir PluginManager::findSystemResourcesDir(const QString &subdirShouldExists) co
 QList<const KPlugin*> PluginManager::loadedConstPlugins(const QByteArray &pattern) const
 {
     QList<const KPlugin*> result;
-    const QRegExp rx = QRegExp(pattern, Qt::CaseSensitive, QRegExp::Wildcard);
-    Q_FOREACH(const KPlugin * p, pImpl_->objects) {
-        const PluginSpec & spec = p->pluginSpec();
-        if ( pattern.length()==0 || (pattern.length() > 0 && rx.exactMatch(spec.name))) {
-            result.append(p);
-        }
+    Q_FOREACH(const KPlugin * p, pImpl_->pluginsByPattern(pattern)) {
+        result.append(p);
     }
     return result;
 }
 
 QList<KPlugin*> PluginManager::loadedPlugins(const QByteArray &pattern)
 {
-    QList<KPlugin*> result;
-    const QRegExp rx = QRegExp(pattern, Qt::CaseSensitive, QRegExp::Wildcard);
-    Q_FOREACH(KPlugin * p, pImpl_->objects) {
-        const PluginSpec & spec = p->pluginSpec();
-        if ( pattern.length()==0 || (pattern.length() > 0 && rx.exactMatch(spec.name))) {
-            result.append(p);
-        }
-    }
-    return result;
+    return pImpl_->pluginsByPattern(pattern);
 }
 
 KPlugin* PluginManager::loadedPlugin(const QByteArray &name)
 {
-    Q_FOREACH(KPlugin * p, pImpl_->objects) {
-        const PluginSpec & spec = p->pluginSpec();
-        if (spec.name == name) {
-            return p;
-        }
-    }
-    return 0;
+    return pImpl_->pluginByName(name);
+}
+
+QList<KPlugin*> PluginManager::pluginsByInterface(InterfaceCheck check)
+{
+    return pImpl_->pluginsByInterface(reinterpret_cast<quintptr>(check), check);
 }
 
 KPlugin* PluginManager::startupModule()
@@ -93,58 +93,34 @@ public:
 
     template <class PluginInterface>
     PluginInterface* findPlugin() {
-        QList<KPlugin*> plugins = loadedPlugins("");
-        PluginInterface* result = nullptr;
-        for (int i=0; i<plugins.size(); i++) {
-            KPlugin * plugin = plugins[i];
-            result = qobject_cast<PluginInterface*>(plugin);
-            if (result)
-                break;
-        }
-        return result;
+        return qobject_cast<PluginInterface*>(findKPlugin<PluginInterface>());
     }
 
     template <class PluginInterface>
     PluginInterface* findPlugin(const QByteArray & name) {
-        QList<KPlugin*> plugins = loadedPlugins("");
-        PluginInterface* result = nullptr;
+        // Note: plugin name might differ from spec name used by loadedPlugin
+        const QList<KPlugin*> plugins = pluginsByInterface(&implements<PluginInterface>);
         for (int i=0; i<plugins.size(); i++) {
             KPlugin * plugin = plugins[i];
             if (plugin->pluginName() == name) {
-                result = qobject_cast<PluginInterface*>(plugin);
-            }
-            if (result) {
-                break;
+                return qobject_cast<PluginInterface*>(plugin);
             }
         }
-        return result;
+        return nullptr;
     }
 
     template <class PluginInterface>
     KPlugin* findKPlugin() {
-        QList<KPlugin*> plugins = loadedPlugins();
-        KPlugin * result = nullptr;
-        for (int i=0; i<plugins.size(); i++) {
-            KPlugin * plugin = plugins[i];
-            PluginInterface * test = qobject_cast<PluginInterface*>(plugin);
-            if (test) {
-                result = plugin;
-                break;
-            }
-        }
-        return result;
+        const QList<KPlugin*> plugins = pluginsByInterface(&implements<PluginInterface>);
+        return plugins.isEmpty() ? nullptr : plugins.first();
     }
 
     template <class PluginInterface>
     QList<PluginInterface*> findPlugins() {
-        QList<KPlugin*> plugins = loadedPlugins();
+        const QList<KPlugin*> plugins = pluginsByInterface(&implements<PluginInterface>);
         QList<PluginInterface*> result;
         for (int i=0; i<plugins.size(); i++) {
-            KPlugin * plugin = plugins[i];
-            PluginInterface* implementation =
-                    qobject_cast<PluginInterface*>(plugin);
-            if (implementation)
-                result.push_back(implementation);
+            result.push_back(qobject_cast<PluginInterface*>(plugins[i]));
         }
         return result;
     }
@@ -178,6 +154,17 @@ public /*constants*/:
     static const QString CurrentWorkspaceKey;
     static const QString SkipChooseWorkspaceKey;
 private:
+    typedef bool (*InterfaceCheck)(KPlugin*);
+
+    template <class PluginInterface>
+    static bool implements(KPlugin * plugin) {
+        return 0 != qobject_cast<PluginInterface*>(plugin);
+    }
+
+    /** Returns plugins implementing interface, cached by checker
+     *  function address until set of loaded plugins changes */
+    QList<KPlugin*> pluginsByInterface(InterfaceCheck check);
+
     explicit PluginManager();
     QScopedPointer<struct PluginManagerImpl> pImpl_;
     void setupAdditionalPluginPaths();
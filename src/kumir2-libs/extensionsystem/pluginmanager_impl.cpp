@@ -198,6 +198,7 @@ QString PluginManagerImpl::loadPlugin(PluginSpec spec, const QList<PluginSpec> &
     plugin->_state = KPlugin::Loaded;
     plugin->_settings = SettingsPtr(new Settings(QString::fromLatin1(spec.name)));
     objects.append(plugin);
+    invalidateLookupCache();
     return "";
 }
 
@@ -247,6 +248,57 @@ QString PluginManagerImpl::initializePlugin(KPlugin * entryPoint)
 }
 
 
+void PluginManagerImpl::invalidateLookupCache()
+{
+    QMutexLocker locker(&lookupMutex);
+    objectsByName.clear();
+    objectsByPattern.clear();
+    objectsByInterface.clear();
+}
+
+KPlugin* PluginManagerImpl::pluginByName(const QByteArray &name)
+{
+    QMutexLocker locker(&lookupMutex);
+    if (objectsByName.isEmpty()) {
+        Q_FOREACH(KPlugin * p, objects) {
+            objectsByName.insert(p->pluginSpec().name, p);
+        }
+    }
+    return objectsByName.value(name, 0);
+}
+
+QList<KPlugin*> PluginManagerImpl::pluginsByPattern(const QByteArray &pattern)
+{
+    QMutexLocker locker(&lookupMutex);
+    if (!objectsByPattern.contains(pattern)) {
+        QList<KPlugin*> result;
+        const QRegExp rx = QRegExp(pattern, Qt::CaseSensitive, QRegExp::Wildcard);
+        Q_FOREACH(KPlugin * p, objects) {
+            const PluginSpec & spec = p->pluginSpec();
+            if ( pattern.length()==0 || rx.exactMatch(spec.name)) {
+                result.append(p);
+            }
+        }
+        objectsByPattern.insert(pattern, result);
+    }
+    return objectsByPattern.value(pattern);
+}
+
+QList<KPlugin*> PluginManagerImpl::pluginsByInterface(quintptr key, bool (*implements)(KPlugin *))
+{
+    QMutexLocker locker(&lookupMutex);
+    if (!objectsByInterface.contains(key)) {
+        QList<KPlugin*> result;
+        Q_FOREACH(KPlugin * p, objects) {
+            if (implements(p)) {
+                result.append(p);
+            }
+        }
+        objectsByInterface.insert(key, result);
+    }
+    return objectsByInterface.value(key);
+}
+
 bool PluginManagerImpl::isPluginLoaded(const QByteArray &name) const
 {
     Q_FOREACH(const KPlugin * plugin, objects) {
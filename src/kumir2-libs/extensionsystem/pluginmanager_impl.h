@@ -6,12 +6,26 @@
 #include <QString>
 #include <QStringList>
 #include <QFont>
+#include <QHash>
+#include <QMutex>
 
 namespace ExtensionSystem {
 
 
 struct PluginManagerImpl {
     QList<KPlugin*> objects;
+
+    /* Lookup indices over 'objects', filled on demand and dropped
+     * on any change of plugins set by invalidateLookupCache() */
+    QHash<QByteArray, KPlugin*> objectsByName;
+    QHash<QByteArray, QList<KPlugin*> > objectsByPattern;
+    QHash<quintptr, QList<KPlugin*> > objectsByInterface;
+    QMutex lookupMutex;
+
+    void invalidateLookupCache();
+    KPlugin* pluginByName(const QByteArray & name);
+    QList<KPlugin*> pluginsByPattern(const QByteArray & pattern);
+    QList<KPlugin*> pluginsByInterface(quintptr key, bool (*implements)(KPlugin*));
     QString path;
     QString sharePath;
 
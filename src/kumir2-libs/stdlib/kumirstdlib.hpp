@@ -9,6 +9,7 @@
 #include <deque>
 #include <map>
 #include <cstdio>
+#include <cstring>
 #ifndef APPLE
 #ifndef USE_MINGW_TOOLCHAIN
 #include <random>
@@ -673,40 +674,14 @@ public:
     inline static void finalize() {}
 
     static bool validDecimal(const String & astring) {
-        static const String validSymbols = Core::fromAscii("0123456789");
-        for (size_t i=0; i<astring.length(); i++) {
-            if (i==0 && (astring[i]=='-' || astring[i]=='+'))
-                continue;
-            if (validSymbols.find(astring[i])==String::npos)
-                return false;
-        }
-        return true;
+        return validDecimal(astring.data(), astring.data() + astring.length());
     }
 
     static real fromDecimal(const String & astring) {
-        real result = 0;
-        real power = 1;
-        size_t index;
-        real digit;
-        static const String digits = Core::fromAscii("0123456789");
-        for (int i=astring.length()-1; i>=0; i--) {
-            if (i==0 && astring[i]=='-') {
-                result = -1 * result;
-                break;
-            }
-            if (i==0 && astring[i]=='+')
-                break;
-            index = digits.find(astring[i]);
-            if (index==String::npos)
-                return 0.0;
-            digit = static_cast<real>(index);
-            result += power * digit;
-            power *= 10;
-        }
-        return result;
+        return fromDecimal(astring.data(), astring.data() + astring.length());
     }
 
-    static int parseInt(String word, unsigned int base, ParseError &error)
+    static int parseInt(const String & word, unsigned int base, ParseError &error)
     {
         error = NoError;
         size_t l = word.length(), pos = 0;
@@ -784,118 +759,98 @@ public:
         return e == NoError;
     }
 
-    static real parseReal(String word, Char dot, ParseError & error) {
+    static real parseReal(const String & word, Char dot, ParseError & error) {
         error = NoError;
         if (word.length()==0) {
             error = EmptyWord;
             return 0;
         }
-        size_t pos = 0;
+        // Parts of word are kept as ranges to not copy them,
+        // but are checked and calculated as before to give the same
+        // errors and the same values
+        const Char * const begin = word.data();
+        const Char * const end = begin + word.length();
+        const Char * p = begin;
         bool negative = false;
-        if (word.at(pos)==Char('-')) {
+        if (*p==Char('-')) {
             negative = true;
-            pos += 1;
+            p += 1;
         }
-        else if (word.at(pos)==Char('+'))
-            pos += 1;
+        else if (*p==Char('+'))
+            p += 1;
         real mantissa = 0.0;
         real exponenta = 0.0;
         real fraction = 0.0;
-        String sIntegral, sFractional, sExponenta;
-        sIntegral.reserve(30);
-        sFractional.reserve(30);
-        sExponenta.reserve(30);
-        bool dotFound = false;
-        bool eFound = false;
-        static const String E = Core::fromUtf8("eEеЕ"); // includes cyrillic 'e'
         bool hasE = false;
-        for (size_t i=0; i<E.length(); i++) {
-            if (!hasE) {
-                hasE = word.find(E[i])!=String::npos;
-            }
-            if (hasE)
+        for (const Char * q = begin; q != end && !hasE; ++q) {
+            hasE = isExponentMark(*q);
+        }
+        const Char * intBegin = p, * intEnd = p;
+        const Char * fracBegin = end, * fracEnd = end;
+        const Char * expBegin = end;
+        for ( ; p != end; ++p) {
+            if (*p==dot || isExponentMark(*p)) {
+                intEnd = p;
                 break;
-        }
-        for (size_t i=pos; i<word.length(); i++) {
-            Char ch = word.at(i);
-            if (!dotFound) {
-                // parse integral part of mantissa
-                if (ch==dot || E.find_first_of(ch)!=String::npos) {
-                    if (ch==dot)
-                        dotFound = true;
-                    else {
-                        dotFound = true;
-                        eFound = true;
-                    }
-
-                }
-                else {
-                    sIntegral.push_back(ch);
-                }
             }
-            else if (!eFound) {
-                // parse fractional part of mantissa
-                if (E.find_first_of(ch)!=String::npos) {
-                    if (sFractional.length()>0) {
-                        if (!validDecimal(sFractional)) {
-                            error = hasE? WrongExpForm : WrongReal;
-                            return 0.0;
-                        }
-                        fraction = fromDecimal(sFractional);
-                    }
-                    if (fraction<0) {
+        }
+        if (p == end) {
+            intEnd = end;
+        }
+        else if (*p==dot) {
+            fracBegin = p + 1;
+            for (p = fracBegin; p != end && !isExponentMark(*p); ++p) {}
+            fracEnd = p;
+            if (p != end) {
+                expBegin = p + 1;
+                if (fracEnd != fracBegin) {
+                    if (!validDecimal(fracBegin, fracEnd)) {
                         error = hasE? WrongExpForm : WrongReal;
                         return 0.0;
                     }
-                    eFound = true;
+                    fraction = fromDecimal(fracBegin, fracEnd);
                 }
-                else {
-                    sFractional.push_back(ch);
+                if (fraction<0) {
+                    error = hasE? WrongExpForm : WrongReal;
+                    return 0.0;
                 }
             }
-            else {
-                // parse exponenta
-                sExponenta.push_back(ch);
-            }
         }
-        if (hasE && sExponenta.length()==0) {
+        else {
+            // Exponent mark without fractional part
+            fracBegin = fracEnd = p;
+            expBegin = p + 1;
+        }
+        const Char * const expEnd = end;
+        if (hasE && expBegin==expEnd) {
             error = WrongExpForm;
             return 0.0;
         }
-        if (sIntegral.length()+sFractional.length()==0) {
-            error = sExponenta.length()>0? WrongExpForm : WrongReal;
+        if (intBegin==intEnd && fracBegin==fracEnd) {
+            error = expBegin!=expEnd? WrongExpForm : WrongReal;
             return 0.0;
         }
-        int fractionalLength = sFractional.length();
-        for (int i=sFractional.length()-1; i>=0; i--) {
-            Char ch = sFractional.at(i);
-            if (ch==Char('0'))
-                fractionalLength -= 1;
-            else
-                break;
+        const Char * significantFracEnd = fracEnd;
+        while (significantFracEnd != fracBegin && *(significantFracEnd-1)==Char('0')) {
+            significantFracEnd --;
         }
-        if (!validDecimal(sIntegral) || !validDecimal(sFractional) || !validDecimal(sExponenta)) {
+        if (!validDecimal(intBegin, intEnd) || !validDecimal(fracBegin, fracEnd) || !validDecimal(expBegin, expEnd)) {
             error = WrongReal;
             return 0.0;
         }
 
-        if (sExponenta.length()>0 && sExponenta.find(Char('.'))!=String::npos) {
-            error = WrongExpForm;
-            return 0.0;
-        }
-
-        fraction = fromDecimal(sFractional.substr(0,fractionalLength));
-        for (int i=0; i<fractionalLength; i++) {
+        fraction = fromDecimal(fracBegin, significantFracEnd);
+        for (const Char * q = fracBegin; q != significantFracEnd; ++q) {
             fraction /= 10.0;
         }
-        mantissa = fromDecimal(sIntegral);
+        mantissa = fromDecimal(intBegin, intEnd);
         if (mantissa<0) {
             // Extra '-' at start
             error = WrongReal;
             return 0.0;
         }
         mantissa += fraction;
-        exponenta = fromDecimal(sExponenta);
+        exponenta = fromDecimal(expBegin, expEnd);
         real result = mantissa * ::pow(10, exponenta);
         if (negative && result != 0)
             result *= -1;
@@ -905,49 +860,31 @@ public:
     }
 
     static String sprintfInt(int value, char base, int width, char al) {
-        String result;
-        result.reserve(30);
+        // Digits are written from the end of buffer
+        char buffer[48];
+        char * const bufferEnd = buffer + sizeof(buffer);
+        char * p = bufferEnd;
         static const char * digits = "0123456789abcdefghijklmnopqrstuvwxyz";
-        int q, r;
-        bool negative = value < 0;
         if (int64_t(value) == -2147483648LL) {
-            if (base == 10)
-                result = Core::fromAscii(std::string("-2147483648"));
+            if (base == 10) {
+                static const char * minValue = "-2147483648";
+                p = bufferEnd - 11;
+                memcpy(p, minValue, 11);
+            }
         }
         else {
-            q = negative? -value : value;
-            if (q>0) {
-                while (q>0) {
-                    r = q % base;
-                    result.insert(0, 1, digits[r]);
-                    q = q / base;
-                }
-            }
-            else {
-                result.insert(0, 1, '0');
-            }
+            const bool negative = value < 0;
+            unsigned int q = negative? -value : value;
+            do {
+                *(--p) = digits[q % base];
+                q = q / base;
+            } while (q>0);
             if (base==16)
-                result.insert(0, 1, '$');
+                *(--p) = '$';
             if (negative)
-                result.insert(0, 1, '-');
+                *(--p) = '-';
         }
-        if (width>0) {
-            int leftSpaces = 0;
-            int rightSpaces = 0;
-            if (al=='l') {
-                rightSpaces = width - result.length();
-            } else if (al=='r') {
-                leftSpaces = width - result.length();
-            } else {
-                leftSpaces = (width - result.length()) / 2;
-                rightSpaces = width - result.length() - leftSpaces;
-            }
-            if (leftSpaces>0)
-                result.insert(0, leftSpaces, ' ');
-            if (rightSpaces>0)
-                result.append(rightSpaces, ' ');
-        }
-        return result;
+        return alignNumber(p, bufferEnd - p, width, al);
     }
 
     static String sprintfReal(
@@ -967,56 +904,27 @@ public:
                 }
             }
         }
+        const int precision = sdecimals < 0 ? 6 : sdecimals;
 
-        std::stringstream stream;
-        if (expform) {
-            stream << std::scientific;
-        } else {
-            stream << std::fixed;
-        }
-        stream.precision(sdecimals < 0 ? 6 : sdecimals);
-        stream << value;
-
-        std::string rpart = stream.str();
-        std::string expPart;
-
-        if (expform) {
-            size_t ePos = rpart.find('e');
-            if (std::string::npos == ePos)
-                ePos = rpart.find('E');
-            expPart = rpart.substr(ePos);
-            rpart.resize(ePos);
-        }
-
-        // Replace ',' with '.' (for some locales like Russian)
-        const size_t dotPos = rpart.find(',');
-        if (std::string::npos != dotPos) {
-            rpart.replace(dotPos, 1, ".");
-        }
-        if ((expform || 0>decimals) && std::string::npos != rpart.find('.')) {
-            while (rpart.size() > 1 && '0' == rpart.at(rpart.size()-1)) {
-                rpart.resize(rpart.length()-1);
-            }
-            if ('.' == rpart.at(rpart.length()-1)) {
-                if (expform)
-                    rpart.resize(rpart.length()-1);
-                else
-                    rpart.push_back('0');
-            }
-        }
-        std::string ascii = rpart + expPart;
-        while (width > 0 && ascii.length() < static_cast<size_t>(width)) {
-            if ('r' == al) {
-                ascii = std::string(" ") + ascii;
-            }
-            else {
-                ascii.push_back(' ');
+        // Same text as printf gives for "%.*e" or "%.*f"
+        char buffer[64];
+        size_t length = 0;
+        char * text = buffer;
+        std::string rpart;
+        if (!formatRealScaled(value, expform, precision, buffer, length)) {
+            rpart.reserve(32);
+            if (!formatRealFast(value, expform, precision, rpart)) {
+                formatRealPrintf(value, expform, precision, rpart);
             }
+            length = rpart.length();
+            rpart.push_back('\0'); // room for a zero after the dot
+            text = &rpart[0];
         }
 
-        EncodingError encodingError;
-        String result = Coder::decode(ASCII, ascii, encodingError);
-        return result;
+        if (expform || 0>decimals) {
+            length = trimFractionZeros(text, length, expform);
+        }
+        return alignNumber(text, length, width, 'r'==al ? 'r' : 'l');
     }
 
 
@@ -1077,7 +985,539 @@ public:
         return sprintfInt(value, 10, 0, 'l');
     }
 
+private:
+    inline static bool isExponentMark(Char ch) {
+        // includes cyrillic 'е' and 'Е'
+        return ch==Char('e') || ch==Char('E') || ch==Char(0x0435) || ch==Char(0x0415);
+    }
+
+    static bool validDecimal(const Char * begin, const Char * end) {
+        for (const Char * p = begin; p != end; ++p) {
+            if (p==begin && (*p=='-' || *p=='+'))
+                continue;
+            if (*p < '0' || *p > '9')
+                return false;
+        }
+        return true;
+    }
+
+    static real fromDecimal(const Char * begin, const Char * end) {
+        real result = 0;
+        real power = 1;
+        real digit;
+        for (const Char * p = end; p != begin; ) {
+            --p;
+            if (p==begin && *p=='-') {
+                result = -1 * result;
+                break;
+            }
+            if (p==begin && *p=='+')
+                break;
+            if (*p < '0' || *p > '9')
+                return 0.0;
+            digit = static_cast<real>(*p - '0');
+            result += power * digit;
+            power *= 10;
+        }
+        return result;
+    }
+
+    static String alignNumber(const char * text, size_t length, int width, char al) {
+        int leftSpaces = 0;
+        int rightSpaces = 0;
+        if (width>0) {
+            const int len = static_cast<int>(length);
+            if (al=='l') {
+                rightSpaces = width - len;
+            } else if (al=='r') {
+                leftSpaces = width - len;
+            } else {
+                leftSpaces = (width - len) / 2;
+                rightSpaces = width - len - leftSpaces;
+            }
+        }
+        if (leftSpaces<0) leftSpaces = 0;
+        if (rightSpaces<0) rightSpaces = 0;
+        String result(leftSpaces + length + rightSpaces, ' ');
+        Char * p = &result[leftSpaces];
+        for (size_t i=0; i<length; i++)
+            p[i] = static_cast<unsigned char>(text[i]);
+        return result;
+    }
+
+    /* Drops insignificant zeros at the end of fractional part of printf
+     * output (keeping exponent part, if any) the way Kumir shows reals.
+     * Text must have room for one more char. Returns new length.
+     */
+    static size_t trimFractionZeros(char * text, size_t length, bool expform) {
+        size_t mantissaEnd = length;
+        if (expform) {
+            for (size_t i=0; i<length; i++) {
+                if ('e' == text[i] || 'E' == text[i]) {
+                    mantissaEnd = i;
+                    break;
+                }
+            }
+        }
+        if (0 == memchr(text, '.', mantissaEnd)) {
+            return length;
+        }
+        size_t end = mantissaEnd;
+        while (end > 1 && '0' == text[end-1]) {
+            end--;
+        }
+        if ('.' == text[end-1]) {
+            if (expform)
+                end--;
+            else
+                text[end++] = '0';
+        }
+        memmove(text + end, text + mantissaEnd, length - mantissaEnd);
+        return end + (length - mantissaEnd);
+    }
+
+    /* Formats value as printf does for "%.*e" or "%.*f" by rounding
+     * value scaled by an exactly representable power of ten to integer.
+     * The scaling is one correctly rounded operation, so the result is
+     * exact unless the scaled value lies within its rounding error from
+     * the middle between two integers; in that case, or when the scaled
+     * value does not fit 52 bits, returns false. Out must have room for
+     * 48 chars.
+     */
+    static bool formatRealScaled(real value, bool expform, int precision, char * out, size_t & length) {
+        static const double powers[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        const double v = double(value);
+        const double a = fabs(v);
+        if (!(a >= DBL_MIN && a <= DBL_MAX) || precision < 0 || precision > 15) {
+            return false;
+        }
+        int exponent = 0;
+        int scale = precision;
+        if (expform) {
+            exponent = static_cast<int>(::floor(::log10(a)));
+            scale = precision - exponent;
+        }
+        double q = 0;
+        for (int attempt = 0; ; attempt++) {
+            if (scale > 22 || scale < -22 || attempt > 1) {
+                return false;
+            }
+            q = scale >= 0 ? a * powers[scale] : a / powers[-scale];
+            if (expform && q < powers[precision]) {
+                exponent--;
+                scale++;
+            }
+            else if (expform && q >= powers[precision+1]) {
+                exponent++;
+                scale--;
+            }
+            else {
+                break;
+            }
+        }
+        if (!(q < 4503599627370496.0)) { // 2^52
+            return false;
+        }
+        const double integral = ::floor(q);
+        const double fraction = q - integral;
+        if (fabs(fraction - 0.5) <= q * DBL_EPSILON) {
+            return false;
+        }
+        uint64_t digits = static_cast<uint64_t>(integral) + (fraction > 0.5 ? 1 : 0);
+        if (expform && digits >= static_cast<uint64_t>(powers[precision+1])) {
+            digits /= 10;
+            exponent++;
+        }
+
+        char text[24];
+        char * const textEnd = text + sizeof(text);
+        char * p = textEnd;
+        do {
+            *(--p) = static_cast<char>('0' + digits % 10);
+            digits /= 10;
+        } while (digits > 0);
+        const int minDigits = expform ? 1 : precision + 1;
+        while (textEnd - p < minDigits) {
+            *(--p) = '0';
+        }
+        const size_t count = textEnd - p;
+        const size_t intCount = expform ? 1 : count - precision;
+
+        char * o = out;
+        if (v < 0) {
+            *o++ = '-';
+        }
+        memcpy(o, p, intCount);
+        o += intCount;
+        if (precision > 0) {
+            *o++ = '.';
+            memcpy(o, p + intCount, precision);
+            o += precision;
+        }
+        if (expform) {
+            *o++ = 'e';
+            *o++ = exponent < 0 ? '-' : '+';
+            const int e = exponent < 0 ? -exponent : exponent;
+            if (e >= 100) {
+                *o++ = static_cast<char>('0' + e / 100);
+            }
+            *o++ = static_cast<char>('0' + e / 10 % 10);
+            *o++ = static_cast<char>('0' + e % 10);
+        }
+        length = o - out;
+        return true;
+    }
+
+    static void formatRealPrintf(real value, bool expform, int precision, std::string & out) {
+        char buffer[64];
+        const char * format = expform? "%.*e" : "%.*f";
+        int length = snprintf(buffer, sizeof(buffer), format, precision, double(value));
+        if (length < 0) {
+            length = 0;
+        }
+        if (static_cast<size_t>(length) < sizeof(buffer)) {
+            out.assign(buffer, length);
+        }
+        else {
+            std::vector<char> large(length + 1);
+            snprintf(&large[0], large.size(), format, precision, double(value));
+            out.assign(&large[0], length);
+        }
+        // Replace ',' with '.' (for some locales like Russian)
+        const size_t dotPos = out.find(',');
+        if (std::string::npos != dotPos) {
+            out[dotPos] = '.';
+        }
+    }
+
+    /* Formats value as printf does, using the shortest round-trip digits
+     * of Grisu2 algorithm (Florian Loitsch, "Printing Floating-Point Numbers
+     * Quickly and Accurately with Integers", 2010) instead of exact binary
+     * expansion. This gives the same text as long as at most 15 significant
+     * digits are requested and value is not too close to the middle between
+     * two printed values; otherwise returns false.
+     */
+    static bool formatRealFast(real value, bool expform, int precision, std::string & out) {
+        const double v = double(value);
+        if ((0.0 != v && !(fabs(v) >= DBL_MIN)) || !(fabs(v) <= DBL_MAX) || precision > 40) {
+            return false;
+        }
+        char digits[24];
+        int length = 0;
+        int exponent = 0; // value is digits * 10^exponent
+        const bool negative = std::signbit(v);
+        if (0.0 == v) {
+            digits[0] = '0';
+            length = 1;
+        }
+        else {
+            grisu2(fabs(v), digits, length, exponent);
+        }
+        const int magnitude = 0.0 == v ? 0 : length - 1 + exponent; // decimal exponent of first digit
+        // Number of digits to keep: up to 10^-precision for fixed
+        // form, precision+1 significant digits for exponential form
+        const int significant = expform ? precision + 1 : magnitude + 1 + precision;
+        if (significant > 15) {
+            return false;
+        }
+        int keep = 0.0 == v ? (expform ? 1 : 0) : significant;
+        if (keep < length && 0.0 != v) {
+            // Tail digits as 0.ABCD in units of the last kept digit
+            int tail = 0;
+            for (int i=0; i<4; i++) {
+                const int pos = keep + i;
+                tail = tail * 10 + (pos >= 0 && pos < length ? digits[pos] - '0' : 0);
+            }
+            // Distance from printed digits to exact binary value
+            // is at most one unit in the last place of double
+            static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+                                            1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+            const int error = 1 + static_cast<int>(2.3e-16 * 1.01 * pow10[significant > 0 ? significant : 0] * 1e4);
+            bool roundUp;
+            if (tail + 1 + error < 5000) {
+                roundUp = false;
+            }
+            else if (tail - error > 5000) {
+                roundUp = true;
+            }
+            else {
+                return false;
+            }
+            if (keep <= 0) {
+                // Nothing is kept, result is either zero or the last unit
+                length = 0;
+                if (roundUp) {
+                    digits[0] = '1';
+                    length = 1;
+                    exponent = magnitude - significant + 1;
+                }
+            }
+            else {
+                exponent += length - keep;
+                length = keep;
+                if (roundUp) {
+                    int i = length - 1;
+                    while (i >= 0 && '9' == digits[i]) {
+                        digits[i] = '0';
+                        i --;
+                    }
+                    if (i >= 0) {
+                        digits[i] ++;
+                    }
+                    else {
+                        // 999 -> 1000, last zero is dropped to keep length
+                        digits[0] = '1';
+                        exponent ++;
+                    }
+                }
+            }
+        }
+        if (negative)
+            out.push_back('-');
+        if (expform) {
+            // d.ddde+XX
+            int shownExponent = 0.0 == v ? 0 : length - 1 + exponent;
+            if (0 == length) {
+                digits[0] = '0';
+                length = 1;
+            }
+            out.push_back(digits[0]);
+            if (precision > 0) {
+                out.push_back('.');
+                for (int i=1; i<=precision; i++)
+                    out.push_back(i < length ? digits[i] : '0');
+            }
+            out.push_back('e');
+            out.push_back(shownExponent < 0 ? '-' : '+');
+            if (shownExponent < 0)
+                shownExponent = -shownExponent;
+            char expDigits[8];
+            int expLength = 0;
+            do {
+                expDigits[expLength++] = '0' + shownExponent % 10;
+                shownExponent /= 10;
+            } while (shownExponent > 0);
+            if (expLength < 2)
+                expDigits[expLength++] = '0';
+            while (expLength > 0)
+                out.push_back(expDigits[--expLength]);
+        }
+        else {
+            // Digit at position i has weight 10^(length-1-i+exponent)
+            const int intDigits = length + exponent;
+            if (intDigits <= 0 || 0 == length) {
+                out.push_back('0');
+            }
+            else {
+                for (int i=0; i<intDigits; i++)
+                    out.push_back(i < length ? digits[i] : '0');
+            }
+            if (precision > 0) {
+                out.push_back('.');
+                for (int i=0; i<precision; i++) {
+                    const int pos = intDigits + i;
+                    out.push_back(pos >= 0 && pos < length ? digits[pos] : '0');
+                }
+            }
+        }
+        return true;
+    }
+
+    struct DiyFp {
+        uint64_t f;
+        int e;
+        inline DiyFp(uint64_t f_, int e_): f(f_), e(e_) {}
+    };
+
+    inline static DiyFp mul(const DiyFp & x, const DiyFp & y) {
+        const uint64_t u_lo = x.f & 0xFFFFFFFFu;
+        const uint64_t u_hi = x.f >> 32u;
+        const uint64_t v_lo = y.f & 0xFFFFFFFFu;
+        const uint64_t v_hi = y.f >> 32u;
+        const uint64_t p0 = u_lo * v_lo;
+        const uint64_t p1 = u_lo * v_hi;
+        const uint64_t p2 = u_hi * v_lo;
+        const uint64_t p3 = u_hi * v_hi;
+        uint64_t q = (p0 >> 32u) + (p1 & 0xFFFFFFFFu) + (p2 & 0xFFFFFFFFu);
+        q += uint64_t(1) << 31u; // round, ties up
+        const uint64_t h = p3 + (p2 >> 32u) + (p1 >> 32u) + (q >> 32u);
+        return DiyFp(h, x.e + y.e + 64);
+    }
+
+    inline static DiyFp normalize(DiyFp x) {
+        while ((x.f >> 63u) == 0) {
+            x.f <<= 1u;
+            x.e --;
+        }
+        return x;
+    }
+
+    /** Shortest (in most cases) digits of positive finite value v,
+     *  such that digits*10^exponent reads back as v */
+    static void grisu2(double v, char * buffer, int & length, int & exponent) {
+        uint64_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        const uint64_t hiddenBit = uint64_t(1) << 52u;
+        const int bias = 1023 + 52;
+        const uint64_t F = bits & (hiddenBit - 1);
+        const int E = static_cast<int>(bits >> 52u);
+        const DiyFp w = 0 == E ? DiyFp(F, 1 - bias) : DiyFp(F + hiddenBit, E - bias);
+        const bool lowerBoundaryIsCloser = 0 == F && E > 1;
+        const DiyFp plus = normalize(DiyFp(2 * w.f + 1, w.e - 1));
+        DiyFp minus = lowerBoundaryIsCloser
+                ? DiyFp(4 * w.f - 1, w.e - 2)
+                : DiyFp(2 * w.f - 1, w.e - 1);
+        minus = DiyFp(minus.f << (minus.e - plus.e), plus.e);
+
+        // Cached power of ten which brings plus.e into [-60, -32]
+        static const struct { uint64_t f; int e; int k; } cachedPowers[] = {
+            { 0xAB70FE17C79AC6CAULL, -1060, -300 },
+            { 0xFF77B1FCBEBCDC4FULL, -1034, -292 },
+            { 0xBE5691EF416BD60CULL, -1007, -284 },
+            { 0x8DD01FAD907FFC3CULL,  -980, -276 },
+            { 0xD3515C2831559A83ULL,  -954, -268 },
+            { 0x9D71AC8FADA6C9B5ULL,  -927, -260 },
+            { 0xEA9C227723EE8BCBULL,  -901, -252 },
+            { 0xAECC49914078536DULL,  -874, -244 },
+            { 0x823C12795DB6CE57ULL,  -847, -236 },
+            { 0xC21094364DFB5637ULL,  -821, -228 },
+            { 0x9096EA6F3848984FULL,  -794, -220 },
+            { 0xD77485CB25823AC7ULL,  -768, -212 },
+            { 0xA086CFCD97BF97F4ULL,  -741, -204 },
+            { 0xEF340A98172AACE5ULL,  -715, -196 },
+            { 0xB23867FB2A35B28EULL,  -688, -188 },
+            { 0x84C8D4DFD2C63F3BULL,  -661, -180 },
+            { 0xC5DD44271AD3CDBAULL,  -635, -172 },
+            { 0x936B9FCEBB25C996ULL,  -608, -164 },
+            { 0xDBAC6C247D62A584ULL,  -582, -156 },
+            { 0xA3AB66580D5FDAF6ULL,  -555, -148 },
+            { 0xF3E2F893DEC3F126ULL,  -529, -140 },
+            { 0xB5B5ADA8AAFF80B8ULL,  -502, -132 },
+            { 0x87625F056C7C4A8BULL,  -475, -124 },
+            { 0xC9BCFF6034C13053ULL,  -449, -116 },
+            { 0x964E858C91BA2655ULL,  -422, -108 },
+            { 0xDFF9772470297EBDULL,  -396, -100 },
+            { 0xA6DFBD9FB8E5B88FULL,  -369,  -92 },
+            { 0xF8A95FCF88747D94ULL,  -343,  -84 },
+            { 0xB94470938FA89BCFULL,  -316,  -76 },
+            { 0x8A08F0F8BF0F156BULL,  -289,  -68 },
+            { 0xCDB02555653131B6ULL,  -263,  -60 },
+            { 0x993FE2C6D07B7FACULL,  -236,  -52 },
+            { 0xE45C10C42A2B3B06ULL,  -210,  -44 },
+            { 0xAA242499697392D3ULL,  -183,  -36 },
+            { 0xFD87B5F28300CA0EULL,  -157,  -28 },
+            { 0xBCE5086492111AEBULL,  -130,  -20 },
+            { 0x8CBCCC096F5088CCULL,  -103,  -12 },
+            { 0xD1B71758E219652CULL,   -77,   -4 },
+            { 0x9C40000000000000ULL,   -50,    4 },
+            { 0xE8D4A51000000000ULL,   -24,   12 },
+            { 0xAD78EBC5AC620000ULL,     3,   20 },
+            { 0x813F3978F8940984ULL,    30,   28 },
+            { 0xC097CE7BC90715B3ULL,    56,   36 },
+            { 0x8F7E32CE7BEA5C70ULL,    83,   44 },
+            { 0xD5D238A4ABE98068ULL,   109,   52 },
+            { 0x9F4F2726179A2245ULL,   136,   60 },
+            { 0xED63A231D4C4FB27ULL,   162,   68 },
+            { 0xB0DE65388CC8ADA8ULL,   189,   76 },
+            { 0x83C7088E1AAB65DBULL,   216,   84 },
+            { 0xC45D1DF942711D9AULL,   242,   92 },
+            { 0x924D692CA61BE758ULL,   269,  100 },
+            { 0xDA01EE641A708DEAULL,   295,  108 },
+            { 0xA26DA3999AEF774AULL,   322,  116 },
+            { 0xF209787BB47D6B85ULL,   348,  124 },
+            { 0xB454E4A179DD1877ULL,   375,  132 },
+            { 0x865B86925B9BC5C2ULL,   402,  140 },
+            { 0xC83553C5C8965D3DULL,   428,  148 },
+            { 0x952AB45CFA97A0B3ULL,   455,  156 },
+            { 0xDE469FBD99A05FE3ULL,   481,  164 },
+            { 0xA59BC234DB398C25ULL,   508,  172 },
+            { 0xF6C69A72A3989F5CULL,   534,  180 },
+            { 0xB7DCBF5354E9BECEULL,   561,  188 },
+            { 0x88FCF317F22241E2ULL,   588,  196 },
+            { 0xCC20CE9BD35C78A5ULL,   614,  204 },
+            { 0x98165AF37B2153DFULL,   641,  212 },
+            { 0xE2A0B5DC971F303AULL,   667,  220 },
+            { 0xA8D9D1535CE3B396ULL,   694,  228 },
+            { 0xFB9B7CD9A4A7443CULL,   720,  236 },
+            { 0xBB764C4CA7A44410ULL,   747,  244 },
+            { 0x8BAB8EEFB6409C1AULL,   774,  252 },
+            { 0xD01FEF10A657842CULL,   800,  260 },
+            { 0x9B10A4E5E9913129ULL,   827,  268 },
+            { 0xE7109BFBA19C0C9DULL,   853,  276 },
+            { 0xAC2820D9623BF429ULL,   880,  284 },
+            { 0x80444B5E7AA7CF85ULL,   907,  292 },
+            { 0xBF21E44003ACDD2DULL,   933,  300 },
+            { 0x8E679C2F5E44FF8FULL,   960,  308 },
+            { 0xD433179D9C8CB841ULL,   986,  316 },
+            { 0x9E19DB92B4E31BA9ULL,  1013,  324 }
+        };
+        const int alpha = -60;
+        const int fe = alpha - plus.e - 1;
+        const int k = (fe * 78913) / (1 << 18) + static_cast<int>(fe > 0);
+        const int index = (300 + k + 7) / 8;
+        const DiyFp c(cachedPowers[index].f, cachedPowers[index].e);
+
+        const DiyFp W = mul(normalize(w), c);
+        const DiyFp wMinus = mul(minus, c);
+        const DiyFp wPlus = mul(plus, c);
+        // Conservative interval
+        const DiyFp M_minus(wMinus.f + 1, wMinus.e);
+        const DiyFp M_plus(wPlus.f - 1, wPlus.e);
+        exponent = -cachedPowers[index].k;
+        length = 0;
+
+        uint64_t delta = M_plus.f - M_minus.f;
+        uint64_t dist = M_plus.f - W.f;
+        const DiyFp one(uint64_t(1) << -M_plus.e, M_plus.e);
+        uint32_t p1 = static_cast<uint32_t>(M_plus.f >> -one.e);
+        uint64_t p2 = M_plus.f & (one.f - 1);
+
+        uint32_t pow10 = 1000000000u;
+        int n = 10;
+        while (n > 1 && p1 < pow10) {
+            pow10 /= 10;
+            n --;
+        }
+        while (n > 0) {
+            const uint32_t d = p1 / pow10;
+            p1 = p1 % pow10;
+            buffer[length++] = static_cast<char>('0' + d);
+            n --;
+            const uint64_t rest = (uint64_t(p1) << -one.e) + p2;
+            if (rest <= delta) {
+                exponent += n;
+                grisu2Round(buffer, length, dist, delta, rest, uint64_t(pow10) << -one.e);
+                return;
+            }
+            pow10 /= 10;
+        }
+        int m = 0;
+        for (;;) {
+            p2 *= 10;
+            const uint64_t d = p2 >> -one.e;
+            p2 = p2 & (one.f - 1);
+            buffer[length++] = static_cast<char>('0' + d);
+            m ++;
+            delta *= 10;
+            dist *= 10;
+            if (p2 <= delta)
+                break;
+        }
+        exponent -= m;
+        grisu2Round(buffer, length, dist, delta, p2, one.f);
+    }
 
+    inline static void grisu2Round(char * buffer, int length, uint64_t dist, uint64_t delta, uint64_t rest, uint64_t tenK) {
+        while (rest < dist && delta - rest >= tenK &&
+               (rest + tenK < dist || dist - rest > rest + tenK - dist))
+        {
+            buffer[length-1] --;
+            rest += tenK;
+        }
+    }
 };
 
 class StringUtils {
@@ -1198,20 +1638,27 @@ public:
     }
 
     inline static void replace(String & s, const String & oldSubstr, const String & newSubstr, bool all) {
-        size_t pos = 0;
-        while (true) {
-            pos = s.find(oldSubstr, pos);
-            if (pos==String::npos) {
-                break;
-            }
+        size_t pos = s.find(oldSubstr);
+        if (pos==String::npos) {
+            return;
+        }
+        if (!all || oldSubstr.length()==0) {
             s.replace(pos, oldSubstr.length(), newSubstr);
-            if (all) {
-                pos += newSubstr.length();
-            }
-            else {
-                break;
-            }
+            return;
+        }
+        // Build result in one pass: replacing in place moves the tail
+        // of string for each occurence
+        String result;
+        result.reserve(s.length());
+        size_t start = 0;
+        while (pos!=String::npos) {
+            result.append(s, start, pos-start);
+            result.append(newSubstr);
+            start = pos + oldSubstr.length();
+            pos = s.find(oldSubstr, start);
         }
+        result.append(s, start, String::npos);
+        s.swap(result);
     }
 
     inline static void remove(String & s, int pos, int count) {
@@ -1235,6 +1682,265 @@ public:
     }
 };
 
+/* Read buffer of a file opened by Files. It is shared by all
+ * IO::InputStream instances created for the same handle, so file is
+ * read by large blocks and each block is decoded at once. Reading a
+ * character and pushing it back are just cursor moves.
+ * Encoding is fixed at creation time, Files::reset drops the buffer.
+ */
+class FileInputBuffer {
+public:
+    enum { BlockSize = 64 * 1024 };
+
+    inline FileInputBuffer(FILE * f, Encoding enc) {
+        file_ = f;
+        encoding_ = enc;
+        position_ = 0u;
+        pendingBytes_ = 0u;
+        bomChecked_ = ftell(f) != 0;
+        endOfData_ = false;
+        broken_ = false;
+        raw_.resize(BlockSize + 4);
+        data_.reserve(BlockSize + 1);
+    }
+
+    inline Encoding encoding() const { return encoding_; }
+
+    inline bool readChar(Char & ch) {
+        if (position_ >= data_.length() && !fill())
+            return false;
+        ch = data_[position_];
+        position_ ++;
+        return true;
+    }
+    inline void unreadChar() {
+        if (position_ > 0u)
+            position_ --;
+    }
+    inline bool peekChar(size_t offset, Char & ch) {
+        while (position_ + offset >= data_.length()) {
+            if (!fill())
+                return false;
+        }
+        ch = data_[position_ + offset];
+        return true;
+    }
+    inline bool atEnd() {
+        return position_ >= data_.length() && !fill();
+    }
+    /** True if there are no more characters because of bad data
+     *  rather than end of file */
+    inline bool isBroken() const {
+        return broken_ && position_ >= data_.length();
+    }
+
+    /** Decoded characters available without reading file */
+    inline const Char * current() const { return data_.c_str() + position_; }
+    inline size_t available() const { return data_.length() - position_; }
+    inline void skip(size_t count) { position_ += count; }
+
+    /** Reads and decodes next block, appending it to the decoded data.
+     *  Returns false if nothing was added */
+    inline bool fill() {
+        if (endOfData_ || broken_)
+            return false;
+        // Keep the last read character to be able to push it back
+        if (position_ > 1u) {
+            data_.erase(0, position_ - 1);
+            position_ = 1u;
+        }
+        const size_t sizeBefore = data_.length();
+        while (data_.length() == sizeBefore && !endOfData_ && !broken_) {
+            const size_t got = fread(&raw_[pendingBytes_], sizeof(char), BlockSize, file_);
+            const bool last = got < BlockSize;
+            charptr p = &raw_[0];
+            charptr end = p + pendingBytes_ + got;
+            if (!bomChecked_ && (end - p >= 3 || last)) {
+                static const char * BOM = "\xEF\xBB\xBF";
+                bomChecked_ = true;
+                if (encoding_ == UTF8 && end - p >= 3 && strncmp(BOM, p, 3) == 0)
+                    p += 3;
+            }
+            if (encoding_ == UTF8)
+                p = decodeUtf8(p, end, last);
+            else if (encoding_ == CP1251)
+                p = decodeTable<CP1251CodingTable>(p, end);
+            else if (encoding_ == KOI8R)
+                p = decodeTable<KOI8RCodingTable>(p, end);
+            else if (encoding_ == CP866)
+                p = decodeTable<CP866CodingTable>(p, end);
+            else if (encoding_ == ASCII)
+                p = decodeTable<AsciiCodingTable>(p, end);
+            else
+                broken_ = true;
+            pendingBytes_ = broken_ ? 0u : static_cast<size_t>(end - p);
+            if (pendingBytes_ > 0u)
+                memmove(&raw_[0], p, pendingBytes_);
+            if (last && !broken_) {
+                endOfData_ = true;
+            }
+        }
+        return data_.length() > sizeBefore;
+    }
+
+private:
+    template <class Table>
+    inline charptr decodeTable(charptr p, charptr end) {
+        EncodingError error = NoEncodingError;
+        while (p < end) {
+            if ('\0' == *p) {
+                broken_ = true;
+                break;
+            }
+            const uint32_t ch = Table::dec(p, error);
+            if (error) {
+                broken_ = true;
+                break;
+            }
+            data_.push_back(Char(ch));
+        }
+        return p;
+    }
+
+    inline charptr decodeUtf8(charptr p, charptr end, bool last) {
+        while (p < end) {
+            const unsigned char byte = static_cast<unsigned char>(*p);
+            if (byte > 0u && byte < 0x80u) {
+                data_.push_back(Char(byte));
+                p ++;
+                continue;
+            }
+            if (0xFFu == byte) {
+                // Treated as end of stream, same as EOF returned by fgetc
+                endOfData_ = true;
+                return end;
+            }
+            int extraBytes = 0;
+            if (0x06u == (byte >> 5))
+                extraBytes = 1;
+            else if (0x0Eu == (byte >> 4))
+                extraBytes = 2;
+            else {
+                broken_ = true;
+                return p;
+            }
+            if (end - p <= extraBytes) {
+                // Sequence continues in the next block
+                if (last)
+                    broken_ = true;
+                return p;
+            }
+            uint32_t v = byte & (1 == extraBytes ? 0x1Fu : 0x0Fu);
+            for (int i=1; i<=extraBytes; i++) {
+                const unsigned char next = static_cast<unsigned char>(p[i]);
+                if (0x80u != (next & 0xC0u)) {
+                    broken_ = true;
+                    return p;
+                }
+                v = (v << 6) | (next & 0x3Fu);
+            }
+            data_.push_back(Char(v));
+            p += 1 + extraBytes;
+        }
+        return p;
+    }
+
+    FILE * file_;
+    Encoding encoding_;
+    std::vector<char> raw_;
+    size_t pendingBytes_;
+    String data_;
+    size_t position_;
+    bool bomChecked_;
+    bool endOfData_;
+    bool broken_;
+};
+
+/* Write buffer of a file opened by Files, shared by all IO::OutputStream
+ * instances created for the same handle. Strings are encoded directly
+ * into the buffer, which is written to file when it is full or when
+ * Files needs the file contents to be actual (close, reset, eof).
+ */
+class FileOutputBuffer {
+public:
+    enum { BlockSize = 64 * 1024 };
+
+    inline explicit FileOutputBuffer(FILE * f) {
+        file_ = f;
+        atStart_ = ftell(f) == 0;
+        data_.reserve(BlockSize + 16);
+    }
+
+    /** Returns false if string contains a character not representable
+     *  in encoding; characters before it are still written */
+    inline bool write(const String & s, Encoding enc) {
+        const size_t sizeBefore = data_.size();
+        if (atStart_ && enc == UTF8) {
+            data_.push_back('\xEF');
+            data_.push_back('\xBB');
+            data_.push_back('\xBF');
+        }
+        bool ok = true;
+        if (enc == UTF8)
+            ok = encodeUtf8(s);
+        else if (enc == CP1251)
+            ok = encodeTable<CP1251CodingTable>(s);
+        else if (enc == KOI8R)
+            ok = encodeTable<KOI8RCodingTable>(s);
+        else if (enc == CP866)
+            ok = encodeTable<CP866CodingTable>(s);
+        else if (enc == ASCII)
+            ok = encodeTable<AsciiCodingTable>(s);
+        else
+            data_.append(s.length(), '\0'); // same as Coder::encode does
+        if (data_.size() > sizeBefore)
+            atStart_ = false;
+        if (data_.size() >= BlockSize)
+            flush();
+        return ok;
+    }
+
+    inline void flush() {
+        if (!data_.empty()) {
+            fwrite(data_.c_str(), sizeof(char), data_.size(), file_);
+            data_.clear();
+        }
+    }
+
+private:
+    template <class Table>
+    inline bool encodeTable(const String & s) {
+        EncodingError error = NoEncodingError;
+        for (size_t i=0; i<s.length(); i++) {
+            const char ch = Table::enc(s[i], error);
+            if (error)
+                return false;
+            data_.push_back(ch);
+        }
+        return true;
+    }
+
+    inline bool encodeUtf8(const String & s) {
+        EncodingError error = NoEncodingError;
+        for (size_t i=0; i<s.length(); i++) {
+            const uint32_t v = static_cast<uint32_t>(s[i]);
+            if (v < 0x80u) {
+                data_.push_back(static_cast<char>(v));
+                continue;
+            }
+            const MultiByte mb = UTF8CodingTable::enc(v, error);
+            if (error)
+                return false;
+            data_.append(reinterpret_cast<const char*>(mb.data), mb.size);
+        }
+        return true;
+    }
+
+    FILE * file_;
+    bool atStart_;
+    std::string data_;
+};
+
 class Files {
     friend class IO;
 public:
@@ -1265,12 +1971,18 @@ public:
     inline static void finalize() {
         if (isOpenedFiles() && Core::getError().length()==0)
             Core::abort(Core::fromUtf8("Остались не закрытые файлы"));
+        outputBuffers.flushAll();
         for (size_t i=0; i<openedFiles.size(); i++) {
             FileType & f = openedFiles[i];
-            if (f.handle)
+            // Assigned streams are listed here too, they are closed below
+            if (f.handle && f.handle!=assignedIN && f.handle!=assignedOUT)
                 fclose(f.handle);
         }
         openedFiles.clear();
+        for (InputBuffers::iterator it=inputBuffers.begin(); it!=inputBuffers.end(); ++it) {
+            delete it->second;
+        }
+        inputBuffers.clear();
         if (assignedIN!=stdin)
             fclose(assignedIN);
         if (assignedOUT!=stdout)
@@ -1706,8 +2418,11 @@ public:
         FileType f = (*it);
         FILE * fh = f.handle;
         f.invalidate();
-        if (fh)
+        if (fh) {
+            dropInputBuffer(fh);
+            dropOutputBuffer(fh);
             fclose(fh);
+        }
         openedFiles.erase(it);        
     }
 
@@ -1725,6 +2440,8 @@ public:
         }
         const FileType & f = (*it);
         FILE * fh = f.handle;
+        dropInputBuffer(fh);
+        flushOutputBuffer(fh);
         fseek(fh, 0, 0);
     }
     inline static bool eof(const FileType & key) {
@@ -1741,6 +2458,12 @@ public:
         }
         const FileType & f = (*it);
         FILE * fh = f.handle;
+        flushOutputBuffer(fh);
+        InputBuffers::iterator bufferIt = inputBuffers.find(fh);
+        if (bufferIt != inputBuffers.end()) {
+            FileInputBuffer * buffer = bufferIt->second;
+            return buffer->atEnd() && !buffer->isBroken();
+        }
         if (feof(fh))
             return true;
         unsigned char ch = 0x00;
@@ -1768,6 +2491,17 @@ public:
             return false;
         }
         FILE * fh = (*it).handle;
+        flushOutputBuffer(fh);
+        InputBuffers::iterator bufferIt = inputBuffers.find(fh);
+        if (bufferIt != inputBuffers.end()) {
+            FileInputBuffer * buffer = bufferIt->second;
+            Char ch = Char(' ');
+            for (size_t i=0; buffer->peekChar(i, ch); i++) {
+                if (ch!=' ' && ch!='\t' && ch!='\r' && ch!='\n')
+                    return true;
+            }
+            return false;
+        }
         long backPos = -1;
         if (fh!=stdin)
             backPos = ftell(fh);
@@ -1823,8 +2557,11 @@ public:
 
     inline static void assignInStream(String fileName) {
         StringUtils::trim<String,Char>(fileName);
-        if (assignedIN!=stdin)
+        if (assignedIN!=stdin) {
+            dropInputBuffer(assignedIN);
+            forgetHandle(assignedIN);
             fclose(assignedIN);
+        }
         if (fileName.length()>0)
             open(fileName, FileType::Read, false, &assignedIN);
         else
@@ -1833,8 +2570,11 @@ public:
 
     inline static void assignOutStream(String fileName) {
         StringUtils::trim<String,Char>(fileName);
-        if (assignedIN!=stdout)
+        if (assignedOUT!=stdout) {
+            dropOutputBuffer(assignedOUT);
+            forgetHandle(assignedOUT);
             fclose(assignedOUT);
+        }
         if (fileName.length()>0)
             open(fileName, FileType::Write, false, &assignedOUT);
         else
@@ -1843,11 +2583,95 @@ public:
 
 private:
 
+    inline static void forgetHandle(FILE * fh) {
+        for (std::deque<FileType>::iterator it=openedFiles.begin(); it!=openedFiles.end(); ++it) {
+            if (it->handle==fh) {
+                openedFiles.erase(it);
+                return;
+            }
+        }
+    }
+
+    inline static FileInputBuffer * inputBuffer(FILE * fh, Encoding enc) {
+        InputBuffers::iterator it = inputBuffers.find(fh);
+        if (it != inputBuffers.end()) {
+            return it->second;
+        }
+        if (enc==DefaultEncoding) {
+            bool forceUtf8 = false;
+            long curpos = ftell(fh);
+            fseek(fh, 0, SEEK_SET);
+            unsigned char B[3];
+            if (fread(B, 1, 3, fh)==3) {
+                forceUtf8 = B[0]==0xEF && B[1]==0xBB && B[2]==0xBF;
+            }
+            fseek(fh, curpos, SEEK_SET);
+            enc = forceUtf8 ? UTF8 : Core::getSystemEncoding();
+        }
+        FileInputBuffer * buffer = new FileInputBuffer(fh, enc);
+        inputBuffers[fh] = buffer;
+        return buffer;
+    }
+
+    inline static void dropInputBuffer(FILE * fh) {
+        InputBuffers::iterator it = inputBuffers.find(fh);
+        if (it != inputBuffers.end()) {
+            delete it->second;
+            inputBuffers.erase(it);
+        }
+    }
+
+    inline static FileOutputBuffer * outputBuffer(FILE * fh) {
+        OutputBuffers::iterator it = outputBuffers.find(fh);
+        if (it != outputBuffers.end()) {
+            return it->second;
+        }
+        FileOutputBuffer * buffer = new FileOutputBuffer(fh);
+        outputBuffers[fh] = buffer;
+        return buffer;
+    }
+
+    inline static void flushOutputBuffer(FILE * fh) {
+        OutputBuffers::iterator it = outputBuffers.find(fh);
+        if (it != outputBuffers.end()) {
+            it->second->flush();
+        }
+    }
+
+    inline static void dropOutputBuffer(FILE * fh) {
+        OutputBuffers::iterator it = outputBuffers.find(fh);
+        if (it != outputBuffers.end()) {
+            it->second->flush();
+            delete it->second;
+            outputBuffers.erase(it);
+        }
+    }
+
     static FILE * assignedIN;
     static FILE * assignedOUT;
 
     static std::deque<FileType> openedFiles;
 
+    typedef std::map<FILE*, FileInputBuffer*> InputBuffers;
+    static InputBuffers inputBuffers;
+
+    /* Pending output of all files. It is also written out on static
+     * destruction, so files left open by a program (or abandoned by
+     * a runtime error) still get their data when finalize() is not
+     * called: static destructors run before C streams are closed at exit.
+     */
+    struct OutputBuffers: public std::map<FILE*, FileOutputBuffer*> {
+        inline void flushAll() {
+            for (iterator it=begin(); it!=end(); ++it) {
+                it->second->flush();
+                delete it->second;
+            }
+            clear();
+        }
+        inline ~OutputBuffers() { flushAll(); }
+    };
+    static OutputBuffers outputBuffers;
+
     static AbstractInputBuffer* consoleInputBuffer;
     static AbstractOutputBuffer* consoleOutputBuffer;
     static AbstractOutputBuffer* consoleErrorBuffer;
@@ -1891,6 +2715,7 @@ public:
         OutputStream()
         {
             file = 0;
+            fileBuffer_ = 0;
             encoding = UTF8;
             buffer.reserve(100);
             streamType_ = InternalBuffer;
@@ -1904,19 +2729,27 @@ public:
             else
                 encoding = enc;
             externalBuffer_ = 0;
+            // Console output is not delayed
+            fileBuffer_ = f!=stdout ? Files::outputBuffer(f) : 0;
         }
         OutputStream(AbstractOutputBuffer * buffer) {
             streamType_ = ExternalBuffer;
             file = 0;
             encoding = UTF8;
             externalBuffer_ = buffer;
+            fileBuffer_ = 0;
         }
 
         inline const String & getBuffer() const { return buffer; }
         inline const StreamType type() const { return streamType_; }
 
         void writeRawString(const String & s) {
-            if (type() == File) {
+            if (fileBuffer_) {
+                if (!fileBuffer_->write(s, encoding)) {
+                    Core::abort(Core::fromUtf8("Ошибка кодирования строки вывода: недопустимый символ"));
+                }
+            }
+            else if (type() == File) {
                 if (encoding==UTF8 && ftell(file)==0) {
                     static const char * BOM = "\xEF\xBB\xBF";
                     fwrite(BOM, sizeof(char), 3, file);
@@ -1948,6 +2781,7 @@ public:
         Encoding encoding;
         String buffer;
         AbstractOutputBuffer * externalBuffer_;
+        FileOutputBuffer * fileBuffer_;
 
     };
 
@@ -1963,6 +2797,7 @@ public:
             errLength_=0;
             currentPosition_=0;
             externalBuffer_ = 0;
+            fileBuffer_ = 0;
         }
 
         inline InputStream(const String & b) {
@@ -1974,6 +2809,7 @@ public:
             buffer_=b;
             currentPosition_=0;
             externalBuffer_ = 0;
+            fileBuffer_ = 0;
         }
 
         inline InputStream(AbstractInputBuffer * buffer) {
@@ -1984,43 +2820,29 @@ public:
             errLength_=0;
             currentPosition_=0;
             externalBuffer_ = buffer;
+            fileBuffer_ = 0;
         }
 
         inline InputStream(FILE * f, Encoding enc) {
             streamType_ = File;
             file_ = f;
             externalBuffer_ = 0;
-            if (enc==DefaultEncoding) {
-                bool forceUtf8 = false;
-                if (f!=stdin) {
-                    long curpos = ftell(f);
-                    fseek(f, 0, SEEK_SET);
-                    unsigned char B[3];
-                    if (fread(B, 1, 3, f)==3) {
-                        forceUtf8 = B[0]==0xEF && B[1]==0xBB && B[2]==0xBF;
-                    }
-                    fseek(f, curpos, SEEK_SET);
-                }
-                if (forceUtf8)
-                    encoding_ = UTF8;
-                else
-                    encoding_ = Core::getSystemEncoding();
+            if (f!=stdin) {
+                fileBuffer_ = Files::inputBuffer(f, enc);
+                encoding_ = fileBuffer_->encoding();
             }
             else {
-                encoding_ = enc;
+                // Console input is read by characters, to not wait
+                // for the whole block to be typed
+                fileBuffer_ = 0;
+                if (enc==DefaultEncoding)
+                    encoding_ = Core::getSystemEncoding();
+                else
+                    encoding_ = enc;
             }
             errStart_ = 0;
             errLength_ = 0;
             currentPosition_=0;
-            if (f == stdin) {
-                fileSize_ = -1;
-            }
-            else {
-                long curpos = ftell(f);
-                fseek(f, 0L, SEEK_END);
-                fileSize_ = ftell(f);
-                fseek(f, curpos, SEEK_SET);
-            }
         }
         inline int currentPosition() const {
             return currentPosition_;
@@ -2062,19 +2884,21 @@ public:
             else if ( type() == ExternalBuffer ) {
                 return externalBuffer_->readRawChar(x);
             }
+            else if (fileBuffer_) {
+                if (fileBuffer_->readChar(x))
+                    return true;
+                checkFileBuffer();
+                return false;
+            }
             else {
                 if (feof(file_))
                     return false;
-                long pos = ftell(file_);
-                if (fileSize_ != -1 && pos >= fileSize_) {
-                    return false;
-                }
                 charptr buffer = reinterpret_cast<charptr>(&lastCharBuffer_);
                 if (encoding_!=UTF8) {
                     // Read only one byte
                     lastCharBuffer_[0] = fgetc(file_);
                     uint8_t firstByte = lastCharBuffer_[0];
-                    if (firstByte == 255 && fileSize_ == -1) {
+                    if (firstByte == 255) {
                         return false;
                     }
                 }
@@ -2143,6 +2967,9 @@ public:
             else if ( type() == ExternalBuffer ) {
                 externalBuffer_->pushLastCharBack();
             }
+            else if (fileBuffer_) {
+                fileBuffer_->unreadChar();
+            }
             else /* File */ {
                 if (file_==stdin) {
                     if (lastCharBuffer_[2]!='\0')
@@ -2159,6 +2986,28 @@ public:
         inline String readUntil(const String & delimeters) {
             String result;
             result.reserve(100);
+            if (fileBuffer_) {
+                // Scan decoded block without per character calls
+                while (fileBuffer_->available() > 0u || fileBuffer_->fill()) {
+                    const Char * data = fileBuffer_->current();
+                    const size_t count = fileBuffer_->available();
+                    size_t length = 0u;
+                    while (length < count && (data[length]==Char('\r') ||
+                           delimeters.find_first_of(data[length])==String::npos))
+                    {
+                        length ++;
+                    }
+                    for (size_t i=0; i<length; i++) {
+                        if (data[i]!=Char('\r'))
+                            result.push_back(data[i]);
+                    }
+                    fileBuffer_->skip(length);
+                    if (length < count)
+                        return result;
+                }
+                checkFileBuffer();
+                return result;
+            }
             Char current;
             while (readRawChar(current)) {
                 if (delimeters.find_first_of(current)!=String::npos
@@ -2176,6 +3025,23 @@ public:
         }
         inline void skipDelimiters(const String & delim) {
             // Skip delimiters until lexem
+            if (fileBuffer_) {
+                while (fileBuffer_->available() > 0u || fileBuffer_->fill()) {
+                    const Char * data = fileBuffer_->current();
+                    const size_t count = fileBuffer_->available();
+                    size_t length = 0u;
+                    while (length < count && (data[length]==Char('\r') ||
+                           delim.find_first_of(data[length])!=String::npos))
+                    {
+                        length ++;
+                    }
+                    fileBuffer_->skip(length);
+                    if (length < count)
+                        return;
+                }
+                checkFileBuffer();
+                return;
+            }
             Char skip(32);
             while (readRawChar(skip)) {
                 if (delim.find_first_of(skip)==String::npos
@@ -2187,10 +3053,50 @@ public:
             }
         }
 
+        inline String readLine() {
+            String result;
+            result.reserve(100);
+            if (fileBuffer_) {
+                while (fileBuffer_->available() > 0u || fileBuffer_->fill()) {
+                    const Char * data = fileBuffer_->current();
+                    const size_t count = fileBuffer_->available();
+                    size_t length = 0u;
+                    while (length < count && data[length]!=Char(10)) {
+                        length ++;
+                    }
+                    for (size_t i=0; i<length; i++) {
+                        if (data[i]!=Char(13))
+                            result.push_back(data[i]);
+                    }
+                    if (length < count) {
+                        // Consume line end
+                        fileBuffer_->skip(length + 1);
+                        return result;
+                    }
+                    fileBuffer_->skip(length);
+                }
+                checkFileBuffer();
+                return result;
+            }
+            Char current;
+            while (readRawChar(current)) {
+                if (current!=10 && current!=13)
+                    result.push_back(current);
+                if (current==10)
+                    break;
+            }
+            return result;
+        }
+
     private:        
+        inline void checkFileBuffer() {
+            if (fileBuffer_->isBroken()) {
+                Core::abort(Core::fromUtf8("Ошибка перекодирования при чтении данных из текстового файла"));
+            }
+        }
+
         StreamType streamType_;
         FILE * file_;
-        long fileSize_;
         Encoding encoding_;
         String buffer_;
         String error_;
@@ -2199,6 +3105,7 @@ public:
         int currentPosition_;
         char lastCharBuffer_[3];
         AbstractInputBuffer * externalBuffer_;
+        FileInputBuffer * fileBuffer_;
     }; // end inner class InputStream
 
 
@@ -2250,16 +3157,7 @@ protected:
 public:
     // Generic functions to be in use while input from GUI
     inline static String readLine(InputStream & is) {
-        String result;
-        result.reserve(100);
-        Char current;
-        while (is.readRawChar(current)) {
-            if (current!=10 && current!=13)
-                result.push_back(current);
-            if (current==10)
-                break;
-        }
-        return result;
+        return is.readLine();
     }
     inline static String readString(InputStream & is) {
         return readLiteralOrWord(is);
@@ -2595,6 +3493,8 @@ inline void finalizeStandardLibrary() {
 String Core::error = String();
 void (*Core::AbortHandler)() = 0;
 std::deque<FileType> Files::openedFiles;
+Files::InputBuffers Files::inputBuffers;
+Files::OutputBuffers Files::outputBuffers;
 AbstractInputBuffer* Files::consoleInputBuffer = 0;
 AbstractOutputBuffer* Files::consoleOutputBuffer = 0;
 AbstractOutputBuffer* Files::consoleErrorBuffer = 0;
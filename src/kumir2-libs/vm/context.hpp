@@ -5,6 +5,7 @@
 #include "variant.hpp"
 #include "vm_instruction.hpp"
 #include "vm_tableelem.hpp"
+#include "vm_abstract_handlers.h"
 
 namespace VM {
 
@@ -26,6 +27,9 @@ struct ExternReference {
     bool platformDependent;
     String fileName;
     std::string platformModuleName;
+    IntrinsicFunction intrinsic;
+    inline ExternReference()
+        : moduleContext(0), funcKey(0), platformDependent(false), intrinsic(0) {}
 };
 
 typedef std::map<uint32_t, ExternReference> ExternsMap;
@@ -145,6 +145,17 @@ public:
     }
 
 
+    inline void appendString(const String & s) {
+        if (type_==VT_string && svalue_) {
+            svalue_->append(s);
+        }
+        else {
+            String result = toString();
+            result.append(s);
+            operator=(result);
+        }
+    }
+
     inline bool isValid() const { return type_!=VT_void || ( avalue_ && avalue_->size()>0 ); }
 
     inline ValueType type() const { return type_; }
@@ -429,6 +440,10 @@ public:
 
     inline void setConstValue(const Variable & ctab);
 
+    /** Appends to string value without copying it, so building
+     *  a string by parts takes linear time */
+    inline void appendString(const String & s);
+
     inline ValueType baseType() const { return reference_? reference_->baseType() : baseType_; }
     inline void setBaseType(ValueType vt) { baseType_ = vt; }
 
@@ -536,6 +551,24 @@ void Variable::setValue(const AnyValue &v)
 
 
 
+void Variable::appendString(const String & s)
+{
+    if (reference_ && referenceIndeces_[3]==0) {
+        reference_->appendString(s);
+    }
+    else if (reference_) {
+        String result = value().toString();
+        result.append(s);
+        setValue(AnyValue(result));
+    }
+    else if (!value_.isValid() && !ignoreUndefinedError) {
+        Kumir::Core::abort(Kumir::Core::fromUtf8("Нет значения у величины"));
+    }
+    else {
+        value_.appendString(s);
+    }
+}
+
 String Variable::toString() const
 {
     String result;
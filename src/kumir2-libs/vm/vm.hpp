@@ -13,12 +13,14 @@
 
 #include <kumir2-libs/stdlib/kumirstdlib.hpp>
 #include "vm_bytecode.hpp"
+#include "vm_module_cache.hpp"
 #include "stack.hpp"
 #include "variant.hpp"
 #include "context.hpp"
 #include "stack.hpp"
 #include "vm_abstract_handlers.h"
 #include "vm_breakpoints_table.hpp"
+#include "vm_profiler.hpp"
 
 #ifndef MAX_RECURSION_SIZE
 #define MAX_RECURSION_SIZE 4000
@@ -57,13 +59,27 @@ public /*methods*/:
     inline bool hasTestingAlgorithm() const;
     inline unsigned long int stepsDone() const { return stepsCounter_; }
 
+    /** Used by debugger. Counter of instructions which could change
+     *  variables, so values are known to be the same if it is not
+     *  changed since last check. Never decreases, even on reset */
+    inline uint64_t writeGeneration() const { return writeGeneration_; }
+
+    /** Sets execution profiler or null to disable profiling.
+     *  Profiler is not owned by VM */
+    inline void setProfiler(Profiler * profiler) { profiler_ = profiler; }
+    inline Profiler * profiler() const { return profiler_; }
+
 
     /** Breakpoint operations */
     inline void removeAllBreakpoints();
-    inline void insertOrChangeBreakpoint(const bool enabled, const String &fileName, const uint32_t lineNo, const uint32_t ignoreCount, const String &condition);
+    inline void insertOrChangeBreakpoint(const bool enabled, const String &fileName, const uint32_t lineNo, const uint32_t ignoreCount, const BreakpointCondition &condition);
     inline void insertSingleHitBreakpoint(const String &fileName, uint32_t lineNo);
     inline void removeBreakpoint(const String &fileName, const uint32_t lineNo);
 
+    /** Reads breakpoint condition made by code generator for
+     *  currently loaded program */
+    inline static bool loadBreakpointConditionFromBinaryBuffer(std::list<char> & stream, BreakpointCondition & condition, String & error);
+
     /** Sets the Debugging Interaction handler for this VM */
     inline void setDebuggingHandler(
             DebuggingInteractionHandler * h
@@ -177,6 +193,7 @@ private /*fields*/:
     VariablesTable * currentGlobals_;
     VariablesTable * currentLocals_;
     unsigned long int stepsCounter_;
+    uint64_t writeGeneration_;
     Kumir::AbstractInputBuffer * consoleInputBuffer_;
     Kumir::AbstractOutputBuffer * consoleOutputBuffer_;
     int previousLineNo_;
@@ -184,6 +201,7 @@ private /*fields*/:
     uint32_t previousColEnd_;
 
     BreakpointsTable breakpointsTable_;
+    Profiler * profiler_;
 
 
 public /*constructors*/:
@@ -214,6 +232,9 @@ private /*instruction methods*/:
     inline void do_updarr(uint8_t, uint16_t);
     inline void do_store(uint8_t, uint16_t);
     inline void do_storearr(uint8_t, uint16_t);
+    inline void do_strapp(uint8_t, uint16_t);
+    inline bool isStoreVisible(int lineNo) const;
+    inline void noticeStore(Variable & variable, const Variable & value, int lineNo);
     inline void do_load(uint8_t, uint16_t);
     inline void do_loadarr(uint8_t, uint16_t);
     inline void do_jump(uint16_t);
@@ -229,6 +250,7 @@ private /*instruction methods*/:
     inline void do_ret();
     inline void do_error(uint8_t, uint16_t);
     inline void do_line(const Bytecode::Instruction & instr);
+    inline bool isBreakpointConditionTrue(const BreakpointCondition & condition);
     inline void do_ref(uint8_t, uint16_t);
     inline void do_setref(uint8_t, uint16_t);
     inline void do_refarr(uint8_t, uint16_t);
@@ -470,13 +492,13 @@ void KumirVM::setProgram(const Bytecode::Data &program, bool isMain, const Strin
                 }
                 Kumir::EncodingError encodingError;
                 const std::string filename = Kumir::Coder::encode(VM_LOCALE, modulePath, encodingError);
-                std::ifstream externalfile(filename.c_str());
-                if (
-                        !Kumir::Files::exist(modulePath)
-                        || !externalfile.is_open()
-                   )
+                int errorCode = ENOENT;
+                const Bytecode::ConstDataPtr programData =
+                        Kumir::Files::exist(modulePath)
+                        ? Bytecode::ModuleCache::load(filename, &errorCode)
+                        : Bytecode::ConstDataPtr();
+                if (!programData)
                 {
-                    int errorCode = errno;
                     Kumir::String errorMessage = Kumir::Core::fromUtf8("Не могу загрузить внешний исполнитель: ")
                             +modulePath
                             +Kumir::Core::fromUtf8(" (ошибка ")
@@ -488,10 +510,7 @@ void KumirVM::setProgram(const Bytecode::Data &program, bool isMain, const Strin
                     }
                     return;
                 }
-                Bytecode::Data programData;
-                Bytecode::bytecodeFromDataStream(externalfile, programData);
-                externalfile.close();
-                setProgram(programData, false, e.fileName, error);
+                setProgram(*programData, false, e.fileName, error);
                 if (error && error->length())
                     return;
             }
@@ -574,7 +593,6 @@ void KumirVM::setProgram(const Bytecode::Data &program, bool isMain, const Strin
                         makeCanonicalName(e.fileName),
                         encodingError
                         );
-            moduleContexts_[currentModuleContext].externs[key] = reference;
             if (externalModuleLoad_) {
                 std::deque< std::string > algorithms =
                         (*externalModuleLoad_)(
@@ -583,9 +601,18 @@ void KumirVM::setProgram(const Bytecode::Data &program, bool isMain, const Strin
                             error
                             );
                 if (error && error->length() > 0) {
+                    moduleContexts_[currentModuleContext].externs[key] = reference;
                     return;
                 }
             }
+            if (externalModuleCall_) {
+                // Resolve pure module functions once to call them directly
+                reference.intrinsic = externalModuleCall_->intrinsic(
+                            reference.moduleAsciiName,
+                            uint16_t(alg)
+                            );
+            }
+            moduleContexts_[currentModuleContext].externs[key] = reference;
         }
         else if (e.type==EL_FUNCTION || e.type==EL_MAIN || e.type==EL_BELOWMAIN || e.type==EL_TESTING) {
             uint32_t key = 0x00000000;
@@ -660,7 +687,9 @@ KumirVM::KumirVM()
     , currentConstants_(nullptr)
     , currentGlobals_(nullptr)
     , currentLocals_(nullptr)
+    , writeGeneration_(0u)
     , consoleInputBuffer_(nullptr)
+    , profiler_(nullptr)
 {
 
 }
@@ -748,10 +777,10 @@ void KumirVM::removeAllBreakpoints()
     if (stacksMutex_) stacksMutex_->unlock();
 }
 
-void KumirVM::insertOrChangeBreakpoint(const bool enabled, const Kumir::String &fileName, const uint32_t lineNo, const uint32_t ignoreCount, const Kumir::String &)
+void KumirVM::insertOrChangeBreakpoint(const bool enabled, const Kumir::String &fileName, const uint32_t lineNo, const uint32_t ignoreCount, const BreakpointCondition &condition)
 {
     if (stacksMutex_) stacksMutex_->lock();
-    breakpointsTable_.insertOrChangeBreakpoint(enabled, fileName, lineNo, ignoreCount, 0);
+    breakpointsTable_.insertOrChangeBreakpoint(enabled, fileName, lineNo, ignoreCount, condition);
     if (stacksMutex_) stacksMutex_->unlock();
 }
 
@@ -780,6 +809,10 @@ void KumirVM::reset()
     nextCallInto_ = false;
     backtraceSkip_ = 0;
     stepsCounter_ = 0u;
+    if (profiler_) {
+        profiler_->clear();
+    }
+    breakpointsTable_.resetHitCounts();
     error_.clear();
     register0_ = AnyValue();
     Variable::ignoreUndefinedError = false;
@@ -989,23 +1022,37 @@ void KumirVM::evaluateNextInstruction()
         return;
     }
     const Instruction & instr = program->at(ip);
+    if (profiler_) {
+        profiler_->noticeInstruction(contextsStack_, moduleContexts_, instr.type);
+    }
     switch (instr.type) {
     case CALL:
+        // External and library calls may set 'рез' arguments
+        writeGeneration_ ++;
         do_call(instr.module, instr.arg);
         break;
     case INIT:
+        writeGeneration_ ++;
         do_init(instr.scope, instr.arg);
         break;
     case SETARR:
+        writeGeneration_ ++;
         do_setarr(instr.scope, instr.arg);
         break;
     case UPDARR:
+        writeGeneration_ ++;
         do_updarr(instr.scope, instr.arg);
         break;
     case STORE:
+        writeGeneration_ ++;
         do_store(instr.scope, instr.arg);
         break;
+    case STRAPP:
+        writeGeneration_ ++;
+        do_strapp(instr.scope, instr.arg);
+        break;
     case STOREARR:
+        writeGeneration_ ++;
         do_storearr(instr.scope, instr.arg);
         break;
     case LOAD:
@@ -1060,6 +1107,7 @@ void KumirVM::evaluateNextInstruction()
         do_refarr(instr.scope, instr.arg);
         break;
     case SETREF:
+        writeGeneration_ ++;
         do_setref(instr.scope, instr.arg);
         break;
     case CTL:
@@ -1199,7 +1247,7 @@ void KumirVM::do_call(uint8_t mod, uint16_t alg)
             error_ = Kumir::Core::fromUtf8("Слишком много вложенных вызовов алгоритмов");
         }
         else {
-            ExternReference reference = moduleContexts_[contextsStack_.top().moduleContextNo].externs[p];
+            const ExternReference & reference = moduleContexts_[contextsStack_.top().moduleContextNo].externs[p];
             if (!reference.platformDependent) {
                 // External call of algorithm found in another kumir file
                 if (stacksMutex_) stacksMutex_->lock();
@@ -1222,6 +1270,27 @@ void KumirVM::do_call(uint8_t mod, uint16_t alg)
                 valuesStack_.pop(); // current implementation doesn't requere args count
                 if (stacksMutex_) stacksMutex_->unlock();
             }
+            else if (reference.intrinsic) {
+                // Pure module function: evaluate in place without
+                // arguments marshalling and waiting for actor thread
+                if (stacksMutex_) stacksMutex_->lock();
+                int argsCount = valuesStack_.pop().toInt();
+                std::deque<Variable> args;
+                for (int i=0; i<argsCount; i++) {
+                    args.push_front(valuesStack_.pop());
+                }
+                Kumir::String localError;
+                const AnyValue algResult = reference.intrinsic(args, &localError);
+                if (localError.length()>0) {
+                    if (error_.length()==0)
+                        error_ = localError;
+                }
+                else if (algResult.isValid()) {
+                    valuesStack_.push(Variable(algResult));
+                    register0_ = algResult;
+                }
+                if (stacksMutex_) stacksMutex_->unlock();
+            }
             else if (externalModuleCall_) {
                 uint16_t algKey = reference.funcKey & 0xffff;
                 const std::string moduleAsciiName = reference.moduleAsciiName;
@@ -2371,8 +2440,6 @@ void KumirVM::do_store(uint8_t s, uint16_t id)
     const int lineNo = contextsStack_.top().lineNo;
     Variable & variable = findVariable(s, id);
     const int dim = variable.dimension();
-    ValueType t = variable.baseType();
-    Variable * reference = variable.reference();
     int bounds[7];
     if (dim>0)
         value.getBounds(bounds);
@@ -2384,54 +2451,8 @@ void KumirVM::do_store(uint8_t s, uint16_t id)
         variable.setValue(value.value());
         variable.setDimension(value.dimension());
     }
-    if (lineNo!=-1 &&
-            !blindMode_ &&
-            contextsStack_.top().type != EL_BELOWMAIN &&
-            contextsStack_.top().moduleContextNo == 0 &&
-            value.dimension()==0
-            )
-    {
-        const String & name = variable.myName();
-        String svalue;
-        if (t==VT_string) {
-            const String valueString = value.toString();
-            svalue.reserve(valueString.length()+2);
-            svalue.push_back(Char('"'));
-            svalue.append(valueString);
-            svalue.push_back(Char('"'));
-        }
-        else if (t==VT_char) {
-            const Char valueChar = value.toChar();
-            svalue.reserve(3);
-            svalue.push_back(Char('\''));
-            svalue.push_back(valueChar);
-            svalue.push_back(Char('\''));
-        }
-        else if (t==VT_int) {
-            svalue = Kumir::Converter::sprintfInt(value.toInt(), 10, 0, 0);
-        }
-        else if (t==VT_real) {
-            svalue = Kumir::Converter::sprintfReal(value.toReal(), '.', false, 0 ,-1, 0);
-        }
-        else if (t==VT_bool) {
-            static const String YES = Kumir::Core::fromUtf8("да");
-            static const String NO = Kumir::Core::fromUtf8("нет");
-            svalue = value.toBool()? YES : NO;
-        }
-        else if (t==VT_record) {
-            Kumir::String localError;
-            svalue = (*customTypeToString_)(variable, &localError);
-        }
-        if (debugHandler_ && svalue.length()>0) {
-            const String message = name+Char('=')+svalue;
-            if (contextsStack_.top().moduleContextNo == 0)
-                debugHandler_->appendTextToMargin(lineNo, message);
-        }
-        if (debugHandler_ && currentContext().runMode==CRM_OneStep) {
-            stacksMutex_->unlock();
-            debugHandler_->debuggerNoticeOnValueChanged(variable, nullptr);
-            stacksMutex_->lock();
-        }
+    if (isStoreVisible(lineNo) && value.dimension()==0) {
+        noticeStore(variable, value, lineNo);
     }
     if (contextsStack_.top().type==Bytecode::EL_BELOWMAIN)
         Variable::unsetError();
@@ -2440,6 +2461,91 @@ void KumirVM::do_store(uint8_t s, uint16_t id)
     if (stacksMutex_) stacksMutex_->unlock();
 }
 
+void KumirVM::do_strapp(uint8_t s, uint16_t id)
+{
+    if (stacksMutex_) stacksMutex_->lock();
+    if ((s & Bytecode::APPEND_CHECK) != 0) {
+        // Emitted before operands, so undefined variable is reported
+        // before any of them is evaluated, as it was by LOAD
+        Variable & variable = findVariable(uint8_t(s & ~Bytecode::APPEND_CHECK), id);
+        if (!variable.hasValue()) {
+            variable.value(); // aborts with the same message as LOAD
+        }
+        error_ = Kumir::Core::getError();
+        nextIP();
+        if (stacksMutex_) stacksMutex_->unlock();
+        return;
+    }
+    // Only the last append of statement carries notice flag, so
+    // x := x + a + b makes one margin entry and one debugger notice
+    const bool notice = (s & Bytecode::APPEND_NOTICE) != 0;
+    s = uint8_t(s & ~Bytecode::APPEND_NOTICE);
+    const Variable value = valuesStack_.pop();
+    const int lineNo = contextsStack_.top().lineNo;
+    Variable & variable = findVariable(s, id);
+    variable.appendString(value.toString());
+    if (notice && isStoreVisible(lineNo) && Kumir::Core::getError().length()==0) {
+        noticeStore(variable, variable, lineNo);
+    }
+    error_ = Kumir::Core::getError();
+    nextIP();
+    if (stacksMutex_) stacksMutex_->unlock();
+}
+
+bool KumirVM::isStoreVisible(int lineNo) const
+{
+    return lineNo!=-1 &&
+            !blindMode_ &&
+            contextsStack_.top().type != EL_BELOWMAIN &&
+            contextsStack_.top().moduleContextNo == 0;
+}
+
+void KumirVM::noticeStore(Variable & variable, const Variable & value, int lineNo)
+{
+    const ValueType t = variable.baseType();
+    const String & name = variable.myName();
+    String svalue;
+    if (t==VT_string) {
+        const String valueString = value.toString();
+        svalue.reserve(valueString.length()+2);
+        svalue.push_back(Char('"'));
+        svalue.append(valueString);
+        svalue.push_back(Char('"'));
+    }
+    else if (t==VT_char) {
+        const Char valueChar = value.toChar();
+        svalue.reserve(3);
+        svalue.push_back(Char('\''));
+        svalue.push_back(valueChar);
+        svalue.push_back(Char('\''));
+    }
+    else if (t==VT_int) {
+        svalue = Kumir::Converter::sprintfInt(value.toInt(), 10, 0, 0);
+    }
+    else if (t==VT_real) {
+        svalue = Kumir::Converter::sprintfReal(value.toReal(), '.', false, 0 ,-1, 0);
+    }
+    else if (t==VT_bool) {
+        static const String YES = Kumir::Core::fromUtf8("да");
+        static const String NO = Kumir::Core::fromUtf8("нет");
+        svalue = value.toBool()? YES : NO;
+    }
+    else if (t==VT_record) {
+        Kumir::String localError;
+        svalue = (*customTypeToString_)(variable, &localError);
+    }
+    if (debugHandler_ && svalue.length()>0) {
+        const String message = name+Char('=')+svalue;
+        if (contextsStack_.top().moduleContextNo == 0)
+            debugHandler_->appendTextToMargin(lineNo, message);
+    }
+    if (debugHandler_ && currentContext().runMode==CRM_OneStep) {
+        stacksMutex_->unlock();
+        debugHandler_->debuggerNoticeOnValueChanged(variable, nullptr);
+        stacksMutex_->lock();
+    }
+}
+
 void KumirVM::do_load(uint8_t s, uint16_t id)
 {
     if (stacksMutex_) stacksMutex_->lock();
@@ -2909,7 +3015,11 @@ void KumirVM::do_line(const Bytecode::Instruction & instr)
         if (!blindMode_ && debugHandler_) {
             const uint8_t modId = currentContext().moduleId;
             const int lineNo = currentContext().lineNo;
-            if (breakpointsTable_.processBreakpointHit(modId, lineNo, nullptr)) {
+            const bool hit = breakpointsTable_.processBreakpointHit(modId, lineNo,
+                        [this](const BreakpointCondition & condition) {
+                            return isBreakpointConditionTrue(condition);
+                        });
+            if (hit) {
                 const String & sourceFileName = breakpointsTable_.registeredSourceFileName(modId);
                 debugHandler_->debuggerNoticeOnBreakpointHit(sourceFileName, uint32_t(lineNo));
             }
@@ -2918,6 +3028,48 @@ void KumirVM::do_line(const Bytecode::Instruction & instr)
     nextIP();
 }
 
+bool KumirVM::isBreakpointConditionTrue(const BreakpointCondition &condition)
+{
+    // Condition code replaces program of current context for a while,
+    // so it accesses locals and globals just like the line itself
+    const int contextsCount = contextsStack_.size();
+    const int valuesCount = valuesStack_.size();
+    const int cacheCount = cacheStack_.size();
+    const std::vector<Instruction> * program = contextsStack_.top().program;
+    const int IP = contextsStack_.top().IP;
+    VariablesTable * constants = currentConstants_;
+    const AnyValue register0 = register0_;
+
+    contextsStack_.top().program = &condition.instructions;
+    contextsStack_.top().IP = 0;
+    currentConstants_ = const_cast<VariablesTable*>(&condition.constants);
+    while (error_.length()==0 && contextsStack_.size()==contextsCount &&
+           contextsStack_.top().IP >= 0 &&
+           contextsStack_.top().IP < int(condition.instructions.size()))
+    {
+        evaluateNextInstruction();
+    }
+
+    // Stop if condition can't be evaluated, so user will see what's wrong
+    bool result = true;
+    if (error_.length()==0 && valuesStack_.size() > valuesCount) {
+        result = valuesStack_.top().toBool();
+    }
+    error_.clear();
+    Variable::unsetError();
+    while (valuesStack_.size() > valuesCount) {
+        valuesStack_.pop();
+    }
+    while (cacheStack_.size() > cacheCount) {
+        cacheStack_.pop();
+    }
+    contextsStack_.top().program = program;
+    contextsStack_.top().IP = IP;
+    currentConstants_ = constants;
+    register0_ = register0;
+    return result;
+}
+
 void KumirVM::do_sum()
 {
     Variable b = valuesStack_.pop();
@@ -3376,6 +3528,35 @@ bool KumirVM::loadProgramFromBinaryBuffer(std::list<char> &stream, bool isMain,
 }
 
 
+bool KumirVM::loadBreakpointConditionFromBinaryBuffer(std::list<char> &stream, BreakpointCondition &condition, String &error)
+{
+    error.clear();
+    if (!Bytecode::isValidSignature(stream)) {
+        error = Kumir::Core::fromUtf8("Это не исполняемый файл Кумир 2.x");
+        return false;
+    }
+    Bytecode::Data d;
+    Bytecode::bytecodeFromDataStream(stream, d);
+
+    condition = BreakpointCondition();
+    for (size_t i=0; i<d.d.size(); i++) {
+        const Bytecode::TableElem & e = d.d.at(i);
+        if (e.type==Bytecode::EL_CONST) {
+            if (condition.constants.size()<=e.id)
+                condition.constants.resize(e.id+1);
+            condition.constants[e.id] = fromTableElem(e);
+        }
+        else if (e.type==Bytecode::EL_FUNCTION) {
+            condition.instructions = e.instructions;
+        }
+    }
+    if (condition.isEmpty()) {
+        error = Kumir::Core::fromUtf8("Нет условия остановки");
+        return false;
+    }
+    return true;
+}
+
 int KumirVM::contextByIds(int moduleId, int algorhitmId) const
 {
     for (int i=contextsStack_.size()-1; i>=0; i--) {
@@ -141,6 +141,17 @@ public:
 };
 
 
+/** A pure synchronous external module function to be called directly
+ *  from VM thread, without any functor, marshalling or synchronization.
+ *
+ *  Arguments are the same as passed to ExternalModuleCallFunctor;
+ *  return value is a function return (if any) or a dummy any value (if void).
+ */
+typedef AnyValue (*IntrinsicFunction)(
+        const std::deque<Variable> & arguments,
+        Kumir::String * error
+        );
+
 /** A functor to call external module module by a given name and ID.
  *
  *  An arguments list is passed to functor; return value is a
@@ -151,6 +162,17 @@ class ExternalModuleCallFunctor: public Functor {
 public:
     inline Type type() const _override { return ExternalModuleCall; }
     typedef const std::deque<Variable> & VariableReferencesList;
+
+    /** Returns native implementation of module function (if provided by module)
+     *  to be resolved once on program load, or null otherwise
+     */
+    inline virtual IntrinsicFunction intrinsic(
+            const std::string & /*asciiModuleName*/,
+            const uint16_t /*algorithmId*/
+            )
+    {
+        return 0;
+    }
     inline virtual AnyValue operator()(
             const std::string & /*asciiModuleName*/,
             const Kumir::String & localizedModuleName,
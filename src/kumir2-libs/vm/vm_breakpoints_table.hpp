@@ -2,6 +2,7 @@
 #define VM_BREAKPOINTS_TABLE_HPP
 
 #include <map>
+#include <vector>
 #include <utility>
 extern "C" {
     #include <wchar.h>
@@ -18,11 +19,24 @@ extern "C" {
 //     typedef std::wstring std::wstring;
 // #endif
 
+#include "variant.hpp"
+#include "vm_instruction.hpp"
+
 namespace VM {
 
 typedef std::pair<uint8_t,uint32_t> BreakpointLocation;
-typedef void* BreakpointCondition; // TODO condition support
-typedef bool (*BreakpointConditionChecker)(const BreakpointCondition&);
+
+/* Compiled breakpoint condition. Instructions are evaluated within
+ * the context of algorithm containing breakpoint line and leave
+ * boolean value on stack. Constants are referenced by own numbers,
+ * not by numbers of module constants table.
+ */
+struct BreakpointCondition {
+    std::vector<Bytecode::Instruction> instructions;
+    std::vector<Variable> constants;
+
+    inline bool isEmpty() const { return instructions.empty(); }
+};
 
 struct BreakpointData {
     bool enabled;
@@ -30,14 +44,22 @@ struct BreakpointData {
     uint32_t hitCount;
     BreakpointCondition condition;
 
-    inline explicit BreakpointData(): enabled(true), ignoreCount(0), hitCount(0), condition(0) {}
+    inline explicit BreakpointData(): enabled(true), ignoreCount(0), hitCount(0) {}
 };
 
 class BreakpointsTable {
 public:
-    inline bool processBreakpointHit(const uint8_t modId, const int lineNo, const BreakpointConditionChecker * conditionChecker);
+    /** Fast check if there is any breakpoint at line */
+    inline bool hasBreakpoint(const uint8_t modId, const int lineNo) const;
+
+    /** Returns true if execution must be stopped at line. Condition
+     *  is checked by conditionChecker(const BreakpointCondition&) call,
+     *  breakpoint is counted as hit only if condition is true */
+    template <class ConditionChecker>
+    inline bool processBreakpointHit(const uint8_t modId, const int lineNo, ConditionChecker conditionChecker);
 
     inline void reset();
+    inline void resetHitCounts();
     inline void registerSourceFileName(const std::wstring & sourceFileName, const uint8_t modId);
     inline const std::wstring & registeredSourceFileName(const uint8_t & modId) const;
 
@@ -50,7 +72,12 @@ private:
     typedef std::map<BreakpointLocation,BreakpointData> BreaksTable;
     typedef std::map<std::wstring,uint8_t> SourcesToIdsTable;
     typedef std::map<uint8_t,std::wstring> IdsToSourcesTable;
+    // module id -> bit per line having breakpoint or single hit
+    typedef std::vector<uint32_t> LinesBitmap;
+
+    inline void updateLineBit(const BreakpointLocation & loc);
 
+    std::vector<LinesBitmap> lines_;
     BreaksTable breakpoints_;
     BreaksTable singleHits_;
     SourcesToIdsTable sourceToIds_;
@@ -59,9 +86,19 @@ private:
 
 // ------------ INLINE IMPLEMENTATION
 
-bool BreakpointsTable::processBreakpointHit(const uint8_t modId, const int lineNo, const BreakpointConditionChecker *conditionChecker)
+bool BreakpointsTable::hasBreakpoint(const uint8_t modId, const int lineNo) const
+{
+    if (lineNo < 0 || modId >= lines_.size())
+        return false;
+    const LinesBitmap & bits = lines_[modId];
+    const size_t word = size_t(lineNo) >> 5;
+    return word < bits.size() && 0 != (bits[word] & (1u << (lineNo & 31)));
+}
+
+template <class ConditionChecker>
+bool BreakpointsTable::processBreakpointHit(const uint8_t modId, const int lineNo, ConditionChecker conditionChecker)
 {
-    if (-1 == lineNo)
+    if (!hasBreakpoint(modId, lineNo))
         return false;
 
     bool result = false;
@@ -70,27 +107,57 @@ bool BreakpointsTable::processBreakpointHit(const uint8_t modId, const int lineN
     if (singleHits_.end() != shitIt) {
         result = true;
         singleHits_.erase(shitIt);
+        updateLineBit(loc);
     }
     if (!result) {
-        BreaksTable::const_iterator locIt = breakpoints_.find(loc);
+        BreaksTable::iterator locIt = breakpoints_.find(loc);
         if (breakpoints_.end() != locIt) {
-            const BreakpointData & data = locIt->second;
-            if (data.enabled) {
-                result = true; // TODO check for hit count and condition
+            BreakpointData & data = locIt->second;
+            if (data.enabled &&
+                    (data.condition.isEmpty() || conditionChecker(data.condition)))
+            {
+                data.hitCount ++;
+                result = data.hitCount > data.ignoreCount;
             }
         }
     }
     return result;
 }
 
+void BreakpointsTable::updateLineBit(const BreakpointLocation &loc)
+{
+    const uint8_t modId = loc.first;
+    const size_t word = size_t(loc.second) >> 5;
+    const uint32_t bit = 1u << (loc.second & 31);
+    const bool present = breakpoints_.count(loc) || singleHits_.count(loc);
+    if (present) {
+        if (modId >= lines_.size())
+            lines_.resize(modId + 1);
+        if (word >= lines_[modId].size())
+            lines_[modId].resize(word + 1, 0u);
+        lines_[modId][word] |= bit;
+    }
+    else if (modId < lines_.size() && word < lines_[modId].size()) {
+        lines_[modId][word] &= ~bit;
+    }
+}
+
 void BreakpointsTable::reset()
 {
+    lines_.clear();
     breakpoints_.clear();
     singleHits_.clear();
     sourceToIds_.clear();
     idsToSources_.clear();
 }
 
+void BreakpointsTable::resetHitCounts()
+{
+    for (BreaksTable::iterator it = breakpoints_.begin(); it != breakpoints_.end(); ++it) {
+        it->second.hitCount = 0;
+    }
+}
+
 void BreakpointsTable::registerSourceFileName(const std::wstring & sourceFileName, const uint8_t modId)
 {
     sourceToIds_[sourceFileName] = modId;
@@ -104,6 +171,7 @@ const std::wstring &BreakpointsTable::registeredSourceFileName(const uint8_t &mo
 
 void BreakpointsTable::removeAllBreakpoints()
 {
+    lines_.clear();
     singleHits_.clear();
     breakpoints_.clear();
 }
@@ -114,20 +182,12 @@ void BreakpointsTable::insertOrChangeBreakpoint(const bool enabled, const std::w
     if (sourceToIds_.end() != fnIt) {
         const uint8_t modId = fnIt->second;
         const BreakpointLocation loc(modId, lineNo);
-        BreaksTable::iterator locIt = breakpoints_.find(loc);
-        if (breakpoints_.end() != locIt) {
-            BreakpointData & data = locIt->second;
-            data.enabled = enabled;
-            data.ignoreCount = ignoreCount;
-            data.condition = condition;
-        }
-        else {
-            BreakpointData data;
-            data.enabled = enabled;
-            data.ignoreCount = ignoreCount;
-            data.condition = condition;
-            breakpoints_[loc] = data;
-        }
+        BreakpointData & data = breakpoints_[loc];
+        data.enabled = enabled;
+        data.ignoreCount = ignoreCount;
+        data.hitCount = 0;
+        data.condition = condition;
+        updateLineBit(loc);
     }
 }
 
@@ -137,12 +197,8 @@ void BreakpointsTable::insertSingleHitBreakpoint(const std::wstring &fileName, u
     if (sourceToIds_.end() != fnIt) {
         const uint8_t modId = fnIt->second;
         const BreakpointLocation loc(modId, lineNo);
-        BreakpointData data;
-        data.condition = 0;
-        data.ignoreCount = 0;
-        data.hitCount = 0;
-        data.enabled = true;
-        singleHits_[loc] = data;
+        singleHits_[loc] = BreakpointData();
+        updateLineBit(loc);
     }
 }
 
@@ -155,6 +211,7 @@ void BreakpointsTable::removeBreakpoint(const std::wstring &fileName, const uint
         BreaksTable::iterator locIt = breakpoints_.find(loc);
         if (breakpoints_.end() != locIt) {
             breakpoints_.erase(locIt);
+            updateLineBit(loc);
         }
     }
 }
@@ -47,6 +47,8 @@ enum InstructionType {
     CACHEBEGIN  = 0x33, // Push begin marker into cache
     CACHEEND    = 0x34, // Clear cache until marker
 
+    STRAPP      = 0x35, // Pop value from stack and append it to string variable in place
+
 
     // Common operations -- no comments need
 
@@ -78,6 +80,11 @@ enum LineSpecification {
     COLUMN_START_AND_END = 0x80
 };
 
+enum AppendSpecification {
+    APPEND_NOTICE = 0x80, // STRAPP scope flag: last append of statement, notice new value
+    APPEND_CHECK = 0x40 // STRAPP scope flag: only check that variable has value, stack is not used
+};
+
 /* Instruction has optimal (aka serialized) size of 32 bit:
   - first byte is Instruction Type
   - second byte is Module Number (for CALL),
@@ -150,6 +157,7 @@ inline std::string typeToString(const InstructionType & t)
     else if (t==CDROPZ) return ("cdropz");
     else if (t==CACHEBEGIN) return ("cachebegin");
     else if (t==CACHEEND) return ("cacheend");
+    else if (t==STRAPP) return ("strapp");
     else return "nop";
 }
 
@@ -204,6 +212,7 @@ inline InstructionType typeFromString(const std::string & ss)
     else if (s=="cdropz") return CDROPZ;
     else if (s=="cachebegin") return CACHEBEGIN;
     else if (s=="cacheend") return CACHEEND;
+    else if (s=="strapp") return STRAPP;
     else return NOP;
 }
 
@@ -262,6 +271,7 @@ inline std::string instructionToString(const Instruction &instr, const AS_Helper
     VariableInstructions.insert(REFARR);
     VariableInstructions.insert(SETREF);
     VariableInstructions.insert(UPDARR);
+    VariableInstructions.insert(STRAPP);
 
     static std::set<InstructionType> ModuleNoInstructions;
     ModuleNoInstructions.insert(CALL);
@@ -297,6 +307,7 @@ inline std::string instructionToString(const Instruction &instr, const AS_Helper
     HasValueInstructions.insert(PAUSE);
     HasValueInstructions.insert(CTL);
     HasValueInstructions.insert(UPDARR);
+    HasValueInstructions.insert(STRAPP);
 
     std::stringstream result;
     result.setf(std::ios::hex,std::ios::basefield);
@@ -307,7 +318,8 @@ inline std::string instructionToString(const Instruction &instr, const AS_Helper
         result << " " << int(instr.module);
     }
     if (VariableInstructions.count(t)) {
-        VariableScope s = instr.scope;
+        VariableScope s = t==STRAPP
+                ? VariableScope(instr.scope & ~(APPEND_NOTICE|APPEND_CHECK)) : instr.scope;
         if (s==GLOBAL)
             result << " global";
         else if (s==LOCAL)
@@ -315,6 +327,12 @@ inline std::string instructionToString(const Instruction &instr, const AS_Helper
         else if (s==CONSTT)
             result << " constant";
     }
+    if (t==STRAPP && (instr.scope & APPEND_NOTICE) != 0) {
+        result << " notice";
+    }
+    if (t==STRAPP && (instr.scope & APPEND_CHECK) != 0) {
+        result << " check";
+    }
     if (t == LINE) {
         uint32_t from, to;
         result.unsetf(std::ios::basefield);
@@ -339,7 +357,8 @@ inline std::string instructionToString(const Instruction &instr, const AS_Helper
     std::string r = result.str();
 
     if (VariableInstructions.count(t)) {
-        VariableScope s = instr.scope;
+        VariableScope s = t==STRAPP
+                ? VariableScope(instr.scope & ~(APPEND_NOTICE|APPEND_CHECK)) : instr.scope;
         AS_Key akey;
         const AS_Values * vals = nullptr;
         akey.first = 0;
@@ -0,0 +1,139 @@
+#ifndef VM_MODULE_CACHE_HPP
+#define VM_MODULE_CACHE_HPP
+
+/* Process-wide cache of compiled (.kod) modules.
+ *
+ * Both the analyzer (to resolve 'использовать' of binary modules) and the
+ * VM (to link external algorithms at run time) read the same .kod files,
+ * often many times per session: each reanalysis of a program importing
+ * a teacher library reparses it. The cache keeps parsed bytecode keyed by
+ * file name and invalidates an entry lazily, when the file size or
+ * modification time (with nanoseconds, where file system provides them)
+ * differs from the cached one.
+ *
+ * Cached data is immutable and shared by pointer, so a module reloaded
+ * after modification does not affect holders of the previous version.
+ */
+
+#include "vm_bytecode.hpp"
+
+#include <errno.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <fstream>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+
+namespace Bytecode {
+
+typedef std::shared_ptr<const Data> ConstDataPtr;
+
+class ModuleCache {
+public:
+    /** Returns parsed module from local-encoded file name @param fileName,
+     *  or null pointer in case of file can't be read; then @param errorCode
+     *  (if not null) is set to errno value of failed system call */
+    inline static ConstDataPtr load(const std::string & fileName, int * errorCode = 0);
+
+    /** Drops cached module @param fileName, if any */
+    inline static void invalidate(const std::string & fileName);
+
+    /** Drops all cached modules */
+    inline static void clear();
+
+private:
+    struct FileStamp {
+        long long size;
+        long long mtime;
+        long long mtimeNsec;
+        inline bool operator==(const FileStamp & other) const {
+            return size == other.size && mtime == other.mtime && mtimeNsec == other.mtimeNsec;
+        }
+    };
+    struct Entry {
+        FileStamp stamp;
+        ConstDataPtr data;
+    };
+    typedef std::map<std::string, Entry> EntriesMap;
+
+    inline static bool fileStamp(const std::string & fileName, FileStamp & stamp);
+
+    // Function-local statics are used to keep this header-only
+    inline static EntriesMap & entries() { static EntriesMap e; return e; }
+    inline static std::mutex & mutex() { static std::mutex m; return m; }
+};
+
+bool ModuleCache::fileStamp(const std::string &fileName, FileStamp &stamp)
+{
+    struct stat st;
+    if (0 != stat(fileName.c_str(), &st)) {
+        return false;
+    }
+    stamp.size = static_cast<long long>(st.st_size);
+    stamp.mtime = static_cast<long long>(st.st_mtime);
+#if defined(__APPLE__)
+    stamp.mtimeNsec = static_cast<long long>(st.st_mtimespec.tv_nsec);
+#elif defined(WIN32) || defined(_WIN32)
+    stamp.mtimeNsec = 0; // not provided by stat
+#else
+    stamp.mtimeNsec = static_cast<long long>(st.st_mtim.tv_nsec);
+#endif
+    return true;
+}
+
+ConstDataPtr ModuleCache::load(const std::string &fileName, int * errorCode)
+{
+    FileStamp stamp;
+    if (!fileStamp(fileName, stamp)) {
+        if (errorCode) {
+            *errorCode = errno;
+        }
+        invalidate(fileName);
+        return ConstDataPtr();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+        EntriesMap::const_iterator it = entries().find(fileName);
+        if (it != entries().end() && it->second.stamp == stamp) {
+            return it->second.data;
+        }
+    }
+    // Parse outside of lock: concurrent loads of the same file are harmless
+    std::ifstream file(fileName.c_str(), std::ios::in|std::ios::binary);
+    if (!file.is_open()) {
+        if (errorCode) {
+            *errorCode = errno;
+        }
+        return ConstDataPtr();
+    }
+    std::shared_ptr<Data> data(new Data);
+    bytecodeFromDataStream(file, *data);
+    file.close();
+    data->lastModified = static_cast<unsigned long>(stamp.mtime);
+    Entry entry;
+    entry.stamp = stamp;
+    entry.data = data;
+    std::lock_guard<std::mutex> lock(mutex());
+    entries()[fileName] = entry;
+    return entry.data;
+}
+
+void ModuleCache::invalidate(const std::string &fileName)
+{
+    std::lock_guard<std::mutex> lock(mutex());
+    entries().erase(fileName);
+}
+
+void ModuleCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex());
+    entries().clear();
+}
+
+} // namespace Bytecode
+
+#endif // VM_MODULE_CACHE_HPP
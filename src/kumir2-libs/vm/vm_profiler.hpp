@@ -0,0 +1,340 @@
+#ifndef VM_PROFILER_HPP
+#define VM_PROFILER_HPP
+
+/* Execution profiler for KumirVM.
+ *
+ * When set to VM by KumirVM::setProfiler, it is notified before each
+ * instruction evaluated. Instruction counts are accumulated per opcode,
+ * per algorithm, per source line and per call stack. Algorithm times are
+ * measured only when call stack changes, so the cost of regular
+ * instruction is a few counter increments. When no profiler is set,
+ * the only cost is a null pointer check.
+ */
+
+#include "context.hpp"
+#include "stack.hpp"
+#include "vm_instruction.hpp"
+
+#include <kumir2-libs/stdlib/kumirstdlib.hpp>
+
+#include <map>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <chrono>
+#include <stdint.h>
+
+namespace VM {
+
+class Profiler {
+public:
+    struct AlgorithmStats {
+        std::string name;
+        std::string fileName;
+        uint64_t calls;
+        uint64_t instructions;
+        uint64_t inclusiveNs;
+        uint64_t exclusiveNs;
+        int activeFrames; // to not count recursive calls twice in inclusive time
+        inline AlgorithmStats()
+            : calls(0u), instructions(0u), inclusiveNs(0u), exclusiveNs(0u), activeFrames(0) {}
+    };
+
+    // module context number, line number
+    typedef std::pair<size_t, int> LineKey;
+    // module context number, module id, algorithm id
+    typedef std::pair<size_t, std::pair<int,int> > AlgorithmKey;
+
+    typedef std::map<LineKey, uint64_t> LinesMap;
+    typedef std::map<AlgorithmKey, AlgorithmStats> AlgorithmsMap;
+    typedef std::map<std::string, uint64_t> StacksMap;
+
+    inline Profiler() { clear(); }
+
+    /** Drops all collected data */
+    inline void clear();
+
+    /** Called by VM before instruction evaluation */
+    inline void noticeInstruction(const Stack<Context> & contexts,
+                                  const std::vector<ModuleContext> & modules,
+                                  const Bytecode::InstructionType type);
+
+    /** Closes time measurement of still active algorithms,
+     *  must be called before reading results */
+    inline void finish();
+
+    inline uint64_t totalInstructions() const { return totalInstructions_; }
+    inline uint64_t opcodeCount(const Bytecode::InstructionType type) const { return opcodes_[type & 0xFF]; }
+    inline const LinesMap & lines() const { return lines_; }
+    inline const AlgorithmsMap & algorithms() const { return algorithms_; }
+    inline const StacksMap & stacks() const { return stacks_; }
+
+    /** Line number -> instructions count for a given module context
+     *  (0 is main program) */
+    inline std::map<int, uint64_t> lineCounts(size_t moduleContextNo) const;
+
+    /** Flat profile as JSON document */
+    inline std::string toJson() const;
+
+    /** One line per call stack: 'alg1;alg2;alg3 count', as accepted by
+     *  flamegraph.pl and compatible tools */
+    inline std::string toCollapsedStacks() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Frame {
+        AlgorithmKey key;
+        AlgorithmStats * stats;
+        uint64_t * stackCounter;
+        std::string path;
+        Clock::time_point start;
+        uint64_t childrenNs;
+        int lineNo;
+        uint64_t * lineCounter;
+    };
+
+    inline static AlgorithmKey keyOf(const Context & context) {
+        return AlgorithmKey(context.moduleContextNo, std::make_pair(int(context.moduleId), context.algId));
+    }
+    inline void syncFrames(const Stack<Context> & contexts, const std::vector<ModuleContext> & modules);
+    inline void pushFrame(const Context & context, const std::vector<ModuleContext> & modules, const Clock::time_point & now);
+    inline void popFrame(const Clock::time_point & now);
+    inline static std::string jsonString(const std::string & s);
+    inline static std::string algorithmName(const Context & context);
+
+    uint64_t totalInstructions_;
+    uint64_t opcodes_[256];
+    LinesMap lines_;
+    AlgorithmsMap algorithms_;
+    StacksMap stacks_;
+    std::vector<Frame> frames_;
+};
+
+void Profiler::clear()
+{
+    totalInstructions_ = 0u;
+    for (size_t i=0; i<256; i++) {
+        opcodes_[i] = 0u;
+    }
+    lines_.clear();
+    algorithms_.clear();
+    stacks_.clear();
+    frames_.clear();
+}
+
+void Profiler::noticeInstruction(const Stack<Context> &contexts,
+                                 const std::vector<ModuleContext> &modules,
+                                 const Bytecode::InstructionType type)
+{
+    if (frames_.size() != size_t(contexts.size()) ||
+            (!frames_.empty() && frames_.back().key != keyOf(contexts.top())))
+    {
+        syncFrames(contexts, modules);
+    }
+    if (frames_.empty()) {
+        return;
+    }
+    Frame & frame = frames_.back();
+    const int lineNo = contexts.top().lineNo;
+    if (frame.lineNo != lineNo || !frame.lineCounter) {
+        frame.lineNo = lineNo;
+        frame.lineCounter = &lines_[LineKey(frame.key.first, lineNo)];
+    }
+    totalInstructions_ ++;
+    opcodes_[type & 0xFF] ++;
+    frame.stats->instructions ++;
+    (*frame.stackCounter) ++;
+    (*frame.lineCounter) ++;
+}
+
+void Profiler::syncFrames(const Stack<Context> &contexts, const std::vector<ModuleContext> &modules)
+{
+    const Clock::time_point now = Clock::now();
+    // Find the deepest frame which is still the same
+    size_t common = 0;
+    const size_t depth = size_t(contexts.size());
+    while (common < frames_.size() && common < depth &&
+           frames_[common].key == keyOf(contexts.at(int(common))))
+    {
+        common ++;
+    }
+    while (frames_.size() > common) {
+        popFrame(now);
+    }
+    for (size_t i=common; i<depth; i++) {
+        pushFrame(contexts.at(int(i)), modules, now);
+    }
+}
+
+void Profiler::pushFrame(const Context &context, const std::vector<ModuleContext> &modules, const Clock::time_point &now)
+{
+    Frame frame;
+    frame.key = keyOf(context);
+    AlgorithmStats & stats = algorithms_[frame.key];
+    if (stats.name.empty()) {
+        stats.name = algorithmName(context);
+        if (context.moduleContextNo < modules.size()) {
+            Kumir::EncodingError encodingError;
+            stats.fileName = Kumir::Coder::encode(Kumir::UTF8, modules[context.moduleContextNo].filename, encodingError);
+        }
+    }
+    stats.calls ++;
+    stats.activeFrames ++;
+    frame.stats = &stats;
+    frame.path = frames_.empty() ? stats.name : frames_.back().path + ";" + stats.name;
+    frame.stackCounter = &stacks_[frame.path];
+    frame.start = now;
+    frame.childrenNs = 0u;
+    frame.lineNo = -1;
+    frame.lineCounter = 0;
+    frames_.push_back(frame);
+}
+
+void Profiler::popFrame(const Clock::time_point &now)
+{
+    const Frame & frame = frames_.back();
+    const uint64_t elapsed = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - frame.start).count()
+                );
+    AlgorithmStats & stats = *frame.stats;
+    stats.activeFrames --;
+    if (0 == stats.activeFrames) {
+        stats.inclusiveNs += elapsed;
+    }
+    stats.exclusiveNs += elapsed > frame.childrenNs ? elapsed - frame.childrenNs : 0u;
+    frames_.pop_back();
+    if (!frames_.empty()) {
+        frames_.back().childrenNs += elapsed;
+    }
+}
+
+void Profiler::finish()
+{
+    const Clock::time_point now = Clock::now();
+    while (!frames_.empty()) {
+        popFrame(now);
+    }
+}
+
+std::string Profiler::algorithmName(const Context &context)
+{
+    if (context.name.length() > 0) {
+        Kumir::EncodingError encodingError;
+        std::string result = Kumir::Coder::encode(Kumir::UTF8, context.name, encodingError);
+        // Collapsed stacks use ';' as separator and ' ' before counter
+        for (size_t i=0; i<result.length(); i++) {
+            if (';' == result[i]) {
+                result[i] = ',';
+            }
+        }
+        return result;
+    }
+    else if (Bytecode::EL_INIT == context.type) {
+        return "@init";
+    }
+    else if (Bytecode::EL_TESTING == context.type) {
+        return "@testing";
+    }
+    else {
+        return "@main";
+    }
+}
+
+std::map<int, uint64_t> Profiler::lineCounts(size_t moduleContextNo) const
+{
+    std::map<int, uint64_t> result;
+    for (LinesMap::const_iterator it = lines_.begin(); it != lines_.end(); ++it) {
+        if (it->first.first == moduleContextNo && it->first.second >= 0) {
+            result[it->first.second] += it->second;
+        }
+    }
+    return result;
+}
+
+std::string Profiler::jsonString(const std::string &s)
+{
+    std::string result = "\"";
+    for (size_t i=0; i<s.length(); i++) {
+        const char ch = s[i];
+        if ('"' == ch || '\\' == ch) {
+            result.push_back('\\');
+            result.push_back(ch);
+        }
+        else if ('\n' == ch) {
+            result += "\\n";
+        }
+        else if (static_cast<unsigned char>(ch) < 0x20) {
+            result.push_back(' ');
+        }
+        else {
+            result.push_back(ch);
+        }
+    }
+    result.push_back('"');
+    return result;
+}
+
+std::string Profiler::toJson() const
+{
+    std::ostringstream os;
+    os << "{\n\"instructions\": " << totalInstructions_ << ",\n";
+
+    os << "\"opcodes\": {";
+    bool first = true;
+    for (size_t i=0; i<256; i++) {
+        if (opcodes_[i] > 0u) {
+            const std::string name = Bytecode::typeToString(Bytecode::InstructionType(i));
+            os << (first ? "\n  " : ",\n  ") << jsonString(name) << ": " << opcodes_[i];
+            first = false;
+        }
+    }
+    os << "\n},\n";
+
+    os << "\"algorithms\": [";
+    first = true;
+    for (AlgorithmsMap::const_iterator it = algorithms_.begin(); it != algorithms_.end(); ++it) {
+        const AlgorithmStats & stats = it->second;
+        os << (first ? "\n  " : ",\n  ")
+           << "{\"name\": " << jsonString(stats.name)
+           << ", \"file\": " << jsonString(stats.fileName)
+           << ", \"calls\": " << stats.calls
+           << ", \"instructions\": " << stats.instructions
+           << ", \"inclusive_ms\": " << stats.inclusiveNs / 1.0e6
+           << ", \"exclusive_ms\": " << stats.exclusiveNs / 1.0e6
+           << "}";
+        first = false;
+    }
+    os << "\n],\n";
+
+    os << "\"lines\": [";
+    first = true;
+    for (LinesMap::const_iterator it = lines_.begin(); it != lines_.end(); ++it) {
+        if (it->first.second < 0) {
+            continue;
+        }
+        os << (first ? "\n  " : ",\n  ")
+           << "{\"module\": " << it->first.first
+           << ", \"line\": " << it->first.second + 1
+           << ", \"instructions\": " << it->second
+           << "}";
+        first = false;
+    }
+    os << "\n]\n}\n";
+    return os.str();
+}
+
+std::string Profiler::toCollapsedStacks() const
+{
+    std::ostringstream os;
+    for (StacksMap::const_iterator it = stacks_.begin(); it != stacks_.end(); ++it) {
+        if (it->second > 0u) {
+            os << it->first << " " << it->second << "\n";
+        }
+    }
+    return os.str();
+}
+
+} // namespace VM
+
+#endif // VM_PROFILER_HPP
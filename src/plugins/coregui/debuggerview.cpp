@@ -9,6 +9,9 @@ DebuggerView::DebuggerView(Shared::RunInterface * runner, QWidget *parent)
 {
     setAnimated(false);
     setHeaderHidden(true);
+    // All rows have same height, so long arrays are laid out
+    // without asking model for each row
+    setUniformRowHeights(true);
 }
 
 QSize DebuggerView::minimumSizeHint() const
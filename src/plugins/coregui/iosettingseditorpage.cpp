@@ -1,5 +1,6 @@
 #include "iosettingseditorpage.h"
 #include "ui_iosettingseditorpage.h"
+#include "terminal_onesession.h"
 
 namespace CoreGUI {
 
@@ -7,6 +8,8 @@ const char*   IOSettingsEditorPage::UseFixedWidthKey = "TerminalFixedWidth";
 const bool    IOSettingsEditorPage::UseFixedWidthDefaultValue = true;
 const char*   IOSettingsEditorPage::WidthSizeKey = "TermnalWidth";
 const quint16 IOSettingsEditorPage::WidthSizeDefaultValue = 64u;
+const char*   IOSettingsEditorPage::MaximumLinesCountKey = "TerminalMaximumLines";
+const int     IOSettingsEditorPage::MaximumLinesCountDefaultValue = Terminal::DefaultMaximumLinesCount;
 
 IOSettingsEditorPage::IOSettingsEditorPage(ExtensionSystem::SettingsPtr settings, QWidget *parent)
     : QWidget(parent)
@@ -32,6 +35,10 @@ void IOSettingsEditorPage::accept()
         settings_->setValue(WidthSizeKey, ui->widthInCharacters->value());
         changedKeys << WidthSizeKey;
     }
+    if (ui->maximumLinesCount->value() != settings_->value(MaximumLinesCountKey, MaximumLinesCountDefaultValue).toInt()) {
+        settings_->setValue(MaximumLinesCountKey, ui->maximumLinesCount->value());
+        changedKeys << MaximumLinesCountKey;
+    }
     if (changedKeys.size() > 0) {
         emit settingsChanged(changedKeys);
     }
@@ -48,14 +55,23 @@ void IOSettingsEditorPage::init()
                          )
                      )
                 );
+    ui->maximumLinesCount->setValue(
+                qMin(ui->maximumLinesCount->maximum(),
+                     qMax(
+                         ui->maximumLinesCount->minimum(),
+                         settings_->value(MaximumLinesCountKey, MaximumLinesCountDefaultValue).toInt()
+                         )
+                     )
+                );
 }
 
 void IOSettingsEditorPage::resetToDefaults()
 {
     settings_->setValue(UseFixedWidthKey, UseFixedWidthDefaultValue);
     settings_->setValue(WidthSizeKey, WidthSizeDefaultValue);
+    settings_->setValue(MaximumLinesCountKey, MaximumLinesCountDefaultValue);
     init();
-    emit settingsChanged(QStringList() << UseFixedWidthKey << WidthSizeKey);
+    emit settingsChanged(QStringList() << UseFixedWidthKey << WidthSizeKey << MaximumLinesCountKey);
 }
 
 } // namespace CoreGUI
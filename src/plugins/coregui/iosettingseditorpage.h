@@ -21,6 +21,8 @@ public:
     static const bool    UseFixedWidthDefaultValue;
     static const char*   WidthSizeKey;
     static const quint16 WidthSizeDefaultValue;
+    static const char*   MaximumLinesCountKey;
+    static const int     MaximumLinesCountDefaultValue;
 
     explicit IOSettingsEditorPage(ExtensionSystem::SettingsPtr settings, QWidget *parent = 0);
     ~IOSettingsEditorPage();
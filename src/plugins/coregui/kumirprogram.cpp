@@ -382,11 +382,13 @@ bool KumirProgram::prepareRunner(Shared::GeneratorInterface::DebugLevel debugLev
         kumirCodeGenerator()->generateExecutable(ast, bufArray, mimeType, fileNameSuffix);
 
         program.executableData = bufArray;
+        program.abstractSyntaxTree = ast;
         runner()->loadProgram(program);
     }
     else if (editor_->analizer()->externalToolchain()) {
         // Use external toolchain to make executable
         editor_->ensureAnalized();
+        program.abstractSyntaxTree = AST::DataPtr(); // no tree for non-Kumir languages
         editor_->analizer()->externalToolchain()->prepareToRun(Shared::Analizer::RegularRun);
         program.executableFileName = editor_->analizer()->externalToolchain()->executableFilePath();
         program.sourceFileName = editor_->analizer()->externalToolchain()->debuggableSourceFileName();
@@ -394,6 +396,7 @@ bool KumirProgram::prepareRunner(Shared::GeneratorInterface::DebugLevel debugLev
     }
     else {
         // Use source text as executable
+        program.abstractSyntaxTree = AST::DataPtr(); // no tree for non-Kumir languages
         program.executableData =editor_->analizer()->plugin()->sourceFileHandler()->toBytes(editor_->documentContents());
         program.executableFileName = program.sourceFileName;
 
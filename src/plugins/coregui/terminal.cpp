@@ -82,6 +82,13 @@ Term::Term(QWidget *parent) :
     connect(sb_vertical,SIGNAL(valueChanged(int)),plane_, SLOT(update()));
     connect(sb_horizontal,SIGNAL(valueChanged(int)),plane_, SLOT(update()));
 
+    // Program may output by many small parts, so view is
+    // updated at most once per frame instead of each time
+    outputUpdateTimer_ = new QTimer(this);
+    outputUpdateTimer_->setSingleShot(true);
+    outputUpdateTimer_->setInterval(1000 / 60);
+    connect(outputUpdateTimer_, SIGNAL(timeout()), this, SLOT(updateOutputView()));
+
 
     connect(plane_, SIGNAL(inputTextChanged(QString)),
             this, SLOT(handleInputTextChanged(QString)));
@@ -258,12 +265,16 @@ void Term::start(const QString & fileName)
             settings_->value(IOSettingsEditorPage::UseFixedWidthKey, IOSettingsEditorPage::UseFixedWidthDefaultValue).toBool()
             ? settings_->value(IOSettingsEditorPage::WidthSizeKey, IOSettingsEditorPage::WidthSizeDefaultValue).toInt()
             : -1;
+    const int maxLinesCount = settings_
+            ? settings_->value(IOSettingsEditorPage::MaximumLinesCountKey, IOSettingsEditorPage::MaximumLinesCountDefaultValue).toInt()
+            : IOSettingsEditorPage::MaximumLinesCountDefaultValue;
 
     OneSession * session = new OneSession(
                 fixedWidth,
                 fileName.isEmpty() ? tr("New Program") : QFileInfo(fileName).fileName(),
                 plane_
                 );
+    session->setMaximumLinesCount(maxLinesCount);
     session->relayout(plane_->width(), 0, true);
     connect(session, SIGNAL(updateRequest()), plane_, SLOT(update()));
     sessions_ << session;
@@ -305,9 +316,8 @@ void Term::output(const QString & text)
     if (sessions_.isEmpty())
         sessions_ << new OneSession(-1,"unknown", plane_);
     sessions_.last()->output(text, CS_Output);
-    plane_->updateScrollBars();
-    if (sb_vertical->isEnabled())
-        sb_vertical->setValue(sb_vertical->maximum());
+    if (!outputUpdateTimer_->isActive())
+        outputUpdateTimer_->start();
 }
 
 void Term::outputErrorStream(const QString & text)
@@ -316,9 +326,16 @@ void Term::outputErrorStream(const QString & text)
     if (sessions_.isEmpty())
         sessions_ << new OneSession(-1,"unknown", plane_);
     sessions_.last()->output(text, CS_Error);
+    if (!outputUpdateTimer_->isActive())
+        outputUpdateTimer_->start();
+}
+
+void Term::updateOutputView()
+{
     plane_->updateScrollBars();
     if (sb_vertical->isEnabled())
         sb_vertical->setValue(sb_vertical->maximum());
+    plane_->update();
 }
 
 void Term::input(const QString & format)
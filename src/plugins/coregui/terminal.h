@@ -67,6 +67,7 @@ protected slots:
     void handleInputCursorPositionChanged(quint16 pos);
     void handleInputFinishRequested();
     void handleInputDone(const QVariantList & values);
+    void updateOutputView();
 
 private:
     QList<class OneSession*> sessions_;
@@ -84,6 +85,7 @@ private:
     QStringList inputFormats_;
     QVariantList inputValues_;
     ExtensionSystem::SettingsPtr settings_;
+    QTimer * outputUpdateTimer_;
 
 
 };
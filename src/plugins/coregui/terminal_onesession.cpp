@@ -20,6 +20,9 @@ OneSession::OneSession(int fixedWidth, const QString & fileName, QWidget * paren
     : QObject(parent)
     , parent_(parent)
     , maxLineLength_(0u)
+    , longestLineLength_(0)
+    , maxLinesCount_(DefaultMaximumLinesCount)
+    , droppedLinesCount_(0u)
     , fileName_(fileName)
     , fixedWidth_(fixedWidth)
     , relayoutMutex_(new QMutex)
@@ -68,12 +71,7 @@ QString OneSession::fileName() const
 
 int OneSession::flexibleWidth() const
 {
-    // TODO change to std::algorithms after MSVC2010 support drop
-    int result = 0;
-    Q_FOREACH(const QString & line, lines_) {
-        result = qMax(result, line.length());
-    }
-    return result;
+    return longestLineLength_;
 }
 
 QSize OneSession::visibleSize() const
@@ -120,7 +118,7 @@ void OneSession::updateSelectionFromVisibleToRealLines()
     for (size_t visNum=0; visNum<visibleLines_.size(); ++visNum) {
         const VisibleLine & visibleLine = visibleLines_.at(visNum);
         const LineProp & visibleProp = visibleLine.prop;
-        LineProp & sourceProp = props_.at(visibleLine.sourceLineNumber);
+        LineProp & sourceProp = props_.at(visibleLine.sourceLineNumber - droppedLinesCount_);
         Q_ASSERT(visibleProp.size() == sourceProp.size());
         for (size_t x=visibleLine.from; x<visibleLine.to; ++x) {
             sourceProp[x] = visibleProp[x];
@@ -133,10 +131,12 @@ void OneSession::relayout(uint realWidth, size_t fromLine, bool headerAndFooter)
     QMutexLocker lock(relayoutMutex_.data());
     if (0==fromLine) {
         maxLineLength_ = 0;
+        longestLineLength_ = 0;
         visibleLines_.clear();
     }
     else {
-        while (visibleLines_.size() > fromLine)
+        while (!visibleLines_.empty() &&
+               visibleLines_.back().sourceLineNumber >= droppedLinesCount_ + fromLine)
             visibleLines_.pop_back();
     }
     // 1. Main text
@@ -148,6 +148,7 @@ void OneSession::relayout(uint realWidth, size_t fromLine, bool headerAndFooter)
         bool * selectedEnd = &selectedLineEnds_[i];
         Q_ASSERT(text.length()==prop.size());
         const uint charsInLine = text.length();
+        longestLineLength_ = qMax(longestLineLength_, int(text.length()));
         const uint charsInVisibleLine = fixedWidth_ == -1
                 ? widthInChars(realWidth)
                 : fixedWidth_;
@@ -169,7 +170,7 @@ void OneSession::relayout(uint realWidth, size_t fromLine, bool headerAndFooter)
                                   currentOffset + charsInVisibleLine,
                                   charsInLine
                                   ),
-                              i
+                              droppedLinesCount_ + i
                               );
             visibleLines_.push_back(vline);
             maxLineLength_ = qMax(maxLineLength_, charsInVisibleLine);
@@ -371,7 +372,12 @@ uint OneSession::drawMainText(QPainter &p, const QPoint & topLeft, const QRect &
     }
     p.save();
     p.setFont(font_);
-    for (size_t i=0; i<visibleLines_.size(); i++) {
+    // All lines are of the same height, so lines to draw are
+    // found by dirty rect without walking whole output
+    const int firstLine = qMax(0, (dirtyRect.top() - topLeft.y()) / atom.height());
+    const int lastLine = qMin(int(visibleLines_.size()) - 1,
+                              (dirtyRect.bottom() - topLeft.y()) / atom.height());
+    for (int i=firstLine; i<=lastLine; i++) {
         uint xx = topLeft.x();
         uint yy = topLeft.y() + i * atom.height() + atom.height();
         const VisibleLine & vline = visibleLines_.at(i);
@@ -756,11 +762,16 @@ QPoint OneSession::cursorPositionByVisiblePosition(const QPoint &pos) const
 
 QString OneSession::headerText() const
 {
-    return tr(">> %1:%2:%3 - %4 - Process started")
+    QString result = tr(">> %1:%2:%3 - %4 - Process started")
                 .arg(startTime_.time().hour(), 2, 10, QChar(' '))
                 .arg(startTime_.time().minute(), 2, 10, QChar('0'))
                 .arg(startTime_.time().second(), 2, 10, QChar('0'))
                 .arg(fileName_);
+    if (droppedLinesCount_ > 0) {
+        result += tr(" - output truncated, first %1 lines are not shown")
+                .arg(droppedLinesCount_);
+    }
+    return result;
 }
 
 QString OneSession::footerText() const
@@ -782,6 +793,30 @@ QFont OneSession::utilityFont() const
     return smallFont;
 }
 
+size_t OneSession::dropOldLines()
+{
+    // Line being input is never dropped
+    int count = lines_.size() - maxLinesCount_;
+    if (inputLineStart_ != -1) {
+        count = qMin(count, inputLineStart_);
+    }
+    if (maxLinesCount_ <= 0 || count <= 0) {
+        return 0u;
+    }
+    QMutexLocker lock(relayoutMutex_.data());
+    lines_.erase(lines_.begin(), lines_.begin() + count);
+    props_.erase(props_.begin(), props_.begin() + count);
+    selectedLineEnds_.erase(selectedLineEnds_.begin(), selectedLineEnds_.begin() + count);
+    droppedLinesCount_ += count;
+    while (!visibleLines_.empty() &&
+           visibleLines_.front().sourceLineNumber < droppedLinesCount_)
+        visibleLines_.pop_front();
+    if (inputLineStart_ != -1) {
+        inputLineStart_ -= count;
+    }
+    return count;
+}
+
 void OneSession::output(const QString &text, const CharSpec cs)
 {
     size_t relayoutStartLine = lines_.size() > 0? lines_.size()-1 : 0;
@@ -792,7 +827,7 @@ void OneSession::output(const QString &text, const CharSpec cs)
         if (newLine) {
             lines_.append("");
             props_.push_back(LineProp());
-            selectedLineEnds_.append(false);
+            selectedLineEnds_.push_back(false);
             curLine ++;
             curCol = 0;
         }
@@ -801,8 +836,11 @@ void OneSession::output(const QString &text, const CharSpec cs)
             props_[curLine].push_back(cs);
         }
     }
-    relayout(parent_->width() - 2 * SessionMargin, relayoutStartLine, false);
-    emit updateRequest();
+    const size_t dropped = dropOldLines();
+    relayoutStartLine = relayoutStartLine > dropped ? relayoutStartLine - dropped : 0;
+    // Header tells about dropped lines, so it is updated too;
+    // view update is requested by terminal, once for many outputs
+    relayout(parent_->width() - 2 * SessionMargin, relayoutStartLine, dropped > 0);
 }
 
 void OneSession::input(const QString &format)
@@ -811,7 +849,7 @@ void OneSession::input(const QString &format)
     if (lines_.isEmpty()) {
         lines_ << "";
         props_.push_back(LineProp());
-        selectedLineEnds_ << false;
+        selectedLineEnds_.push_back(false);
     }
     inputLineStart_ = lines_.size()-1;
     inputPosStart_ = 0;
@@ -873,7 +911,7 @@ void OneSession::changeInputText(const QString &text)
     lines_ = lines_.mid(0, inputLineStart_+1);
     size_t relayoutStartLine = lines_.size() > 0? lines_.size()-1 : 0;
     props_.resize(inputLineStart_+1);
-    selectedLineEnds_ = selectedLineEnds_.mid(0, inputLineStart_ + 1);
+    selectedLineEnds_.resize(inputLineStart_ + 1);
     if (!lines_.isEmpty()) {
         lines_[lines_.size()-1] = lines_[lines_.size()-1].mid(0,inputPosStart_);
         props_[props_.size()-1].resize(inputPosStart_);
@@ -885,7 +923,7 @@ void OneSession::changeInputText(const QString &text)
         if (newLine) {
             lines_.append("");
             props_.push_back(LineProp());
-            selectedLineEnds_.append(false);
+            selectedLineEnds_.push_back(false);
             curLine ++;
             curCol = 0;
         }
@@ -1058,10 +1096,12 @@ void OneSession::error(const QString &message)
     size_t relayoutStartLine = lines_.size() > 0? lines_.size()-1 : 0;
     lines_.append(tr("RUNTIME ERROR: %1").arg(message));
     props_.push_back(LineProp());
-    selectedLineEnds_.append(false);
+    selectedLineEnds_.push_back(false);
     for (int i=0; i<lines_.last().size(); i++) {
         props_[props_.size()-1].push_back(CS_Error);
     }
+    const size_t dropped = dropOldLines();
+    relayoutStartLine = relayoutStartLine > dropped ? relayoutStartLine - dropped : 0;
     endTime_ = QDateTime::currentDateTime();
     relayout(parent_->width() - 2 * SessionMargin, relayoutStartLine, true);
     emit updateRequest();
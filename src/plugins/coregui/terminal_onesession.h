@@ -17,12 +17,17 @@ enum CharSpec {
 
 typedef QVector<CharSpec> LineProp;
 
+/* Number of output lines kept by session if not set by settings,
+ * older lines are dropped and header notes about it */
+static const int DefaultMaximumLinesCount = 100000;
+
 struct VisibleLine {
     QString text;
     LineProp prop;
     bool * endSelected;
     size_t from;
     size_t to;
+    // Counted from session start including dropped lines
     size_t sourceLineNumber;
 
     inline explicit VisibleLine(const QString &tx, const LineProp &lp, bool * es, size_t f, size_t t, size_t n)
@@ -48,7 +53,10 @@ public:
     inline QDateTime startTime() const { return startTime_; }
     inline QDateTime endTime() const { return endTime_; }
     inline int fixedWidth() const { return fixedWidth_; }
-    inline int flexibleWidth() const;
+    int flexibleWidth() const;
+    inline void setMaximumLinesCount(int count) { maxLinesCount_ = count; }
+    inline int maximumLinesCount() const { return maxLinesCount_; }
+    inline size_t droppedLinesCount() const { return droppedLinesCount_; }
     void draw(QPainter &p, const QRect & dirtyRect) const;
     void drawInputRect(QPainter &p, const uint mainTextY) const;
     uint drawUtilityText(QPainter &p,
@@ -92,12 +100,18 @@ private:
     QFont utilityFont() const;
     void timerEvent(QTimerEvent * e);
     QSize charSize() const;
+    size_t dropOldLines();
     QWidget * parent_;
     QStringList lines_;
     std::deque<LineProp> props_;
     std::deque<VisibleLine> visibleLines_;
     mutable uint maxLineLength_; // cached to faster "relayout" method
-    QList<bool> selectedLineEnds_;
+    int longestLineLength_; // cached to faster "flexibleWidth" method
+    // Visible lines point to items, so deque is used to keep them
+    // in place while lines are appended and dropped
+    std::deque<bool> selectedLineEnds_;
+    int maxLinesCount_;
+    size_t droppedLinesCount_;
     QRect mainTextRegion_;
     QString fileName_;
     QDateTime startTime_;
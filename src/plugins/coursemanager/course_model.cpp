@@ -81,9 +81,7 @@ int courseModel::rowCount(const QModelIndex &parent) const
         // qDebug()<<"NOT VALID"<<" count"<<root.childNodes().length();
         return 1;
     }
-    QDomNode node=nodeById(parent.internalId(),root);
-
-    return subTasks(node);
+    return taskIndex.value(parent.internalId()).children.count();
 }
 
 QIcon courseModel::iconByMark(int mark, bool isFolder) const
@@ -102,23 +100,16 @@ QVariant courseModel::data(const QModelIndex &index, int role) const
     //qDebug()<<"Get data"<<index<<" role"<<role;
     if (!index.isValid())
         return QVariant();
-    QDomNode node=nodeById(index.internalId(),root);
-
     if(role==Qt::DisplayRole)
     {
 
-        QString title=node.toElement().attribute("name","");
+        QString title=nodeById(index.internalId()).toElement().attribute("name","");
 
         return QVariant(title);
     }
 
     if(role==Qt::SizeHintRole)
     {
-        QDomNode nodeM=nodeById(index.internalId(),root);
-        if(nodeM.toElement().attribute("root")=="true")
-        {
-            return QVariant(QSize(30,30));
-        }
         return QVariant(QSize(30,30));
     }
 
@@ -144,13 +135,8 @@ QVariant courseModel::data(const QModelIndex &index, int role) const
     }
     if(role==Qt::DecorationRole)
     {
-        QDomNode nodeM=nodeById(index.internalId(),root);
         // qDebug()<<"Draw Mark id"<<index.internalId();
-        if(nodeM.toElement().attribute("root")=="true")
-        {
-            //  qDebug()<<"Folder";
-        }
-        return iconByMark(taskMark(index.internalId()),nodeM.toElement().attribute("root")=="true");
+        return iconByMark(taskMark(index.internalId()),!isTask(index.internalId()));
         //NUZHNO IKONKI ISPOLNITELEY
     }
     //     if(role==Qt::BackgroundRole)
@@ -176,15 +162,9 @@ QModelIndex courseModel::index(int row, int column, const QModelIndex &parent) c
     return createMyIndex(row,column,parent);
 }
 
-int courseModel::domRow(QDomNode &child) const //TODO Check
+int courseModel::domRow(QDomNode &child) const
 {
-    QDomNode par=child.parentNode();
-    QDomNodeList list=par.childNodes();
-    for(int i=0;i<list.count();i++)
-    {
-        if(child==list.at(i))return i;
-    }
-    return 0;
+    return taskIndex.value(idByNode(child)).row;
 }
 
 QModelIndex courseModel::parent(const QModelIndex &child) const
@@ -193,11 +173,9 @@ QModelIndex courseModel::parent(const QModelIndex &child) const
     if (!child.isValid())
         return QModelIndex();
     if(child.internalId()==0)return QModelIndex();
-    QDomNode child_n=nodeById(child.internalId(),root);
-    // if(child_n.isNull())return QModelIndex();
-    QDomNode par=child_n.parentNode();
-    if(par.toElement().attribute("id").toInt()==0) return createIndex(0,0);
-    return createIndex(domRow(par),0,idByNode(par));
+    const int parId=taskIndex.value(child.internalId()).parentId;
+    if(parId<=0) return createIndex(0,0);
+    return createIndex(taskIndex.value(parId).row,0,parId);
 }
 
 int courseModel::columnCount(const QModelIndex &parent) const
@@ -218,44 +196,52 @@ QDomNode courseModel::nodeByRowColumn(int row,int column,QDomNode *parent) const
     return root;
 }
 
-QDomNode courseModel::nodeById( int id,QDomNode parent) const
+void courseModel::buildCash()
 {
-
-    if(parent.toElement().attribute("id","")==QString::number(id)) {
-        return parent;
-    }
-    if(!parent.hasChildNodes()) {
-        return QDomNode();
+    taskIndex.clear();
+    if(!root.isNull()) {
+        indexNode(root,-1,0);
     }
-    QDomNode val=cash.value(id);
+}
 
-    if(!val.isNull()) {
-        return val;
+void courseModel::indexNode(const QDomElement &el, int parentId, int row)
+{
+    const int id=idByNode(el);
+    TaskNode task;
+    task.element=el;
+    task.parentId=parentId;
+    task.row=row;
+    task.folder=el.attribute("root")=="true";
+    task.mark=el.firstChildElement("MARK").text().toInt();
+    int childRow=0;
+    for(QDomElement child=el.firstChildElement("T");!child.isNull();child=child.nextSiblingElement("T"))
+    {
+        task.children.append(idByNode(child));
+        indexNode(child,id,childRow++);
     }
+    taskIndex.insert(id,task);
+}
 
-    QDomNodeList childs=parent.childNodes();
-    for(int i=0;i<childs.length();i++)
+void courseModel::minSubMark(int id, int &min_m, bool &hasNull) const
+{
+    const QList<int> children=taskIndex.value(id).children;
+    for(int i=0;i<children.count();i++)
     {
-        if(childs.at(i).toElement().attribute("id","")==QString::number(id))
-        {
-            // if(cash.contains(id)<1)
-            //cash.insert(id,childs.at(i));
-            return childs.at(i);
-        };
-
+        int tmark=taskMark(children.at(i));
+        if(tmark==0)hasNull=true;
+        if(min_m>tmark && tmark>0)min_m=tmark;
+        minSubMark(children.at(i),min_m,hasNull);
     }
-    for(int i=0;i<childs.length();i++)
+}
+
+void courseModel::appendSubIds(int id, QList<int> &ids) const
+{
+    const QList<int> children=taskIndex.value(id).children;
+    for(int i=0;i<children.count();i++)
     {
-        // if(childs.at(i).toElement().attribute("id","")==QString::number(id))return childs.at(i);
-        if(childs.at(i).hasChildNodes())
-        {
-            QDomNode toret=nodeById(id,childs.at(i));
-            if(!toret.isNull()) {
-                return toret;
-            }
-        }
+        ids.append(children.at(i));
+        appendSubIds(children.at(i),ids);
     }
-    return QDomNode();
 }
 
 
@@ -285,22 +271,14 @@ QModelIndex courseModel::createMyIndex(int row,int column,QModelIndex parent) co
     if(id<0) {
         return QModelIndex();
     }
-    QDomNode par=nodeById(id,root);
-    if(par.isNull()) {
+    if(!taskIndex.contains(id)) {
         return QModelIndex();
     }
-    QDomNodeList childs=par.childNodes();
+    const QList<int> & childs=taskIndex[id].children;
     if(childs.count()<=row) {
         return QModelIndex();
     }
-    bool ok;
-    int new_id=childs.at(row).toElement().attribute("id","").toInt(&ok);
-    if(!ok){
-        //   qDebug()<<"Bad ID";
-        return createIndex(-10,-10,-10);
-
-    }
-    return createIndex(row,column,new_id);
+    return createIndex(row,column,childs.at(row));
 }
 
 QString courseModel::getTaskText(QModelIndex index)
@@ -308,7 +286,7 @@ QString courseModel::getTaskText(QModelIndex index)
     if(!index.isValid()) {
         return "INDEX NOT VALID";
     }
-    QDomNode node=nodeById(index.internalId(),root);
+    QDomNode node=nodeById(index.internalId());
     QDomElement titleEl=node.firstChildElement("DESC");
     if(titleEl.isNull()) {
         return "";
@@ -322,7 +300,7 @@ QString courseModel::getTaskCheck(QModelIndex index)
     if(!index.isValid()) {
         return "INDEX NOT VALID";
     }
-    QDomNode node=nodeById(index.internalId(),root);
+    QDomNode node=nodeById(index.internalId());
     QDomElement titleEl=node.firstChildElement("CHECK");
     if(titleEl.isNull()) {
         return "";
@@ -334,7 +312,7 @@ QString courseModel::getTaskCheck(QModelIndex index)
 QString courseModel::csName(int index)
 {
 
-    QDomNode node=nodeById(index,root);
+    QDomNode node=nodeById(index);
     QDomElement csEl=node.firstChildElement("CS");
     if(csEl.isNull()) {
         return "NO CS";
@@ -345,7 +323,7 @@ QString courseModel::csName(int index)
 QString courseModel::progFile(int index)
 {
 
-    QDomNode node=nodeById(index,root);
+    QDomNode node=nodeById(index);
     QDomElement csEl=node.firstChildElement("PROGRAM");
     if(csEl.isNull()) {
         return "";
@@ -356,7 +334,7 @@ QString courseModel::progFile(int index)
 QStringList courseModel::Modules(int index)
 {
 
-    QDomNode node=nodeById(index,root);
+    QDomNode node=nodeById(index);
 
     QDomElement csEl=node.firstChildElement("ISP");
     // qDebug()<<"csEl isNull:"<<csEl.isNull();
@@ -372,7 +350,7 @@ QStringList courseModel::Modules(int index)
 
 void courseModel::setIsps(QModelIndex index,QStringList isp)
 {
-    QDomNode node=nodeById(index.internalId(),root);
+    QDomNode node=nodeById(index.internalId());
     QDomElement csEl=node.firstChildElement("ISP");
     while (!csEl.isNull ())
     {
@@ -394,7 +372,7 @@ void courseModel::setIsps(QModelIndex index,QStringList isp)
 
 void courseModel::setIspEnvs(QModelIndex index,QString isp,QStringList Envs)
 {
-    QDomNode node=nodeById(index.internalId(),root);
+    QDomNode node=nodeById(index.internalId());
     QDomElement csEl=node.firstChildElement("ISP");
     while(!csEl.isNull())
     {
@@ -427,7 +405,7 @@ void courseModel::setIspEnvs(QModelIndex index,QString isp,QStringList Envs)
 QStringList courseModel::Fields(int index, QString isp)
 {
 
-    QDomNode node=nodeById(index,root);
+    QDomNode node=nodeById(index);
     QDomElement csEl=node.firstChildElement("ISP");
 
     QStringList fields;
@@ -458,7 +436,7 @@ QStringList courseModel::Fields(int index, QString isp)
 QString courseModel::Script(int index,QString isp)
 {
 
-    QDomNode node=nodeById(index,root);
+    QDomNode node=nodeById(index);
     QDomElement csEl=node.firstChildElement("ISP");
 
     while(!csEl.isNull())
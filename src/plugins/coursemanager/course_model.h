@@ -179,7 +179,7 @@ public:
          void setIsps(QModelIndex index,QStringList isp);
          void setUserText(QModelIndex index,const QString &text)
          {
-             QDomNode el=nodeById(index.internalId(),root);
+             QDomNode el=nodeById(index.internalId());
 
              QDomElement userTextEl=el.firstChildElement("USER_PRG");
              if(userTextEl.isNull()) //USER PRG пока нет - создаем
@@ -195,7 +195,7 @@ public:
          }
          void setUserText(int id,const QString &text)
          {
-             QDomNode el=nodeById(id,root);
+             QDomNode el=nodeById(id);
 
              QDomElement userTextEl=el.firstChildElement("USER_PRG");
              if(userTextEl.isNull()) //USER PRG пока нет - создаем
@@ -211,7 +211,7 @@ public:
          }
          void setUserTestedText(int id,const QString &text)
          {
-             QDomNode el=nodeById(id,root);
+             QDomNode el=nodeById(id);
 
              QDomElement userTextEl=el.firstChildElement("TESTED_PRG");
              if(userTextEl.isNull()) //USER PRG пока нет - создаем
@@ -228,7 +228,7 @@ public:
 
          QString getUserText(int curTaskId)
          {
-            QDomNode  node=nodeById(curTaskId,root);
+            QDomNode  node=nodeById(curTaskId);
             QDomElement userTextEl=node.firstChildElement("USER_PRG");
             if(userTextEl.isNull()) {qDebug()<<"Null user Prg"<<curTaskId;return "";};
             QString userPrg=userTextEl.attribute("prg");
@@ -238,7 +238,7 @@ public:
 
          QString getUserTestedText(int curTaskId)
          {
-            QDomNode  node=nodeById(curTaskId,root);
+            QDomNode  node=nodeById(curTaskId);
             QDomElement userTextEl=node.firstChildElement("TESTED_PRG");
             if(userTextEl.isNull()) {qDebug()<<"Null user  tested Prg"<<curTaskId;return "";};
             QString userPrg=userTextEl.attribute("prg");
@@ -247,7 +247,7 @@ public:
          };
          QString getTitle(int curTaskId)
          {
-            QDomNode  node=nodeById(curTaskId,root);
+            QDomNode  node=nodeById(curTaskId);
 
              return node.toElement().attribute("name","");
          };
@@ -260,7 +260,7 @@ public:
 
          void setTitle(int curTaskId,QString title)
          {
-             QDomNode el=nodeById(curTaskId,root);
+             QDomNode el=nodeById(curTaskId);
 
              el.toElement().setAttribute("name",title);
 
@@ -268,7 +268,7 @@ public:
 
           void setTag(int curTaskId,QString data,QString tag)
           {
-              QDomNode  node=nodeById(curTaskId,root);
+              QDomNode  node=nodeById(curTaskId);
               if(node.isNull())
               {
                   qDebug()<<"Set NODE NO NODE";
@@ -314,13 +314,8 @@ public:
 
          QModelIndex getIndexById(int id)
          {
-            QDomNode  node=nodeById(id,root);
-            if(node.isNull())return index(0,0,QModelIndex());
-            int col=node.columnNumber ();
-            int row=node.lineNumber();
-            if(id!=0)return index(row,col,getIndexById(idByNode(node.parentNode())));
-              else return index(row,col,QModelIndex());
-
+            if(id==0 || !taskIndex.contains(id))return index(0,0,QModelIndex());
+            return createIndex(taskIndex[id].row,0,id);
          };
          QString csName(int index);
          QString progFile(int index);
@@ -329,45 +324,25 @@ public:
          QStringList Fields(int index,QString isp);
          int taskMark(int id)const
          {
-
-
-         return taskMark(nodeById(id,root));
-
+         return taskIndex.value(id).mark;
          };
-         int taskMark(QDomNode  node)const
+         void setParMark(int pid)
          {
-
-          if(node.isNull())return 0;
-          QDomElement readyEl=node.firstChildElement("MARK");
-          if (readyEl.isNull()){
-              return 0;
-              qDebug()<<"Node is null;";
-                };
-         // qDebug()<<"MRK:"<<readyEl.text();
-         return readyEl.text().toInt();
-
-         };
-         void setParMark(QDomElement  pnode)
-         {
-             QDomNodeList childs=pnode.elementsByTagName("T");
+             if(!taskIndex.contains(pid))return;
              int min_m=11;
              bool hasNull=false;
-             for(int i=0;i<childs.count();i++)
-             {
-                 int tmark=taskMark(childs.at(i));
-                if(tmark==0)hasNull=true;
-                if(min_m>taskMark(childs.at(i))&& tmark>0 )min_m=taskMark(childs.at(i));
-             }
+             minSubMark(pid,min_m,hasNull);
              if(min_m<11 && hasNull)min_m=11;
-             if(min_m>0)setMark(idByNode(pnode),min_m);
-
-
+             if(min_m>0)setMark(pid,min_m);
          }
          void setMark(int id,int mark)
          {
            //  if(id==0)return;
-          QDomNode  node=nodeById(id,root);
-          if(node.isNull())return;
+          if(!taskIndex.contains(id))return;
+          TaskNode & task=taskIndex[id];
+          task.mark=mark;
+          QDomNode  node=task.element;
+          const int pid=task.parentId;
           QDomElement readyEl=node.firstChildElement("MARK");
             QDomText text=courceXml.createTextNode(QString::number(mark));
           if (readyEl.isNull())
@@ -376,8 +351,7 @@ public:
               node.appendChild(markEl);
               readyEl=node.firstChildElement("MARK");
               readyEl.appendChild(text);
-              qDebug()<<"Is null";
-              setParMark(node.parentNode().toElement());
+              setParMark(pid);
               return;
           };
 
@@ -395,26 +369,21 @@ public:
               readyEl.appendChild(text);
           }
 
-       //   qDebug()<<"Task "<<id<<" mark"<<taskMark(node)<<" set"<<mark;
-            setParMark(node.parentNode().toElement());
+            setParMark(pid);
          };
 
          QStringList getScripts(int id);
          bool isTask(int id) const
          {
-             QDomNode task=nodeById(id,root);
-             if(task.toElement().attribute("root")=="true")return false;
-             return true;
+             return !taskIndex.value(id).folder;
          };
          int getMaxId()
          {
              int max=0;
-            QDomNodeList list=courceXml.elementsByTagName("T");
-            for(int i=0;i<list.count();i++)
+            QHash<int,TaskNode>::const_iterator it;
+            for(it=taskIndex.constBegin();it!=taskIndex.constEnd();++it)
             {
-
-               int depId=list.at(i).toElement().attribute("id","").toInt();
-               if(depId>max)max=depId;
+               if(it.key()>max)max=it.key();
             }
 
             return max+10;
@@ -422,13 +391,7 @@ public:
          QList<int> getIDs() const
         {
             QList<int> ids;
-            QDomNodeList list=courceXml.elementsByTagName("T");
-            for(int i=0;i<list.count();i++)
-            {
-                
-                ids.append(list.at(i).toElement().attribute("id","").toInt());
-            }
-            
+            appendSubIds(0,ids);
             return ids;
         }
          int setChildsId(QDomNode par,int first_id)
@@ -458,7 +421,7 @@ public:
 
          void addSiblingTask(int id)
          {
-          QDomNode task=nodeById(id,root);
+          QDomNode task=nodeById(id);
           QDomNode copy=task.cloneNode();
            int copyid=getMaxId();
           copy.toElement().setAttribute("id",copyid);
@@ -466,9 +429,8 @@ public:
 
            task.parentNode().toElement().insertAfter(copy,task);
 
+          buildCash();
           setMark(copyid,0);
-          cash.clear();
-         // buildCash();
          };
          void addDeepTask(int id)
          {
@@ -485,14 +447,13 @@ public:
 
 
            root.toElement().insertAfter(impCopy,root.lastChild());
+           buildCash();
            setMark(copyid,0);
 
-           cash.clear();
-           buildCash();
            emit dataChanged(QModelIndex(),createIndex(rowCount()+1,1,copyid));
               return;
              };
-          QDomNode task=nodeById(id,root);
+          QDomNode task=nodeById(id);
           QDomNode copy=task.cloneNode(true);
           QDomNodeList taskChilds=task.childNodes();
            int copyid=getMaxId();
@@ -509,21 +470,19 @@ public:
           // qDebug()<<"Node app"<<chCopy.nodeName();
            };
           task.toElement().insertBefore(copy,task.firstChild());
-          setMark(copyid,0);
-         cash.clear();
          buildCash();
+          setMark(copyid,0);
          };
          void removeNode(int id)
          {
-            QDomNode task=nodeById(id,root);
+            QDomNode task=nodeById(id);
             task.parentNode().removeChild(task);
-            cash.clear();
             buildCash();
          };
 
          bool  taskAvailable(int id) const
          {
-             return taskAvailable(nodeById(id,root));
+             return taskAvailable(nodeById(id));
          }
          bool taskAvailable(QDomNode task) const
          {
@@ -541,13 +500,13 @@ public:
                      continue;
                        }
                  int depId=idEl.text().toInt();
-                 QDomNode depNode=nodeById(depId,root);//Узел от которого зависим
+                 const int depMark=taskMark(depId);//Оценка задания от которого зависим
 
                  int needMark=markEl.text().toInt();
                  int maxMark=99;
                  if(!markMaxEl.isNull())maxMark=markMaxEl.text().toInt();
                  //qDebug()<<"Need mark"<<needMark<<"Task Mark"<<taskMark(depId);
-                 if(taskMark(depNode)<needMark ||taskMark(depNode)>maxMark )
+                 if(depMark<needMark ||depMark>maxMark )
                  {
                     // qDebug()<<"task id:"<<id<<" unavailable";
                      return false;
@@ -564,32 +523,31 @@ public:
          };
          bool hasUpSib(QModelIndex &index)
          {
-             QDomNode el=nodeById(index.internalId(),root);
-            return !el.previousSiblingElement("T").isNull();
+             if(!taskIndex.contains(index.internalId()))return false;
+            return taskIndex[index.internalId()].row>0;
          };
          bool hasDownSib(QModelIndex &index)
          {
-             QDomNode el=nodeById(index.internalId(),root);
-            return !el.nextSiblingElement("T").isNull();
+             if(!taskIndex.contains(index.internalId()))return false;
+             const TaskNode & task=taskIndex[index.internalId()];
+            return task.row+1<taskIndex.value(task.parentId).children.count();
          };
     
         QModelIndex moveUp(QModelIndex &index)
          {
              if(!hasUpSib(index))return index;
-             QDomNode el=nodeById(index.internalId(),root);
+             QDomNode el=nodeById(index.internalId());
             QDomNode per=el.previousSiblingElement("T");
             el.parentNode().toElement().insertBefore(el,per);
-            cash.clear();
             buildCash();
             return createMyIndex(index.row()-1,index.column(),index.parent());
          };
         QModelIndex moveDown(QModelIndex &index)
          {
              if(!hasDownSib(index))return index;
-             QDomNode el=nodeById(index.internalId(),root);
+             QDomNode el=nodeById(index.internalId());
             QDomNode per=el.nextSiblingElement("T");
             el.parentNode().toElement().insertAfter(el,per);
-            cash.clear();
             buildCash();
             return createMyIndex(index.row()+1,index.column(),index.parent());
          };
@@ -601,19 +559,30 @@ public:
         {
            root.setAttribute("name",text);
         };
-        void buildCash()
-        {
-          QDomNodeList list =courceXml.elementsByTagName("T");
-          for(int i=0;i<list.count();i++)
-          {
-          cash.insert(list.at(i).toElement().attribute("id").toInt(),list.at(i));
-          }
-        };
+        void buildCash();
 
 private:
+         /* Index entry for KURS root and each T element, built in one
+          * pass over document. Tree navigation and marks lookup do not
+          * touch DOM, so must be rebuilt after each structure change */
+         struct TaskNode {
+             QDomElement element;
+             int parentId;
+             int row; // among T siblings
+             QList<int> children;
+             int mark;
+             bool folder;
+             TaskNode(): parentId(-1), row(0), mark(0), folder(false) {}
+         };
+         void indexNode(const QDomElement &el,int parentId,int row);
+         void minSubMark(int id,int &min_m,bool &hasNull) const;
+         void appendSubIds(int id,QList<int> &ids) const;
          QIcon iconByMark(int mark,bool isFolder)const;
          QDomNode nodeByRowColumn(int row,int column,QDomNode* parent) const;
-         QDomNode nodeById(int id,QDomNode parent) const;
+         QDomNode nodeById(int id) const
+         {
+             return taskIndex.value(id).element;
+         }
          QModelIndex createMyIndex(int row,int column,QModelIndex parent) const;
          int idByNode(QDomNode node) const
          {
@@ -647,7 +616,7 @@ private:
        QDomElement root;
        QList<QIcon> markIcons;
        bool isTeacher;
-     QHash<int,QDomNode> cash;
+     QHash<int,TaskNode> taskIndex;
 };
 
 #endif // COURSE_MODEL_H
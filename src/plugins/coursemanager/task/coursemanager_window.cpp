@@ -15,6 +15,8 @@ cursFile="";
   course=NULL;
     curDir="";
     progChange.clear();
+    workFileSize=0;
+    workFileAppended=0;
     connect(qApp,SIGNAL(aboutToQuit()),this,SLOT(aboutToQuit()));
 
 }
@@ -192,6 +194,7 @@ ui->actionSave->setEnabled(true);
 
 changes.cleanChanges();
 cursFile=fileName;
+workFileWritten="";
 };
 void MainWindowTask::loadMarks(const QString fileName)
 {
@@ -730,78 +733,130 @@ void MainWindowTask::saveCourse()
     saveCourseFile();
 
 };
+static const QByteArray WORK_FILE_TAIL = "</COURSE>\n";
+
+static void writeWorkEntry(QXmlStreamWriter &xml, const QString &tag, int id, const QString &name, const QString &value)
+{
+    xml.writeStartElement(tag);
+    xml.writeAttribute("testId",QString::number(id));
+    xml.writeAttribute(name,value);
+    xml.writeEndElement();
+}
+
 void MainWindowTask::saveCourseFile()
 {
     if(isReadOnly)return;
     qDebug()<<"Save cource file";
-    QDomDocument saveXml;
-
-    QDomElement	crsEl=saveXml.createElement("COURSE");
-    QDomElement	fileEl=saveXml.createElement("FILE");
-    QDomAttr crsAtt=saveXml.createAttribute("fileName");
-    crsAtt.setValue(cursFile);
-    fileEl.setAttributeNode(crsAtt);
+    // Workbook readers apply entries in document order, so changes are
+    // appended to file written before instead of rewriting it each time.
+    // File is rewritten completely when appended entries outnumber tasks
+    // in file, or if it was not written by us
+    const int entriesCount=2*progChange.count()+changes.marksChanged.count();
+    QFileInfo fi(cursWorkFile);
+    if(fi.absoluteFilePath()==workFileWritten && fi.exists() && fi.size()==workFileSize
+            && workFileAppended<=entriesCount)
+    {
+        appendCourseFileChanges();
+    }
+    else
+    {
+        writeCourseFile();
+    }
+};
 
-    crsEl.appendChild(fileEl);
-    saveXml.appendChild(crsEl);
-    QDomElement	mrksEl=saveXml.createElement("MARKS");
+void MainWindowTask::writeCourseFile()
+{
+    QByteArray data;
+    QXmlStreamWriter xml(&data);
+    xml.setAutoFormatting(true);
+    xml.writeStartDocument();
+    xml.writeStartElement("COURSE");
+    xml.writeEmptyElement("FILE");
+    xml.writeAttribute("fileName",cursFile);
+    savedPrograms.clear();
+    savedTestedPrograms.clear();
 
     //USER PROGRAMS n TESTED PROGRAMS
     for(int i=0;i<progChange.count();i++){
-    QDomElement	prgEl=saveXml.createElement("USER_PRG");
-    QDomAttr testIdprg=saveXml.createAttribute("testId");
-    testIdprg.setValue(QString::number(progChange[i]));
-    QDomAttr userPrg=saveXml.createAttribute("prg");
-    userPrg.setValue(course->getUserText(progChange[i]));
-    prgEl.setAttributeNode(testIdprg);
-    prgEl.setAttributeNode(userPrg);
-    crsEl.appendChild(prgEl);
-
-    QDomElement	prgElT=saveXml.createElement("TESTED_PRG");
-    QDomAttr testIdprgT=saveXml.createAttribute("testId");
-    testIdprgT.setValue(QString::number(progChange[i]));
-    QDomAttr userPrgT=saveXml.createAttribute("prg");
-    userPrgT.setValue(course->getUserTestedText(progChange[i]));
-    prgElT.setAttributeNode(testIdprg);
-    prgElT.setAttributeNode(userPrgT);
-    crsEl.appendChild(prgElT);
-
-
-
-     }
+        const int id=progChange[i];
+        savedPrograms[id]=course->getUserText(id);
+        savedTestedPrograms[id]=course->getUserTestedText(id);
+        writeWorkEntry(xml,"USER_PRG",id,"prg",savedPrograms[id]);
+        writeWorkEntry(xml,"TESTED_PRG",id,"prg",savedTestedPrograms[id]);
+    }
     //END USER PROGRAMS
 
-
-
-
+    xml.writeStartElement("MARKS");
     QMapIterator<int, int> i(changes.marksChanged);
     while (i.hasNext()) {
         i.next();
-        QDomElement mrk=saveXml.createElement("MARK");
-        QDomAttr testId=saveXml.createAttribute("testId");
-        testId.setValue(QString::number(i.key()));
-        QDomAttr mvalue=saveXml.createAttribute("mark");
-        mvalue.setValue(QString::number(i.value()));
-        mrk.setAttributeNode(testId);
-        mrk.setAttributeNode(mvalue);
-        mrksEl.appendChild(mrk);
+        writeWorkEntry(xml,"MARK",i.key(),"mark",QString::number(i.value()));
     }
-    crsEl.appendChild(mrksEl);
-
-
-
-
+    xml.writeEndElement();
+    savedMarks=changes.marksChanged;
+    // COURSE is closed by hand to know exact file tail
+    data.append("\n"+WORK_FILE_TAIL);
 
           if  (!cursWorkFile.open(QIODevice::WriteOnly))
           {
           QMessageBox::information( 0, "", QString("Ошибка записи: ") + cursWorkFile.fileName(), 0,0,0);
+          workFileWritten="";
           return;
           };
-    cursWorkFile.write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
-    cursWorkFile.write(saveXml.toByteArray());
+    cursWorkFile.write(data);
     cursWorkFile.close();
+    workFileWritten=QFileInfo(cursWorkFile).absoluteFilePath();
+    workFileSize=data.size();
+    workFileAppended=0;
+}
 
-};
+void MainWindowTask::appendCourseFileChanges()
+{
+    QByteArray data;
+    QXmlStreamWriter xml(&data);
+    xml.setAutoFormatting(true);
+    int appended=0;
+    for(int i=0;i<progChange.count();i++){
+        const int id=progChange[i];
+        const QString prg=course->getUserText(id);
+        const QString tested=course->getUserTestedText(id);
+        if(!savedPrograms.contains(id) || savedPrograms[id]!=prg){
+            writeWorkEntry(xml,"USER_PRG",id,"prg",prg);
+            savedPrograms[id]=prg;
+            appended++;
+        }
+        if(!savedTestedPrograms.contains(id) || savedTestedPrograms[id]!=tested){
+            writeWorkEntry(xml,"TESTED_PRG",id,"prg",tested);
+            savedTestedPrograms[id]=tested;
+            appended++;
+        }
+    }
+    QMapIterator<int, int> i(changes.marksChanged);
+    while (i.hasNext()) {
+        i.next();
+        if(!savedMarks.contains(i.key()) || savedMarks[i.key()]!=i.value()){
+            writeWorkEntry(xml,"MARK",i.key(),"mark",QString::number(i.value()));
+            savedMarks[i.key()]=i.value();
+            appended++;
+        }
+    }
+    if(appended==0)return;
+    data.append("\n"+WORK_FILE_TAIL);
+
+    if(!cursWorkFile.open(QIODevice::ReadWrite)
+            || !cursWorkFile.seek(workFileSize-WORK_FILE_TAIL.size())
+            || cursWorkFile.read(WORK_FILE_TAIL.size())!=WORK_FILE_TAIL)
+    {
+        cursWorkFile.close();
+        writeCourseFile();
+        return;
+    }
+    cursWorkFile.seek(workFileSize-WORK_FILE_TAIL.size());
+    cursWorkFile.write(data);
+    cursWorkFile.close();
+    workFileSize+=data.size()-WORK_FILE_TAIL.size();
+    workFileAppended+=appended;
+}
 
 void MainWindowTask::markProgChange()
 {
@@ -22,6 +22,7 @@
 #include "editdialog.h"
 #include "newkursdialog.h"
 #include <QTextBrowser>
+#include <QXmlStreamWriter>
 
 #ifdef interface
 #undef interface // used name 'interface' conflicts with Windows SDK
@@ -149,6 +150,8 @@ private:
     void setTaskViewHtml(const QString & data);
     void setTaskViewUrl(const QUrl & url);
     void markProgChange();
+    void writeCourseFile();
+    void appendCourseFileChanges();
     void createMoveMenu();
     void setUpDown(QModelIndex index);
     QString loadScript(QString file_name);
@@ -167,6 +170,13 @@ private:
     QString cursFile;
     QList<int> progChange;
     QFile cursWorkFile;
+    // State of work file as written by saveCourseFile
+    QString workFileWritten;
+    qint64 workFileSize;
+    int workFileAppended;
+    QHash<int,QString> savedPrograms;
+    QHash<int,QString> savedTestedPrograms;
+    QMap<int,int> savedMarks;
     QMenu customMenu;
     bool isTeacher;
     //EditDialog* editDialog;
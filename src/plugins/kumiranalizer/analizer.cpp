@@ -81,15 +81,15 @@ Analizer::Analizer(KumirAnalizerPlugin * plugin, bool teacherMode)
     _syntaxAnalizer = new SyntaxAnalizer(_lexer, _AlwaysAvailableModulesName, _teacherMode, this);
     _syntaxAnalizer->init(_statements, _ast);
     _builtinModules.resize(16);
-    ActorInterface * stdFunct = new StdLibModules::RTL;
+    ActorInterface * stdFunct = StdLibModules::RTL::instance();
     _builtinModules[0] = stdFunct;
     createModuleFromActor_stage1(stdFunct, 0xF0);
     createModuleFromActor_stage2(stdFunct);
-    ActorInterface * filesFunct = new StdLibModules::Files;
+    ActorInterface * filesFunct = StdLibModules::Files::instance();
     _builtinModules[1] = filesFunct;
     createModuleFromActor_stage1(filesFunct, 0xF1);
     createModuleFromActor_stage2(filesFunct);
-    ActorInterface * stringsFunct = new StdLibModules::Strings;
+    ActorInterface * stringsFunct = StdLibModules::Strings::instance();
     _builtinModules[2] = stringsFunct;
     createModuleFromActor_stage1(stringsFunct, 0xF2);
     createModuleFromActor_stage2(stringsFunct);
@@ -296,9 +296,6 @@ Analizer::~Analizer()
 {
     delete _lexer;
     delete _pdAutomata;
-    delete _builtinModules[0];
-    delete _builtinModules[1];
-    delete _builtinModules[2];
 }
 
 
@@ -411,75 +408,6 @@ void Analizer::setSourceText(const QString & text)
 
 QStringList Analizer::_AlwaysAvailableModulesName;
 
-void Analizer::createModuleFromActor_stage1(Shared::ActorInterface * actor, quint8 forcedId)
-{
-    // Stage 1 -- add to table and build type list
-    AST::ModulePtr mod = AST::ModulePtr(new AST::Module());
-    mod->builtInID = forcedId;
-    mod->header.type = AST::ModTypeExternal;
-    mod->header.name = actor->localizedModuleName(QLocale::Russian);
-    mod->header.asciiName = actor->asciiModuleName();
-//    if (-1 != mo_header.name.indexOf("%")) {
-//        mo_header.nameTemplate = mo_header.name;
-//        static const QRegExp rxTemplateParameter("%[sdfb]");
-//        int p = 0;
-//        Q_FOREVER {
-//            p = rxTemplateParameter.indexIn(mo_header.nameTemplate, p);
-//            if (-1 == p) break;
-//            p += rxTemplateParameter.matchedLength();
-//            const QString cap = rxTemplateParameter.cap();
-//            QVariant::Type templateType;
-//            const QChar ch = cap[1];
-//            switch (ch.toLatin1()) {
-//            case 'd': templateType = QVariant::Int; break;
-//            case 'f': templateType = QVariant::Double; break;
-//            case 'b': templateType = QVariant::Bool; break;
-//            default:  templateType = QVariant::String;
-//            }
-//            mo_header.templateTypes.append(templateType);
-//            mo_header.templateParameters.append(QVariant::Invalid);
-//        }
-
-//        mo_header.name = mo_header.name.left(mo_header.name.indexOf("%")).trimmed();
-//    }
-//    if (-1 != mo_header.asciiName.indexOf("%")) {
-//        mo_header.asciiName = mo_header.asciiName.left(mo_header.asciiName.indexOf("%")).trimmed();
-//    }
-    mod->impl.actor = AST::ActorPtr(actor);
-    _ast->modules << ModulePtr(mod);
-    const Shared::ActorInterface::TypeList typeList = actor->typeList();
-    for (int i=0; i<typeList.size(); i++) {
-        typedef Shared::ActorInterface AI;
-        AI::RecordSpecification ct = typeList[i];
-        AST::Type tp;
-        if (ct.localizedNames.contains(QLocale::Russian))
-            tp.name = ct.localizedNames[QLocale::Russian];
-        else
-            tp.name = QString::fromLatin1(ct.asciiName);
-        tp.actor = AST::ActorPtr(actor);
-        tp.asciiName = ct.asciiName;
-        AI::Record record = ct.record;
-        for (int j=0; j<record.size(); j++) {
-            AI::Field field = record[j];
-            AI::FieldType ft = field.second;
-            AST::Type afield;
-            if (ft==AI::Int)
-                afield.kind = AST::TypeInteger;
-            else if (ft==AI::Real)
-                afield.kind = AST::TypeReal;
-            else if (ft==AI::Bool)
-                afield.kind = AST::TypeBoolean;
-            else if (ft==AI::Char)
-                afield.kind = AST::TypeCharect;
-            else if (ft==AI::String)
-                afield.kind = AST::TypeString;
-            tp.userTypeFields << AST::Field(field.first, afield);
-        }
-        tp.kind = AST::TypeUser;
-        mod->header.types << tp;
-    }    
-}
-
 static AST::Type actorTypeToASTType(const Shared::ActorInterface::FieldType ft,
                                     const Shared::ActorInterface::RecordSpecification & spec)
 {
@@ -518,15 +446,50 @@ static AST::Type actorTypeToASTType(const Shared::ActorInterface::FieldType ft,
     return result;
 }
 
-void Analizer::createModuleFromActor_stage2(Shared::ActorInterface * actor)
+/** Parts of external module which depend on actor only, so built once
+ *  and shared by all analizer instances. Modules itself are not shared
+ *  as they hold per-AST 'usedBy' references */
+struct ExternalModulePrototype {
+    QList<AST::Type> types;
+    QList<AST::AlgorithmPtr> algorithms;
+    QList<AST::AlgorithmPtr> operators;
+};
+
+static ExternalModulePrototype createExternalModulePrototype(Shared::ActorInterface * actor)
 {
-    // Stage 2 -- build functions list
-    AST::ModulePtr mod = moduleByActor(_ast, actor);
-    QList<Shared::ActorInterface*> deps = actor->usesList();
-    foreach (Shared::ActorInterface* dep, deps) {
-        AST::ModulePtr dmod = moduleByActor(_ast, dep);
-        mod->header.usedBy.append(mod.toWeakRef());
+    ExternalModulePrototype result;
+    const Shared::ActorInterface::TypeList typeList = actor->typeList();
+    for (int i=0; i<typeList.size(); i++) {
+        typedef Shared::ActorInterface AI;
+        AI::RecordSpecification ct = typeList[i];
+        AST::Type tp;
+        if (ct.localizedNames.contains(QLocale::Russian))
+            tp.name = ct.localizedNames[QLocale::Russian];
+        else
+            tp.name = QString::fromLatin1(ct.asciiName);
+        tp.actor = AST::ActorPtr(actor);
+        tp.asciiName = ct.asciiName;
+        AI::Record record = ct.record;
+        for (int j=0; j<record.size(); j++) {
+            AI::Field field = record[j];
+            AI::FieldType ft = field.second;
+            AST::Type afield;
+            if (ft==AI::Int)
+                afield.kind = AST::TypeInteger;
+            else if (ft==AI::Real)
+                afield.kind = AST::TypeReal;
+            else if (ft==AI::Bool)
+                afield.kind = AST::TypeBoolean;
+            else if (ft==AI::Char)
+                afield.kind = AST::TypeCharect;
+            else if (ft==AI::String)
+                afield.kind = AST::TypeString;
+            tp.userTypeFields << AST::Field(field.first, afield);
+        }
+        tp.kind = AST::TypeUser;
+        result.types << tp;
     }
+
     foreach (const Shared::ActorInterface::Function & function, actor->functionList()) {
 
         static const QList<QByteArray> Operators = QList<QByteArray>()
@@ -567,12 +530,77 @@ void Analizer::createModuleFromActor_stage2(Shared::ActorInterface * actor)
         }
 
         if (Operators.contains(function.asciiName)) {
-            mod->header.operators.push_back(alg);
+            result.operators.push_back(alg);
         }
         else {
-            mod->header.algorhitms.push_back(alg);
+            result.algorithms.push_back(alg);
         }
     }
+    return result;
+}
+
+static ExternalModulePrototype externalModulePrototype(Shared::ActorInterface * actor)
+{
+    static QMutex mutex;
+    static QHash<Shared::ActorInterface*, ExternalModulePrototype> prototypes;
+    QMutexLocker lock(&mutex);
+    if (!prototypes.contains(actor)) {
+        prototypes.insert(actor, createExternalModulePrototype(actor));
+    }
+    return prototypes.value(actor);
+}
+
+void Analizer::createModuleFromActor_stage1(Shared::ActorInterface * actor, quint8 forcedId)
+{
+    // Stage 1 -- add to table and build type list
+    AST::ModulePtr mod = AST::ModulePtr(new AST::Module());
+    mod->builtInID = forcedId;
+    mod->header.type = AST::ModTypeExternal;
+    mod->header.name = actor->localizedModuleName(QLocale::Russian);
+    mod->header.asciiName = actor->asciiModuleName();
+//    if (-1 != mo_header.name.indexOf("%")) {
+//        mo_header.nameTemplate = mo_header.name;
+//        static const QRegExp rxTemplateParameter("%[sdfb]");
+//        int p = 0;
+//        Q_FOREVER {
+//            p = rxTemplateParameter.indexIn(mo_header.nameTemplate, p);
+//            if (-1 == p) break;
+//            p += rxTemplateParameter.matchedLength();
+//            const QString cap = rxTemplateParameter.cap();
+//            QVariant::Type templateType;
+//            const QChar ch = cap[1];
+//            switch (ch.toLatin1()) {
+//            case 'd': templateType = QVariant::Int; break;
+//            case 'f': templateType = QVariant::Double; break;
+//            case 'b': templateType = QVariant::Bool; break;
+//            default:  templateType = QVariant::String;
+//            }
+//            mo_header.templateTypes.append(templateType);
+//            mo_header.templateParameters.append(QVariant::Invalid);
+//        }
+
+//        mo_header.name = mo_header.name.left(mo_header.name.indexOf("%")).trimmed();
+//    }
+//    if (-1 != mo_header.asciiName.indexOf("%")) {
+//        mo_header.asciiName = mo_header.asciiName.left(mo_header.asciiName.indexOf("%")).trimmed();
+//    }
+    mod->impl.actor = AST::ActorPtr(actor);
+    _ast->modules << ModulePtr(mod);
+    mod->header.types = externalModulePrototype(actor).types;
+}
+
+void Analizer::createModuleFromActor_stage2(Shared::ActorInterface * actor)
+{
+    // Stage 2 -- build functions list
+    AST::ModulePtr mod = moduleByActor(_ast, actor);
+    QList<Shared::ActorInterface*> deps = actor->usesList();
+    foreach (Shared::ActorInterface* dep, deps) {
+        AST::ModulePtr dmod = moduleByActor(_ast, dep);
+        mod->header.usedBy.append(mod.toWeakRef());
+    }
+    const ExternalModulePrototype prototype = externalModulePrototype(actor);
+    mod->header.algorhitms = prototype.algorithms;
+    mod->header.operators = prototype.operators;
 }
 
 
@@ -1065,6 +1093,31 @@ const AST::DataPtr Analizer::abstractSyntaxTree() const
     return _ast;
 }
 
+AST::ExpressionPtr Analizer::parseExpression(int lineNo, const QString &text,
+                                             AST::ModulePtr &module, AST::AlgorithmPtr &algorithm,
+                                             QString &error) const
+{
+    module = findModuleByLine(lineNo);
+    algorithm = findAlgorhitmByLine(module, lineNo);
+    AST::ExpressionPtr result;
+    QString errorKey;
+    if (!algorithm) {
+        errorKey = _("Condition must be inside algorithm");
+    }
+    else {
+        QList<LexemPtr> lexems;
+        _lexer->splitIntoLexems(text, lexems, gatherExtraTypeNames(module));
+        for (int i=0; i<lexems.size(); i++) {
+            lexems[i]->lineNo = lineNo;
+        }
+        result = _syntaxAnalizer->parseCondition(lexems, module, algorithm, errorKey);
+    }
+    error = errorKey.isEmpty()
+            ? QString()
+            : ErrorMessages::message("KumirAnalizer", Analizer::_NativeLanguage, errorKey);
+    return result;
+}
+
 
 const AST::ModulePtr Analizer::findModuleByLine(int lineNo) const
 {
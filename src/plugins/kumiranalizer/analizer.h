@@ -83,6 +83,9 @@ public slots:
     QString createImportStatementLine(const QString &importName) const;
 
     const AST::DataPtr abstractSyntaxTree() const;
+    AST::ExpressionPtr parseExpression(int lineNo, const QString & text,
+                                       AST::ModulePtr & module, AST::AlgorithmPtr & algorithm,
+                                       QString & error) const;
 
     const AST::ModulePtr findModuleByLine(int lineNo) const;
 
@@ -11,12 +11,21 @@ class RTL
 
 {
 public:
+    inline static RTL * instance() { static RTL module; return &module; }
+
     inline QByteArray asciiModuleName() const { return QByteArray("Kumir Standard Library"); }
     inline QString localizedModuleName(const QLocale::Language) const {return QString::fromUtf8("Стандартные функции");}
 
     inline void terminateEvaluation() {}
 
     inline FunctionList functionList() const {
+        // Table is immutable, so built once per process and shared
+        // by all analizer instances
+        static const FunctionList list = createFunctionList();
+        return list;
+    }
+
+    inline FunctionList createFunctionList() const {
         FunctionList result;
         Function func;
         func.accessType = PublicFunction;
@@ -458,12 +467,20 @@ public:
 class Files
         : public Shared::ActorInterface
 {
+public:
+    inline static Files * instance() { static Files module; return &module; }
+
     inline QByteArray asciiModuleName() const { return QByteArray("Files"); }
     inline QString localizedModuleName(const QLocale::Language) const {return QString::fromUtf8("Файлы");}
 
     inline void terminateEvaluation() {}
 
     inline TypeList typeList() const {
+        static const TypeList list = createTypeList();
+        return list;
+    }
+
+    inline TypeList createTypeList() const {
         TypeList result;
         Field fileKey(QByteArray("key"), Int);
         Field openMode(QByteArray("mode"), Int);
@@ -480,6 +497,11 @@ class Files
     }
 
     inline FunctionList functionList() const {
+        static const FunctionList list = createFunctionList();
+        return list;
+    }
+
+    inline FunctionList createFunctionList() const {
         FunctionList result;
         Function func;
         func.accessType = PublicFunction;
@@ -729,11 +751,19 @@ class Files
 class Strings
         : public Shared::ActorInterface
 {
+public:
+    inline static Strings * instance() { static Strings module; return &module; }
+
     inline QByteArray asciiModuleName() const { return QByteArray("String Utilities"); }
     inline QString localizedModuleName(const QLocale::Language) const {return QString::fromUtf8("Строки");}
     inline void terminateEvaluation() {}
 
     inline FunctionList functionList() const {
+        static const FunctionList list = createFunctionList();
+        return list;
+    }
+
+    inline FunctionList createFunctionList() const {
         FunctionList result;
         Function func;
         func.accessType = PublicFunction;
@@ -11,7 +11,7 @@
 #include <kumir2-libs/errormessages/errormessages.h>
 #include <kumir2-libs/extensionsystem/pluginmanager.h>
 #include <kumir2/actorinterface.h>
-#include <kumir2-libs/vm/vm_bytecode.hpp>
+#include <kumir2-libs/vm/vm_module_cache.hpp>
 
 
 using namespace Shared;
@@ -1222,67 +1222,7 @@ void SyntaxAnalizer::buildTables(bool isInternalBuild)
         const QString name = unresolvedImports_.values()[i];
         QString error;
         if (name.endsWith(".kod")) {
-            QString canonicalName = name;
-            if (canonicalName.startsWith(QDir::currentPath())) {
-                canonicalName.remove(0, QDir::currentPath().length());
-                if (canonicalName.startsWith("/"))
-                    canonicalName.remove(0,1);
-            }
-            QFileInfo kodFile(name);
-            QString kodFilePath = QDir::toNativeSeparators(kodFile.absoluteFilePath());
-            char programName[1024];
-            strcpy(programName, kodFilePath.toLocal8Bit().constData());
-            std::ifstream programFile(programName,  std::ios::in|std::ios::binary);
-            Bytecode::Data programData;
-            if (!programFile.is_open()) {
-                error = _("Can't open module file");
-            }
-            else {                
-                Bytecode::bytecodeFromDataStream(programFile, programData);
-            }
-            programFile.close();
-            if (error.length()==0) {
-                AST::ModulePtr  module = AST::ModulePtr(new AST::Module);
-                module->header.type = AST::ModTypeCached;
-                module->header.name = canonicalName;
-                ast_->modules.push_back(module);
-                for (size_t e=0; e<programData.d.size(); e++) {
-                    const Bytecode::TableElem & elem = programData.d.at(e);
-                    if (elem.type==Bytecode::EL_FUNCTION || elem.type==Bytecode::EL_MAIN) {
-                        const QString algName = QString::fromStdWString(elem.name);
-                        if (algName.length()>0 && !algName.startsWith("_")) {
-                            AST::AlgorithmPtr  alg = AST::AlgorithmPtr(new AST::Algorithm);
-                            alg->header.name = algName;
-                            alg->header.implType = AST::AlgorhitmExternal;
-                            alg->header.external.moduleName = canonicalName;
-                            alg->header.external.id = elem.id;
-                            const QString signature = QString::fromStdWString(elem.signature);
-                            QStringList algSig = signature.split(":");
-                            alg->header.returnType = typeFromSignature(algSig[0]);
-                            if (algSig.size()>1) {
-                                QStringList argSignatures = algSig[1].split(",");
-                                for (int argNo=0; argNo<argSignatures.size(); argNo++) {
-                                    if (argSignatures[argNo].length()==0)
-                                        break;
-                                    AST::VariablePtr  var = AST::VariablePtr(new AST::Variable);
-                                    QStringList sigPair = argSignatures[argNo].split(" ");
-                                    if (sigPair[0]=="in")
-                                        var->accessType = AST::AccessArgumentIn;
-                                    else if (sigPair[0]=="out")
-                                        var->accessType = AST::AccessArgumentOut;
-                                    else if (sigPair[0]=="inout")
-                                        var->accessType = AST::AccessArgumentInOut;
-                                    var->baseType = typeFromSignature(sigPair[1]);
-                                    var->dimension = sigPair[1].count("[]");
-                                    alg->header.arguments.push_back(var);
-                                }
-                            }
-                            module->header.algorhitms.push_back(alg);
-                        }
-                    }
-                }
-            }
-
+            loadKodFile(name, error);
         }
     }
 
@@ -1841,6 +1781,58 @@ QStringList SyntaxAnalizer::checkForConflictingNames(const ModulePtr &moduleToCh
     return result.values();
 }
 
+/** Public algorithms of compiled module, built once per module version */
+struct KodModuleHeaders {
+    Bytecode::ConstDataPtr data;
+    QString canonicalName;
+    QList<AST::AlgorithmPtr> algorithms;
+};
+
+static QMutex KodModuleHeadersMutex;
+static QHash<QString,KodModuleHeaders> KodModuleHeadersCache;
+
+static QList<AST::AlgorithmPtr> kodModuleAlgorithms(const QString & canonicalName,
+                                                    const Bytecode::Data & programData)
+{
+    QList<AST::AlgorithmPtr> result;
+    for (size_t e=0; e<programData.d.size(); e++) {
+        const Bytecode::TableElem & elem = programData.d.at(e);
+        if (elem.type==Bytecode::EL_FUNCTION || elem.type==Bytecode::EL_MAIN) {
+            const QString algName = QString::fromStdWString(elem.name);
+            if (algName.length()>0 && !algName.startsWith("_")) {
+                AST::Algorithm * alg = new AST::Algorithm;
+                alg->header.name = algName;
+                alg->header.implType = AST::AlgorhitmExternal;
+                alg->header.external.moduleName = canonicalName;
+                alg->header.external.id = elem.id;
+                const QString signature = QString::fromStdWString(elem.signature);
+                QStringList algSig = signature.split(":");
+                alg->header.returnType = typeFromSignature(algSig[0]);
+                if (algSig.size()>1) {
+                    QStringList argSignatures = algSig[1].split(",");
+                    for (int argNo=0; argNo<argSignatures.size(); argNo++) {
+                        if (argSignatures[argNo].length()==0)
+                            break;
+                        AST::Variable * var = new AST::Variable;
+                        QStringList sigPair = argSignatures[argNo].split(" ");
+                        if (sigPair[0]=="in")
+                            var->accessType = AST::AccessArgumentIn;
+                        else if (sigPair[0]=="out")
+                            var->accessType = AST::AccessArgumentOut;
+                        else if (sigPair[0]=="inout")
+                            var->accessType = AST::AccessArgumentInOut;
+                        var->baseType = typeFromSignature(sigPair[1]);
+                        var->dimension = sigPair[1].count("[]");
+                        alg->header.arguments.push_back(AST::VariablePtr(var));
+                    }
+                }
+                result.push_back(AST::AlgorithmPtr(alg));
+            }
+        }
+    }
+    return result;
+}
+
 AST::ModulePtr SyntaxAnalizer::loadKodFile(const QString &name, QString &error)
 {
     QString canonicalName = name;
@@ -1851,60 +1843,40 @@ AST::ModulePtr SyntaxAnalizer::loadKodFile(const QString &name, QString &error)
     }
     QFileInfo kodFile(name);
     QString kodFilePath = QDir::toNativeSeparators(kodFile.absoluteFilePath());
-    char programName[1024];
-    strcpy(programName, kodFilePath.toLocal8Bit().constData());
-    std::ifstream programFile(programName,  std::ios::in|std::ios::binary);
-    Bytecode::Data programData;
-    if (!programFile.is_open()) {
+    const Bytecode::ConstDataPtr programData =
+            Bytecode::ModuleCache::load(kodFilePath.toLocal8Bit().constData());
+    if (!programData) {
         error = _("Can't open module file");
+        return AST::ModulePtr();
     }
-    else {        
-        Bytecode::bytecodeFromDataStream(programFile, programData);
-    }
-    programFile.close();
-    AST::ModulePtr result;
-    if (error.length()==0) {
-        AST::Module * module = new AST::Module;
-        module->header.type = AST::ModTypeCached;
-        module->header.name = canonicalName;
-        for (size_t e=0; e<programData.d.size(); e++) {
-            const Bytecode::TableElem & elem = programData.d.at(e);
-            if (elem.type==Bytecode::EL_FUNCTION || elem.type==Bytecode::EL_MAIN) {
-                const QString algName = QString::fromStdWString(elem.name);
-                if (algName.length()>0 && !algName.startsWith("_")) {
-                    AST::Algorithm * alg = new AST::Algorithm;
-                    alg->header.name = algName;
-                    alg->header.implType = AST::AlgorhitmExternal;
-                    alg->header.external.moduleName = canonicalName;
-                    alg->header.external.id = elem.id;
-                    const QString signature = QString::fromStdWString(elem.signature);
-                    QStringList algSig = signature.split(":");
-                    alg->header.returnType = typeFromSignature(algSig[0]);
-                    if (algSig.size()>1) {
-                        QStringList argSignatures = algSig[1].split(",");
-                        for (int argNo=0; argNo<argSignatures.size(); argNo++) {
-                            if (argSignatures[argNo].length()==0)
-                                break;
-                            AST::Variable * var = new AST::Variable;
-                            QStringList sigPair = argSignatures[argNo].split(" ");
-                            if (sigPair[0]=="in")
-                                var->accessType = AST::AccessArgumentIn;
-                            else if (sigPair[0]=="out")
-                                var->accessType = AST::AccessArgumentOut;
-                            else if (sigPair[0]=="inout")
-                                var->accessType = AST::AccessArgumentInOut;
-                            var->baseType = typeFromSignature(sigPair[1]);
-                            var->dimension = sigPair[1].count("[]");
-                            alg->header.arguments.push_back(AST::VariablePtr(var));
-                        }
-                    }
-                    module->header.algorhitms.push_back(AST::AlgorithmPtr(alg));
-                }
-            }
-        }
-        result = AST::ModulePtr(module);
-        ast_->modules.push_back(result);
-    }
+
+    // Algorithm headers are shared between all modules made from the same
+    // version of .kod file, while module itself is per-AST as it holds
+    // usedBy references
+    QList<AST::AlgorithmPtr> algorithms;
+    {
+        QMutexLocker lock(&KodModuleHeadersMutex);
+        const KodModuleHeaders & cached = KodModuleHeadersCache[kodFilePath];
+        if (cached.data == programData && cached.canonicalName == canonicalName) {
+            algorithms = cached.algorithms;
+        }
+    }
+    if (algorithms.isEmpty()) {
+        algorithms = kodModuleAlgorithms(canonicalName, *programData);
+        KodModuleHeaders headers;
+        headers.data = programData;
+        headers.canonicalName = canonicalName;
+        headers.algorithms = algorithms;
+        QMutexLocker lock(&KodModuleHeadersMutex);
+        KodModuleHeadersCache[kodFilePath] = headers;
+    }
+
+    AST::Module * module = new AST::Module;
+    module->header.type = AST::ModTypeCached;
+    module->header.name = canonicalName;
+    module->header.algorhitms = algorithms;
+    AST::ModulePtr result = AST::ModulePtr(module);
+    ast_->modules.push_back(result);
     return result;
 }
 
@@ -4876,6 +4848,26 @@ inline bool hasBoolOpBefore(const QList<SubexpressionElement> & alist, int no)
     return false;
 }
 
+AST::ExpressionPtr SyntaxAnalizer::parseCondition(
+    const QList<LexemPtr> & lexems
+    , const AST::ModulePtr mod
+    , const AST::AlgorithmPtr alg
+    , QString & error
+    ) const
+{
+    AST::ExpressionPtr result = parseExpression(lexems, mod, alg);
+    for (int i=0; i<lexems.size() && error.isEmpty(); i++) {
+        error = lexems[i]->error;
+    }
+    if (error.isEmpty() && (!result || result->baseType.kind!=AST::TypeBoolean)) {
+        error = _("Condition is not boolean");
+    }
+    if (!error.isEmpty()) {
+        result.clear();
+    }
+    return result;
+}
+
 AST::ExpressionPtr  SyntaxAnalizer::parseExpression(
     QList<LexemPtr> lexems
     , const AST::ModulePtr mod
@@ -54,6 +54,10 @@ public:
             const AST::AlgorithmPtr contextAlgorithm
             ) const;
     void processAnalisys();
+    AST::ExpressionPtr parseCondition(const QList<LexemPtr> & lexems,
+                                      const AST::ModulePtr mod,
+                                      const AST::AlgorithmPtr alg,
+                                      QString & error) const;
     QString suggestFileName() const;
     ~SyntaxAnalizer();
 
@@ -0,0 +1,424 @@
+#include "kumirbenchmarktoolplugin.h"
+#include <kumir2-libs/extensionsystem/pluginmanager.h>
+
+#include <QtCore>
+#include <iostream>
+#include <algorithm>
+
+#if defined(Q_OS_UNIX)
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+using namespace KumirBenchmarkTool;
+
+KumirBenchmarkToolPlugin::KumirBenchmarkToolPlugin()
+    : KPlugin()
+    , analizer_(nullptr)
+    , generator_(nullptr)
+    , runner_(nullptr)
+    , warmup_(1)
+    , repetitions_(5)
+{
+}
+
+QList<ExtensionSystem::CommandLineParameter>
+KumirBenchmarkToolPlugin::acceptableCommandLineParameters() const
+{
+    using ExtensionSystem::CommandLineParameter;
+    QList<CommandLineParameter> result;
+    result << CommandLineParameter(
+                  false,
+                  'w', "warmup",
+                  tr("Number of warm-up runs of each program, not included in report (default 1)"),
+                  QVariant::Int, false
+                  );
+    result << CommandLineParameter(
+                  false,
+                  'n', "repeat",
+                  tr("Number of measured runs of each program (default 5)"),
+                  QVariant::Int, false
+                  );
+    result << CommandLineParameter(
+                  false,
+                  'o', "out",
+                  tr("Write JSON report to file instead of standard output"),
+                  QVariant::String, false
+                  );
+
+    // Startup parameters
+
+    result << CommandLineParameter(
+                  false,
+                  tr("PROGRAM.kum"),
+                  tr("Benchmark source file name or directory containing .kum files"),
+                  QVariant::String,
+                  true
+                  );
+    result << CommandLineParameter(
+                  false,
+                  tr("PROGRAM_%1.kum"),
+                  tr("More benchmark source files or directories"),
+                  QVariant::String,
+                  false
+                  );
+    return result;
+}
+
+QString KumirBenchmarkToolPlugin::initialize(
+        const QStringList & /*configurationArguments*/,
+        const ExtensionSystem::CommandLine & runtimeArguments
+        )
+{
+    using namespace Shared;
+    using namespace ExtensionSystem;
+    PluginManager * manager = PluginManager::instance();
+    analizer_ = manager->findPlugin<AnalizerInterface>();
+    generator_ = manager->findPlugin<GeneratorInterface>();
+    runner_ = manager->findPlugin<RunInterface>();
+
+    // Option values given as separate words ('-o report.json') are
+    // not benchmark programs
+    QMap<QString,QString> optionsWithValue;
+    optionsWithValue["-w"] = optionsWithValue["--warmup"] = "-w";
+    optionsWithValue["-n"] = optionsWithValue["--repeat"] = "-n";
+    optionsWithValue["-o"] = optionsWithValue["--out"] = "-o";
+    QMap<QString,QString> separateValues;
+    for (int i=1; i<qApp->arguments().size(); i++) {
+        const QString arg = qApp->arguments()[i];
+        if (optionsWithValue.contains(arg)) {
+            if (i+1 < qApp->arguments().size()) {
+                separateValues[optionsWithValue[arg]] = qApp->arguments()[i+1];
+            }
+            i++;
+            continue;
+        }
+        if (arg.startsWith("-") || arg.startsWith("[")) {
+            continue;
+        }
+        const QFileInfo fileInfo(arg);
+        if (fileInfo.isDir()) {
+            const QDir dir(fileInfo.absoluteFilePath());
+            const QStringList entries = dir.entryList(QStringList() << "*.kum", QDir::Files, QDir::Name);
+            foreach (const QString & entry, entries) {
+                sourceFileNames_ << dir.absoluteFilePath(entry);
+            }
+        }
+        else if (arg.endsWith(".kum")) {
+            sourceFileNames_ << fileInfo.absoluteFilePath();
+        }
+    }
+
+    if (sourceFileNames_.isEmpty()) {
+        return tr("Error: no benchmark programs specified.\nRun with --help parameter for more details");
+    }
+
+    if (runtimeArguments.value('w').isValid()) {
+        warmup_ = qMax(0, runtimeArguments.value('w').toInt());
+    }
+    else if (separateValues.contains("-w")) {
+        warmup_ = qMax(0, separateValues["-w"].toInt());
+    }
+    if (runtimeArguments.value('n').isValid()) {
+        repetitions_ = qMax(1, runtimeArguments.value('n').toInt());
+    }
+    else if (separateValues.contains("-n")) {
+        repetitions_ = qMax(1, separateValues["-n"].toInt());
+    }
+    outFileName_ = runtimeArguments.value('o').toString();
+    if (outFileName_.isEmpty()) {
+        outFileName_ = separateValues.value("-o");
+    }
+
+    return QString();
+}
+
+bool KumirBenchmarkToolPlugin::runOnce(const QString &fileName, const QByteArray &source, Result &result, bool record)
+{
+    QElapsedTimer wall;
+    QElapsedTimer timer;
+    qint64 nsecs[PhasesCount];
+    wall.start();
+
+    // Analyse
+    timer.start();
+    Shared::Analizer::SourceFileInterface::Data kumFile =
+            analizer_->sourceFileHandler()->fromBytes(source);
+    kumFile.sourceUrl = QUrl::fromLocalFile(fileName);
+    Shared::Analizer::InstanceInterface * analizer = analizer_->createInstance();
+    analizer->setSourceDirName(QFileInfo(fileName).absoluteDir().absolutePath());
+    analizer->setSourceText(kumFile.visibleText + "\n" + kumFile.hiddenText);
+    const QList<Shared::Analizer::Error> errors = analizer->errors();
+    AST::DataPtr ast = analizer->compiler()->abstractSyntaxTree();
+    nsecs[Analyse] = timer.nsecsElapsed();
+    if (!errors.isEmpty()) {
+        const Shared::Analizer::Error & e = errors.first();
+        result.error = QString("%1:%2: %3").arg(QFileInfo(fileName).fileName()).arg(e.line+1).arg(e.message);
+        delete analizer;
+        return false;
+    }
+
+    // Generate
+    timer.restart();
+    QString suffix;
+    QString mimeType;
+    QByteArray outData;
+    generator_->generateExecutable(ast, outData, mimeType, suffix);
+    nsecs[Generate] = timer.nsecsElapsed();
+
+    // Load
+    timer.restart();
+    Shared::RunInterface::RunnableProgram program;
+    program.sourceFileName = fileName;
+    program.executableData = outData;
+    program.abstractSyntaxTree = ast;
+    const bool loaded = runner_->loadProgram(program);
+    nsecs[Load] = timer.nsecsElapsed();
+    delete analizer;
+    if (!loaded) {
+        result.error = tr("Can't load generated program");
+        return false;
+    }
+
+    // Execute; program output is collected to memory to keep report clean
+    QString input;
+    QString output;
+    QTextStream inputStream(&input);
+    QTextStream outputStream(&output);
+    runner_->setStdInTextStream(&inputStream);
+    runner_->setStdOutTextStream(&outputStream);
+    timer.restart();
+    runner_->runProgramInCurrentThread(false);
+    nsecs[Execute] = timer.nsecsElapsed();
+    nsecs[Wall] = wall.nsecsElapsed();
+    runner_->setStdInTextStream(0);
+    runner_->setStdOutTextStream(0);
+
+    if (runner_->error().length() > 0) {
+        result.error = runner_->error();
+        return false;
+    }
+
+    if (record) {
+        const quint64 steps = runner_->stepsCounted();
+        if (result.nsecs[Execute].isEmpty()) {
+            result.steps = steps;
+        }
+        else if (result.steps != steps) {
+            result.stepsConsistent = false;
+        }
+        for (int i=0; i<PhasesCount; i++) {
+            result.nsecs[i].push_back(nsecs[i]);
+        }
+    }
+    return true;
+}
+
+KumirBenchmarkToolPlugin::Result KumirBenchmarkToolPlugin::runBenchmark(const QString &fileName)
+{
+    Result result;
+    result.name = QFileInfo(fileName).completeBaseName();
+    result.fileName = fileName;
+    result.steps = 0u;
+    result.stepsConsistent = true;
+    result.peakRssKb = -1;
+    result.hasRssGrowth = false;
+    result.rssGrowthKb = 0;
+
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly)) {
+        result.error = tr("Can't open file %1").arg(QDir::toNativeSeparators(fileName));
+        return result;
+    }
+    const QByteArray source = f.readAll();
+    f.close();
+
+    // Programs might use relative file names
+    const QString previousDir = QDir::currentPath();
+    QDir::setCurrent(QFileInfo(fileName).absoluteDir().absolutePath());
+    const long rssBefore = currentRssKb();
+    bool ok = true;
+    for (int i=0; ok && i<warmup_; i++) {
+        ok = runOnce(fileName, source, result, false);
+    }
+    for (int i=0; ok && i<repetitions_; i++) {
+        ok = runOnce(fileName, source, result, true);
+    }
+    QDir::setCurrent(previousDir);
+    const long rssAfter = currentRssKb();
+    if (rssBefore >= 0 && rssAfter >= 0) {
+        result.hasRssGrowth = true;
+        result.rssGrowthKb = rssAfter - rssBefore;
+    }
+    result.peakRssKb = peakRssKb();
+    return result;
+}
+
+long KumirBenchmarkToolPlugin::peakRssKb()
+{
+#if defined(Q_OS_UNIX)
+    struct rusage usage;
+    if (0 == getrusage(RUSAGE_SELF, &usage)) {
+#if defined(Q_OS_MAC)
+        return usage.ru_maxrss / 1024; // bytes on Mac OS X
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return -1;
+}
+
+long KumirBenchmarkToolPlugin::currentRssKb()
+{
+#if defined(Q_OS_LINUX)
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        statm.close();
+        bool ok = false;
+        const long residentPages = fields.size() > 1 ? fields[1].toLong(&ok) : 0;
+        if (ok) {
+            return residentPages * (sysconf(_SC_PAGESIZE) / 1024);
+        }
+    }
+#endif
+    return -1;
+}
+
+static QString jsonString(const QString & s)
+{
+    QString result = "\"";
+    for (int i=0; i<s.length(); i++) {
+        const QChar ch = s[i];
+        if (ch == '"' || ch == '\\') {
+            result += '\\';
+            result += ch;
+        }
+        else if (ch == '\n') {
+            result += "\\n";
+        }
+        else if (ch.unicode() < 0x20) {
+            result += QString("\\u%1").arg(ch.unicode(), 4, 16, QChar('0'));
+        }
+        else {
+            result += ch;
+        }
+    }
+    result += '"';
+    return result;
+}
+
+static QString jsonTimings(QVector<qint64> values)
+{
+    if (values.isEmpty()) {
+        return "null";
+    }
+    std::sort(values.begin(), values.end());
+    qint64 sum = 0;
+    foreach (qint64 value, values) {
+        sum += value;
+    }
+    const double ms = 1.0e-6;
+    const double median = values.size() % 2
+            ? values[values.size()/2]
+            : 0.5 * (values[values.size()/2 - 1] + values[values.size()/2]);
+    return QString("{\"min_ms\": %1, \"median_ms\": %2, \"mean_ms\": %3, \"max_ms\": %4}")
+            .arg(ms * values.first(), 0, 'f', 3)
+            .arg(ms * median, 0, 'f', 3)
+            .arg(ms * sum / values.size(), 0, 'f', 3)
+            .arg(ms * values.last(), 0, 'f', 3);
+}
+
+QString KumirBenchmarkToolPlugin::toJson(const QList<Result> &results, int warmup, int repetitions)
+{
+    static const char * PhaseNames[PhasesCount] = {
+        "analyse", "generate", "load", "execute", "wall"
+    };
+    QStringList items;
+    foreach (const Result & r, results) {
+        QStringList fields;
+        fields << "\"name\": " + jsonString(r.name);
+        fields << "\"file\": " + jsonString(QDir::toNativeSeparators(r.fileName));
+        fields << "\"status\": " + jsonString(r.error.isEmpty() ? "ok" : "error");
+        if (!r.error.isEmpty()) {
+            fields << "\"error\": " + jsonString(r.error);
+        }
+        fields << "\"runs\": " + QString::number(r.nsecs[Execute].size());
+        fields << "\"steps\": " + QString::number(r.steps);
+        fields << "\"steps_consistent\": " + QString(r.stepsConsistent ? "true" : "false");
+        if (r.nsecs[Execute].isEmpty()) {
+            fields << "\"steps_per_sec\": null";
+        }
+        else {
+            QVector<qint64> executeTimes = r.nsecs[Execute];
+            std::sort(executeTimes.begin(), executeTimes.end());
+            const qint64 best = qMax(Q_INT64_C(1), executeTimes.first());
+            fields << "\"steps_per_sec\": " + QString::number(1.0e9 * r.steps / best, 'f', 0);
+        }
+        fields << "\"process_peak_rss_kb\": " + (r.peakRssKb < 0 ? QString("null") : QString::number(r.peakRssKb));
+        fields << "\"rss_growth_kb\": " + (!r.hasRssGrowth ? QString("null") : QString::number(r.rssGrowthKb));
+        QStringList phases;
+        for (int i=0; i<PhasesCount; i++) {
+            phases << "\"" + QString::fromLatin1(PhaseNames[i]) + "\": " + jsonTimings(r.nsecs[i]);
+        }
+        fields << "\"phases\": {\n      " + phases.join(",\n      ") + "\n    }";
+        items << "  {\n    " + fields.join(",\n    ") + "\n  }";
+    }
+    return QString("{\n\"warmup\": %1,\n\"repetitions\": %2,\n\"benchmarks\": [\n%3\n]\n}\n")
+            .arg(warmup).arg(repetitions).arg(items.join(",\n"));
+}
+
+void KumirBenchmarkToolPlugin::start()
+{
+    QList<Result> results;
+    bool allPassed = true;
+    foreach (const QString & fileName, sourceFileNames_) {
+        std::cerr << QFileInfo(fileName).fileName().toLocal8Bit().data() << "..." << std::flush;
+        const Result result = runBenchmark(fileName);
+        if (result.error.isEmpty()) {
+            std::cerr << " ok" << std::endl;
+        }
+        else {
+            std::cerr << " " << result.error.toLocal8Bit().data() << std::endl;
+            allPassed = false;
+        }
+        results << result;
+    }
+
+    const QByteArray report = toJson(results, warmup_, repetitions_).toUtf8();
+    if (outFileName_.isEmpty()) {
+        std::cout << report.constData() << std::flush;
+    }
+    else {
+        QFile out(outFileName_);
+        if (!out.open(QIODevice::WriteOnly|QIODevice::Truncate)) {
+            const QString errorMessage = tr("Can't write file %1").arg(QDir::toNativeSeparators(outFileName_));
+            std::cerr << errorMessage.toLocal8Bit().data() << std::endl;
+            qApp->setProperty("returnCode", 2);
+            return;
+        }
+        out.write(report);
+        out.close();
+    }
+    qApp->setProperty("returnCode", allPassed ? 0 : 1);
+}
+
+void KumirBenchmarkToolPlugin::stop()
+{
+
+}
+
+void KumirBenchmarkToolPlugin::createPluginSpec()
+{
+    _pluginSpec.name = "KumirBenchmarkTool";
+    _pluginSpec.gui = false;
+    _pluginSpec.dependencies.append("Analizer");
+    _pluginSpec.dependencies.append("Generator");
+    _pluginSpec.dependencies.append("Runner");
+}
+
+#if QT_VERSION < 0x050000
+Q_EXPORT_PLUGIN(KumirBenchmarkToolPlugin)
+#endif
@@ -0,0 +1,75 @@
+#ifndef KUMIRBENCHMARKTOOLPLUGIN_H
+#define KUMIRBENCHMARKTOOLPLUGIN_H
+
+#include <kumir2-libs/extensionsystem/kplugin.h>
+#include <kumir2/analizerinterface.h>
+#include <kumir2/generatorinterface.h>
+#include <kumir2/runinterface.h>
+#include <kumir2-libs/extensionsystem/pluginspec.h>
+
+namespace KumirBenchmarkTool {
+
+/* Runs each program of benchmark corpus through the whole pipeline
+ * (analyse -> generate -> load -> execute) several times and writes
+ * per-phase timings, VM steps rate and memory usage as JSON.
+ * Has no GUI dependencies, so might be used in CI.
+ *
+ * All benchmarks run in the same process, so "process_peak_rss_kb" is
+ * the peak of the whole process so far (it never decreases), while
+ * "rss_growth_kb" is the change of current resident size over one
+ * benchmark (Linux only). "steps" is the VM steps count of the first
+ * measured run; "steps_consistent" tells whether all runs agreed.
+ */
+class KumirBenchmarkToolPlugin
+  : public ExtensionSystem::KPlugin
+{
+    Q_OBJECT
+#if QT_VERSION >= 0x050000
+    Q_PLUGIN_METADATA(IID "kumir2.KumirBenchmarkTool")
+#endif
+public:
+    KumirBenchmarkToolPlugin();
+
+    QString initialize(
+            const QStringList & configurationArguments,
+            const ExtensionSystem::CommandLine & runtimeArguments
+            );
+    QList<ExtensionSystem::CommandLineParameter> acceptableCommandLineParameters() const;
+    void start();
+    void stop();
+    inline void updateSettings(const QStringList &) {}
+protected:
+    void createPluginSpec();
+private:
+    enum Phase { Analyse = 0, Generate, Load, Execute, Wall, PhasesCount };
+
+    struct Result {
+        QString name;
+        QString fileName;
+        QString error;
+        QVector<qint64> nsecs[PhasesCount];
+        quint64 steps;
+        bool stepsConsistent;
+        long peakRssKb;
+        bool hasRssGrowth;
+        long rssGrowthKb;
+    };
+
+    bool runOnce(const QString & fileName, const QByteArray & source, Result & result, bool record);
+    Result runBenchmark(const QString & fileName);
+    static QString toJson(const QList<Result> & results, int warmup, int repetitions);
+    static long peakRssKb();
+    static long currentRssKb();
+
+    Shared::AnalizerInterface * analizer_;
+    Shared::GeneratorInterface * generator_;
+    Shared::RunInterface * runner_;
+    QStringList sourceFileNames_;
+    QString outFileName_;
+    int warmup_;
+    int repetitions_;
+};
+
+}
+
+#endif // KUMIRBENCHMARKTOOLPLUGIN_H
@@ -472,6 +472,25 @@ Bytecode::InstructionType Generator::operation(AST::ExpressionOperator op)
         return Bytecode::NOP;
 }
 
+void Generator::addBreakpointCondition(int modId, int algId, const AST::ExpressionPtr condition, QString &error)
+{
+    Bytecode::TableElem func;
+    func.type = Bytecode::EL_FUNCTION;
+    func.module = quint8(modId);
+    func.algId = func.id = quint16(algId);
+    const QList<Bytecode::Instruction> instrs = calculate(modId, algId, 0, condition);
+    for (int i=0; i<instrs.size(); i++) {
+        // Condition is evaluated within context of breakpoint line,
+        // so calls of algorithms which need their own context are not allowed
+        if (instrs[i].type==Bytecode::CALL && instrs[i].module < 0xF0) {
+            error = tr("Breakpoint condition can not call algorithms");
+            return;
+        }
+    }
+    func.instructions = std::vector<Bytecode::Instruction>(instrs.begin(), instrs.end());
+    byteCode_->d.push_back(func);
+}
+
 void Generator::addModule(const AST::ModulePtr mod)
 {
     int id = ast_->modules.indexOf(mod);
@@ -1176,6 +1195,30 @@ void Generator::ASSIGN(int modId, int algId, int level, const AST::StatementPtr
     result += makeLineInstructions(st->lexems);
 
     const AST::ExpressionPtr rvalue = st->expressions[0];
+
+    QList<AST::ExpressionPtr> appended;
+    if (st->expressions.size()>1 && isStringSelfAppend(st->expressions[1], rvalue, appended)) {
+        // x := x + a + b is evaluated as in-place appends of a and b,
+        // so building a string in loop does not copy it each time
+        Bytecode::Instruction append;
+        append.type = Bytecode::STRAPP;
+        findVariable(modId, algId, st->expressions[1]->variable, append.scope, append.arg);
+        Bytecode::Instruction check = append;
+        check.scope = Bytecode::VariableScope(append.scope | Bytecode::APPEND_CHECK);
+        result << check;
+        for (int i=0; i<appended.size(); i++) {
+            QList<Bytecode::Instruction> operandInstructions = calculate(modId, algId, level, appended[i]);
+            shiftInstructions(operandInstructions, result.size());
+            result << operandInstructions;
+            if (i == appended.size()-1) {
+                // Debugger is noticed about new value once per statement
+                append.scope = Bytecode::VariableScope(append.scope | Bytecode::APPEND_NOTICE);
+            }
+            result << append;
+        }
+        return;
+    }
+
     QList<Bytecode::Instruction> rvalueInstructions = calculate(modId, algId, level, rvalue);
     shiftInstructions(rvalueInstructions, result.size());
     result << rvalueInstructions;
@@ -1252,6 +1295,63 @@ void Generator::ASSIGN(int modId, int algId, int level, const AST::StatementPtr
     }
 }
 
+bool Generator::isStringSelfAppend(const AST::ExpressionPtr lvalue, const AST::ExpressionPtr rvalue, QList<AST::ExpressionPtr> &appended)
+{
+    if (lvalue->kind!=AST::ExprVariable || !lvalue->variable ||
+            lvalue->variable->dimension>0 ||
+            lvalue->variable->baseType.kind!=AST::TypeString)
+        return false;
+    AST::ExpressionPtr current = rvalue;
+    while (current->kind==AST::ExprSubexpression &&
+           current->operatorr==AST::OpSumm &&
+           current->operands.size()==2 &&
+           !current->keepInCache && !current->useFromCache)
+    {
+        appended.prepend(current->operands[1]);
+        current = current->operands[0];
+    }
+    if (appended.isEmpty() ||
+            current->kind!=AST::ExprVariable ||
+            current->variable!=lvalue->variable ||
+            current->keepInCache || current->useFromCache)
+    {
+        appended.clear();
+        return false;
+    }
+    for (int i=0; i<appended.size(); i++) {
+        // Operands after the first one are evaluated when the variable
+        // is already changed, so they must not read it
+        if (mayAccessVariable(appended[i], lvalue->variable, i>0)) {
+            appended.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Generator::mayAccessVariable(const AST::ExpressionPtr st, const AST::VariablePtr var, bool reading)
+{
+    if (reading && st->variable==var)
+        return true;
+    if (st->kind==AST::ExprFunctionCall) {
+        const AST::AlgorithmPtr alg = st->function;
+        // Kumir algorithm might change global variable
+        if (!alg || alg->header.implType!=AST::AlgorhitmExternal)
+            return true;
+        for (int i=0; i<st->operands.size() && i<alg->header.arguments.size(); i++) {
+            AST::VariableAccessType t = alg->header.arguments[i]->accessType;
+            if ((t==AST::AccessArgumentOut || t==AST::AccessArgumentInOut) &&
+                    st->operands[i]->variable==var)
+                return true;
+        }
+    }
+    for (int i=0; i<st->operands.size(); i++) {
+        if (mayAccessVariable(st->operands[i], var, reading))
+            return true;
+    }
+    return false;
+}
+
 QList<Bytecode::Instruction> Generator::calculate(int modId, int algId, int level, const AST::ExpressionPtr st)
 {
     QList<Bytecode::Instruction> result;
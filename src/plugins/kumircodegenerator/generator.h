@@ -54,6 +54,7 @@ public:
     explicit Generator(QObject *parent = 0);
     void reset(const AST::DataPtr ast, Bytecode::Data * bc);
     void addModule(const AST::ModulePtr  mod);
+    void addBreakpointCondition(int modId, int algId, const AST::ExpressionPtr condition, QString & error);
     void generateConstantTable();
     void generateExternTable();
     void setDebugLevel(DebugLevel debugLevel);
@@ -88,6 +89,8 @@ private:
     void BREAK(int modId, int algId, int level, const AST::StatementPtr  st, QList<Bytecode::Instruction> & result);
 
     QList<Bytecode::Instruction> calculate(int modId, int algId, int level, const AST::ExpressionPtr st);
+    static bool isStringSelfAppend(const AST::ExpressionPtr lvalue, const AST::ExpressionPtr rvalue, QList<AST::ExpressionPtr> & appended);
+    static bool mayAccessVariable(const AST::ExpressionPtr st, const AST::VariablePtr var, bool reading);
 
     void findVariable(int modId, int algId, const AST::VariablePtr  var, Bytecode::VariableScope & scope, quint16 & id) const;
     static const AST::VariablePtr  returnValue(const AST::AlgorithmPtr  alg);
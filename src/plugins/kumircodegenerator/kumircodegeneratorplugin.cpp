@@ -96,41 +96,20 @@ void KumirCodeGeneratorPlugin::generateExecutable(
 
     d->reset(tree, &data);
     AST::ModulePtr userModule, teacherModule;
-    AST::ModulePtr linkedModule = AST::ModulePtr(new AST::Module);
     for (int i=0; i<modules.size(); i++) {
         AST::ModulePtr mod = modules[i];
-        if (mod->header.type == AST::ModTypeUserMain) {
-            userModule = mod;
-        }
-        else if (mod->header.type == AST::ModTypeTeacherMain) {
-            teacherModule = mod;
+        if (mod->header.type != AST::ModTypeUserMain &&
+                mod->header.type != AST::ModTypeTeacherMain)
+        {
+            d->addModule(mod);
         }
-        else {
-            d->addModule(tree->modules[i]);
-        }
-    }    
-    linkedModule->impl.globals = userModule->impl.globals;
-    linkedModule->impl.initializerBody = userModule->impl.initializerBody;
-    linkedModule->impl.algorhitms = userModule->impl.algorhitms;
-    linkedModule->header.algorhitms = userModule->header.algorhitms;
-    modules.removeAll(userModule);
-    if (teacherModule) {
-        linkedModule->impl.globals += teacherModule->impl.globals;
-        linkedModule->impl.initializerBody += teacherModule->impl.initializerBody;
-        linkedModule->impl.algorhitms += teacherModule->impl.algorhitms;
-        linkedModule->header.algorhitms += teacherModule->header.algorhitms;
-        modules.removeAll(teacherModule);
     }
-    modules.push_back(linkedModule);
+    AST::ModulePtr linkedModule = linkMainModules(modules, userModule, teacherModule);
     d->addModule(linkedModule);
     d->generateConstantTable();
     d->generateExternTable();
     qDebug("some example message");
-    modules.pop_back();
-    modules.push_back(userModule);
-    if (teacherModule) {
-        modules.push_back(teacherModule);
-    }
+    unlinkMainModules(modules, userModule, teacherModule);
 
     data.versionMaj = 2;
     data.versionMin = 0;
@@ -156,6 +135,104 @@ void KumirCodeGeneratorPlugin::generateExecutable(
     }
 }
 
+void KumirCodeGeneratorPlugin::generateBreakpointCondition(
+        const AST::DataPtr tree,
+        const AST::ModulePtr module,
+        const AST::AlgorithmPtr algorithm,
+        const AST::ExpressionPtr condition,
+        QByteArray & out,
+        QString & error
+        )
+{
+    Data data;
+
+    QList<AST::ModulePtr> & modules = tree->modules;
+
+    d->reset(tree, &data);
+    // Ids must be the same as generateExecutable gives: other modules are
+    // numbered before main modules linked
+    int moduleId = modules.indexOf(module);
+    AST::ModulePtr userModule, teacherModule;
+    AST::ModulePtr linkedModule = linkMainModules(modules, userModule, teacherModule);
+    AST::ModulePtr conditionModule = module;
+    if (module == userModule || module == teacherModule) {
+        conditionModule = linkedModule;
+        moduleId = modules.indexOf(linkedModule);
+    }
+    const int algorithmId = conditionModule
+            ? conditionModule->impl.algorhitms.indexOf(algorithm) : -1;
+    if (moduleId < 0 || algorithmId < 0) {
+        error = tr("Breakpoint condition is outside of program algorithms");
+    }
+    else {
+        d->addBreakpointCondition(moduleId, algorithmId, condition, error);
+        d->generateConstantTable();
+    }
+    unlinkMainModules(modules, userModule, teacherModule);
+    if (error.length() > 0) {
+        return;
+    }
+
+    data.versionMaj = 2;
+    data.versionMin = 0;
+    data.versionRel = 90;
+    std::list<char> buffer;
+    Bytecode::bytecodeToDataStream(buffer, data);
+    out.clear();
+    for (std::list<char>::const_iterator it=buffer.begin(); it!=buffer.end(); ++it) {
+        out.push_back(*it);
+    }
+}
+
+/** Replaces user and teacher main modules by one module containing
+ *  algorithms of both, as they are executed together. Returns linked
+ *  module, which is the last one in list */
+AST::ModulePtr KumirCodeGeneratorPlugin::linkMainModules(
+        QList<AST::ModulePtr> & modules,
+        AST::ModulePtr & userModule,
+        AST::ModulePtr & teacherModule
+        )
+{
+    for (int i=0; i<modules.size(); i++) {
+        AST::ModulePtr mod = modules[i];
+        if (mod->header.type == AST::ModTypeUserMain) {
+            userModule = mod;
+        }
+        else if (mod->header.type == AST::ModTypeTeacherMain) {
+            teacherModule = mod;
+        }
+    }
+    AST::ModulePtr linkedModule = AST::ModulePtr(new AST::Module);
+    linkedModule->impl.globals = userModule->impl.globals;
+    linkedModule->impl.initializerBody = userModule->impl.initializerBody;
+    linkedModule->impl.algorhitms = userModule->impl.algorhitms;
+    linkedModule->header.algorhitms = userModule->header.algorhitms;
+    modules.removeAll(userModule);
+    if (teacherModule) {
+        linkedModule->impl.globals += teacherModule->impl.globals;
+        linkedModule->impl.initializerBody += teacherModule->impl.initializerBody;
+        linkedModule->impl.algorhitms += teacherModule->impl.algorhitms;
+        linkedModule->header.algorhitms += teacherModule->header.algorhitms;
+        modules.removeAll(teacherModule);
+    }
+    modules.push_back(linkedModule);
+    return linkedModule;
+}
+
+/** Restores modules list changed by linkMainModules */
+void KumirCodeGeneratorPlugin::unlinkMainModules(
+        QList<AST::ModulePtr> & modules,
+        const AST::ModulePtr & userModule,
+        const AST::ModulePtr & teacherModule
+        )
+{
+    modules.pop_back();
+    modules.push_back(userModule);
+    if (teacherModule) {
+        modules.push_back(teacherModule);
+    }
+}
+
 
 #if QT_VERSION < 0x050000
 Q_EXPORT_PLUGIN(KumirCodeGeneratorPlugin)
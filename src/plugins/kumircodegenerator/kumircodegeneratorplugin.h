@@ -34,6 +34,15 @@ public:
                 QString & fileSuffix
                 );
 
+    void generateBreakpointCondition(
+                const AST::DataPtr tree,
+                const AST::ModulePtr module,
+                const AST::AlgorithmPtr algorithm,
+                const AST::ExpressionPtr condition,
+                QByteArray & out,
+                QString & error
+                );
+
     void setOutputToText(bool flag);
     inline void setVerbose(bool) {}
     inline void setTemporaryDir(const QString &, bool ) {}
@@ -46,6 +55,13 @@ protected:
     void start();
     void stop();
 private:
+    static AST::ModulePtr linkMainModules(QList<AST::ModulePtr> & modules,
+                                          AST::ModulePtr & userModule,
+                                          AST::ModulePtr & teacherModule);
+    static void unlinkMainModules(QList<AST::ModulePtr> & modules,
+                                  const AST::ModulePtr & userModule,
+                                  const AST::ModulePtr & teacherModule);
+
     class Generator * d;
     bool textMode_;
 
@@ -126,6 +126,15 @@ AnyValue ExternalModuleCallFunctor::operator ()
     return result;
 }
 
+IntrinsicFunction ExternalModuleCallFunctor::intrinsic(
+        const std::string & asciiModuleName,
+        const uint16_t algKey
+        )
+{
+    Shared::ActorInterface * actor = Util::findActor(asciiModuleName);
+    return actor ? actor->intrinsicFunction(quint32(algKey)) : 0;
+}
+
 void ExternalModuleCallFunctor::checkForActorConnected(const std::string &asciiModuleName)
 {
     using namespace Shared;
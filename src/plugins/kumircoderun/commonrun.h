@@ -48,6 +48,10 @@ public:
             VariableReferencesList alist, Kumir::String * error
             )  _override;
     ~ExternalModuleCallFunctor();
+    IntrinsicFunction intrinsic(
+            const std::string & asciiModuleName,
+            const uint16_t algKey
+            ) _override;
     void checkForActorConnected(const std::string & asciiModuleName);
     void terminate();
 
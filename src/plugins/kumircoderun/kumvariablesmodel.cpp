@@ -15,6 +15,7 @@ extern "C" {
 namespace KumirCodeRun {
 
 static const int MAXIMUM_SHOWN_TABLE_ITEMS_COUNT = 255;
+static const int ARRAY_ROWS_FETCH_COUNT = 256;
 
 KumVariablesModel::KumVariablesModel(
         std::shared_ptr<VM::KumirVM> vm,
@@ -24,6 +25,7 @@ KumVariablesModel::KumVariablesModel(
         : QAbstractItemModel(parent)
         , _vm(vm)
         , mutex_(mutex)
+        , noticedGeneration_(0u)
 {
 }
 
@@ -31,7 +33,15 @@ void KumVariablesModel::clear()
 {
     beginResetModel();
     parents_.clear();
+    qDeleteAll(cache_);
     cache_.clear();
+    tableItems_.clear();
+    variableItems_.clear();
+    arrayItems_.clear();
+    modelIndeces_.clear();
+    changedItems_.clear();
+    initializingArrayIndex_ = QModelIndex();
+    noticedGeneration_ = _vm->writeGeneration();
     endResetModel();
 }
 
@@ -72,8 +82,8 @@ QModelIndex KumVariablesModel::topLevelIndex(int row) const
     size_t globalsOffset = hasGlobals? 1u : 0u;
     KumVariableItem * result = nullptr;
     if (hasGlobals && row == 0) {
-        for (int i=0; i<cache_.size(); i++) {
-            KumVariableItem * item = cache_[i];
+        for (int i=0; i<tableItems_.size(); i++) {
+            KumVariableItem * item = tableItems_[i];
             if (item->itemType() == KumVariableItem::GlobalsTable) {
                 result = item;
                 break;
@@ -84,6 +94,7 @@ QModelIndex KumVariablesModel::topLevelIndex(int row) const
             result = new KumVariableItem(_vm->getMainModuleGlobals(), row);
             mutex_->unlock();
             cache_.push_back(result);
+            tableItems_.push_back(result);
         }
     }
     else {
@@ -124,8 +135,8 @@ QModelIndex KumVariablesModel::topLevelIndex(int row) const
             }
         }
         mutex_->unlock();
-        for (int i=0; i<cache_.size(); i++) {
-            KumVariableItem * item = cache_[i];
+        for (int i=0; i<tableItems_.size(); i++) {
+            KumVariableItem * item = tableItems_[i];
             if (KumVariableItem::LocalsTable==item->itemType() &&
                     item->framePointer()==framePointer &&
                     item->name()==algorithmName)
@@ -138,6 +149,7 @@ QModelIndex KumVariablesModel::topLevelIndex(int row) const
             result = new KumVariableItem(locals, row, algorithmName);
             result->setFramePointer(framePointer);
             cache_.push_back(result);
+            tableItems_.push_back(result);
         }
     }
     return createIndex(row, 0, result);
@@ -154,22 +166,13 @@ QModelIndex KumVariablesModel::valueIndex(int row, int column, TableOfVariables
     }
     mutex_->lock();
     const VM::Variable * var = & table->at(indexInTable);
-    mutex_->unlock();
-    KumVariableItem * result = nullptr;
-    for (int i=0; i<cache_.size(); i++) {
-        KumVariableItem * item = cache_[i];
-        if (item->itemType() == KumVariableItem::Variable &&
-                item->variable() == var)
-        {
-            result = item;
-            break;
-        }
-
-    }
+    KumVariableItem * result = variableItems_.value(var, nullptr);
     if (result == nullptr) {
         result = new KumVariableItem(var, row, table);
         cache_.push_back(result);
+        variableItems_.insert(var, result);
     }
+    mutex_->unlock();
     QModelIndex resultIndex;
     if (modelIndeces_.contains(result)) {
         resultIndex = modelIndeces_[result];
@@ -192,24 +195,16 @@ QModelIndex KumVariablesModel::arrayIndex(
     int bounds[7];
     mutex_->lock();
     variable->getEffectiveBounds(bounds);
-    mutex_->unlock();
     int newIndex = row + bounds[2 * prevIndeces.size()];
     newIndeces.last() = newIndex;
-    KumVariableItem * result = nullptr;
-    for (int i=0; i<cache_.size(); i++) {
-        KumVariableItem * item = cache_[i];
-        if (item->itemType() == KumVariableItem::ArrayItem &&
-                item->variable() == variable &&
-                item->arrayIndeces() == newIndeces)
-        {
-            result = item;
-            break;
-        }
-    }
+    const ArrayItemKey key(variable, newIndeces);
+    KumVariableItem * result = arrayItems_.value(key, nullptr);
     if (result == nullptr) {
         result = new KumVariableItem(variable, row, newIndeces);
         cache_.push_back(result);
+        arrayItems_.insert(key, result);
     }
+    mutex_->unlock();
     QModelIndex resultIndex;
     if (modelIndeces_.contains(result)) {
         resultIndex = modelIndeces_[result];
@@ -240,45 +235,23 @@ QModelIndex KumVariablesModel::parent(const QModelIndex &child) const
     }
     KumVariableItem * result = nullptr;
     if (item->itemType() == KumVariableItem::Variable) {
-        for (int i=0; i<cache_.size(); i++) {
-            KumVariableItem * it = cache_[i];
-            if (it->itemType() == KumVariableItem::GlobalsTable ||
-                    it->itemType() == KumVariableItem::LocalsTable)
-            {
-                if (it->table() == item->table()) {
-                    result = it;
-                    break;
-                }
+        for (int i=0; i<tableItems_.size(); i++) {
+            KumVariableItem * it = tableItems_[i];
+            if (it->table() == item->table()) {
+                result = it;
+                break;
             }
         }
     }
     else if (item->itemType() == KumVariableItem::ArrayItem) {
         QVector<int> indeces = item->arrayIndeces();
         indeces.pop_back();
-        if (indeces.isEmpty()) {
-            for (int i=0; i<cache_.size(); i++) {
-                KumVariableItem * it = cache_[i];
-                if (it->itemType() == KumVariableItem::Variable
-                        && it->variable() == item->variable())
-                {
-                    result = it;
-                    break;
-                }
-            }
-        }
-        else {
-            for (int i=0; i<cache_.size(); i++) {
-                KumVariableItem * it = cache_[i];
-                if (it->itemType() == KumVariableItem::ArrayItem
-                        && it->variable() == item->variable()
-                        && it->arrayIndeces() == indeces
-                        )
-                {
-                    result = it;
-                    break;
-                }
-            }
-        }
+        mutex_->lock();
+        result = findItem(item->variable(), indeces);
+        mutex_->unlock();
+    }
+    if (result == nullptr) {
+        return QModelIndex();
     }
     return createIndex(result->numberInTable(), 0, result);
 }
@@ -325,29 +298,60 @@ int KumVariablesModel::rowCount(const QModelIndex &parent) const
         return size;
     }
     else if (item->itemType() == KumVariableItem::Variable && item->hasValue()) {
-        quint8 dim = item->variable()->dimension();
-        if (dim > 0) {
-            mutex_->lock();
-            int bounds[7];
-            item->variable()->getEffectiveBounds(bounds);
-            mutex_->unlock();
-            return bounds[1] - bounds[0] + 1;
-        }
+        return qMin(arrayRowsCount(item), item->_fetchedRows);
     }
     else if (item->itemType() == KumVariableItem::ArrayItem) {
-        int dim = item->variable()->dimension();
-        int parentDim = item->arrayIndeces().size();
-        if (dim - parentDim > 0) {
-            mutex_->lock();
-            int bounds[7];
-            item->variable()->getEffectiveBounds(bounds);
-            mutex_->unlock();
-            return bounds[parentDim * 2 + 1] - bounds[parentDim * 2] + 1;
-        }
+        return qMin(arrayRowsCount(item), item->_fetchedRows);
     }
     return 0;
 }
 
+int KumVariablesModel::arrayRowsCount(const KumVariableItem *item) const
+{
+    // Full size of array dimension shown as children of item,
+    // while rowCount returns only fetched part of it
+    const int parentDim = item->itemType() == KumVariableItem::ArrayItem
+            ? item->arrayIndeces().size() : 0;
+    if (item->variable()->dimension() - parentDim <= 0) {
+        return 0;
+    }
+    int bounds[7];
+    mutex_->lock();
+    item->variable()->getEffectiveBounds(bounds);
+    mutex_->unlock();
+    return bounds[parentDim * 2 + 1] - bounds[parentDim * 2] + 1;
+}
+
+bool KumVariablesModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) {
+        return false;
+    }
+    KumVariableItem * item =
+            static_cast<KumVariableItem*>(parent.internalPointer());
+    if (item->itemType() == KumVariableItem::Variable && item->hasValue()) {
+        return item->_fetchedRows < arrayRowsCount(item);
+    }
+    else if (item->itemType() == KumVariableItem::ArrayItem) {
+        return item->_fetchedRows < arrayRowsCount(item);
+    }
+    return false;
+}
+
+void KumVariablesModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+    KumVariableItem * item =
+            static_cast<KumVariableItem*>(parent.internalPointer());
+    const int first = item->_fetchedRows;
+    const int last = qMin(arrayRowsCount(item), first + ARRAY_ROWS_FETCH_COUNT) - 1;
+    beginInsertRows(parent, first, last);
+    item->_fetchedRows = last + 1;
+    endInsertRows();
+}
+
 int KumVariablesModel::columnCount(const QModelIndex &parent) const
 {
     return 1;
@@ -393,14 +397,12 @@ QVariant KumVariablesModel::data(const QModelIndex &index, int role) const
         }
         else if (item->itemType() == KumVariableItem::Variable) {
             if (role == Qt::DisplayRole) {
-                QString text;
                 mutex_->lock();
-
-                text = item->variableTypeName() + " " +item->name();
-                if (item->hasValue() && item->variable()->dimension() == 0)
-                    text += " = " + item->valueRepresentation();
-                else if (item->hasValue() && item->variable()->dimension() > 0)
-                    text += " = " + item->arrayRepresentation();
+                if (!item->_textValid) {
+                    item->_text = item->displayText();
+                    item->_textValid = true;
+                }
+                const QString text = item->_text;
                 mutex_->unlock();
                 return text;
             }
@@ -417,17 +419,14 @@ QVariant KumVariablesModel::data(const QModelIndex &index, int role) const
         }
         else if (item->itemType() == KumVariableItem::ArrayItem) {
             if (role == Qt::DisplayRole) {
-                QString text;
                 mutex_->lock();
-                text = item->name();
-                if (item->hasValue() &&
-                        item->variable()->dimension() == item->arrayIndeces().size()
-                        )
-                    text += " = " + item->valueRepresentation();
-                else if (item->hasValue())
-                    text += " = " + item->arrayRepresentation();
+                if (!item->_textValid) {
+                    item->_text = item->displayText();
+                    item->_textValid = true;
+                }
+                const QString text = item->_text;
                 mutex_->unlock();
-                return text;                
+                return text;
             }
             else if (role == Qt::FontRole) {
                 QFont fnt = mainEditorFont();
@@ -469,47 +468,93 @@ Qt::ItemFlags KumVariablesModel::flags(const QModelIndex & index) const
     return result;
 }
 
-void KumVariablesModel::emitValueChanged(
+KumVariableItem * KumVariablesModel::findItem(
+        const VM::Variable * variable,
+        const QVector<int> & indeces
+        ) const
+{
+    if (indeces.isEmpty()) {
+        return variableItems_.value(variable, nullptr);
+    }
+    else {
+        return arrayItems_.value(ArrayItemKey(variable, indeces), nullptr);
+    }
+}
+
+void KumVariablesModel::beginArrayInitialize(const VM::Variable &variable, int count)
+{
+    // Rows are inserted only if variable is shown, and
+    // only the first chunk of them, others will be fetched
+    initializingArrayIndex_ = QModelIndex();
+    mutex_->lock();
+    KumVariableItem * item = variableItems_.value(&variable, nullptr);
+    mutex_->unlock();
+    if (item && count > 0 && modelIndeces_.contains(item)) {
+        initializingArrayIndex_ = modelIndeces_[item];
+        beginInsertRows(initializingArrayIndex_, 0, qMin(count, item->_fetchedRows) - 1);
+    }
+}
+
+void KumVariablesModel::endArrayInitialize(const VM::Variable &variable)
+{
+    if (initializingArrayIndex_.isValid()) {
+        initializingArrayIndex_ = QModelIndex();
+        endInsertRows();
+    }
+    noticeValueChanged(variable, QVector<int>());
+}
+
+void KumVariablesModel::noticeValueChanged(
         const VM::Variable &variable,
         const QVector<int> &indeces
         )
 {
-    QModelIndex modelIndex;
-    KumVariableItem * item = nullptr;
-    if (indeces.size() == 0) {
-        for (int i=0; i<cache_.size(); i++) {
-            KumVariableItem * it = cache_[i];
-            if (it->itemType() == KumVariableItem::Variable
-                    && it->variable() == &variable)
-            {
-                item = it;
-                break;
-            }
+    // Element text is a part of its parents texts, so they
+    // are changed too, while siblings keep their texts
+    mutex_->lock();
+    QVector<int> ind = indeces;
+    forever {
+        KumVariableItem * item = findItem(&variable, ind);
+        if (item) {
+            changedItems_.insert(item);
         }
-    }
-    else {
-        for (int i=0; i<cache_.size(); i++) {
-            KumVariableItem * it = cache_[i];
-            if (it->itemType() == KumVariableItem::ArrayItem
-                    && it->variable() == &variable
-                    && it->arrayIndeces() == indeces
-                    )
-            {
-                item = it;
-                break;
-            }
+        if (ind.isEmpty()) {
+            break;
         }
+        ind.pop_back();
     }
-    if (item && modelIndeces_.contains(item)) {
-        modelIndex = modelIndeces_[item];
+    // Notice is known to cover the last write only if nothing else
+    // was written before; value set by reference is shown by other item
+    const quint64 generation = _vm->writeGeneration();
+    if (generation == noticedGeneration_ + 1u && !variable.isReference()) {
+        noticedGeneration_ = generation;
     }
-    if (modelIndex.isValid()) {
-        emit dataChanged(modelIndex, modelIndex);
+    mutex_->unlock();
+}
+
+void KumVariablesModel::flushChanges()
+{
+    mutex_->lock();
+    const quint64 generation = _vm->writeGeneration();
+    QList<KumVariableItem*> changed;
+    if (generation != noticedGeneration_) {
+        changed = cache_;
     }
-    if (indeces.size() > 0) {
-        QVector<int> lessIndeces(indeces.size() - 1);
-        ::memcpy(lessIndeces.data(), indeces.constData(), (indeces.size()-1) * sizeof(int));
-        emitValueChanged(variable, lessIndeces);
+    else {
+        changed = changedItems_.toList();
+    }
+    noticedGeneration_ = generation;
+    changedItems_.clear();
+    for (int i=0; i<changed.size(); i++) {
+        changed[i]->_textValid = false;
+    }
+    mutex_->unlock();
+    for (int i=0; i<changed.size(); i++) {
+        KumVariableItem * item = changed[i];
+        if (modelIndeces_.contains(item)) {
+            const QModelIndex modelIndex = modelIndeces_[item];
+            emit dataChanged(modelIndex, modelIndex);
+        }
     }
 }
 
@@ -733,6 +778,26 @@ QString KumVariableItem::arrayRepresentation() const
 }
 
 
+QString KumVariableItem::displayText() const
+{
+    QString result;
+    if (_type == Variable) {
+        result = variableTypeName() + " " + name();
+        if (hasValue() && _variable->dimension() == 0)
+            result += " = " + valueRepresentation();
+        else if (hasValue() && _variable->dimension() > 0)
+            result += " = " + arrayRepresentation();
+    }
+    else if (_type == ArrayItem) {
+        result = name();
+        if (hasValue() && _variable->dimension() == _indeces.size())
+            result += " = " + valueRepresentation();
+        else if (hasValue())
+            result += " = " + arrayRepresentation();
+    }
+    return result;
+}
+
 QString KumVariableItem::valueRepresentation() const
 {
     QString result;
@@ -798,6 +863,8 @@ KumVariableItem::KumVariableItem(TableOfVariables *table, int row)
     , _table(table)
     , _tableNumber(row)
     , _framePointer(0)
+    , _fetchedRows(ARRAY_ROWS_FETCH_COUNT)
+    , _textValid(false)
 {
 }
 
@@ -808,6 +875,8 @@ KumVariableItem::KumVariableItem(TableOfVariables *table, int row, const QString
     , _tableNumber(row)
     , _algorithmName(name)
     , _framePointer(0)
+    , _fetchedRows(ARRAY_ROWS_FETCH_COUNT)
+    , _textValid(false)
 {
 }
 
@@ -818,6 +887,8 @@ KumVariableItem::KumVariableItem(const VM::Variable *variable, int row,
     , _table(table)
     , _tableNumber(row)
     , _framePointer(0)
+    , _fetchedRows(ARRAY_ROWS_FETCH_COUNT)
+    , _textValid(false)
 {
 }
 
@@ -829,6 +900,8 @@ KumVariableItem::KumVariableItem(const VM::Variable *variable, int row,
     , _tableNumber(row)
     , _indeces(indeces)
     , _framePointer(0)
+    , _fetchedRows(ARRAY_ROWS_FETCH_COUNT)
+    , _textValid(false)
 {
 }
 
@@ -10,11 +10,33 @@
 #include <QString>
 #include <QVariant>
 #include <QHash>
+#include <QSet>
 
 namespace KumirCodeRun {
 
 typedef const std::vector<VM::Variable> TableOfVariables;
 
+/* Array element item is identified by variable and up to three
+ * indeces, used to find materialized items without scanning cache */
+struct ArrayItemKey {
+    const VM::Variable * variable;
+    QVector<int> indeces;
+    inline ArrayItemKey(const VM::Variable * variable, const QVector<int> & indeces)
+        : variable(variable), indeces(indeces) {}
+    inline bool operator==(const ArrayItemKey & other) const {
+        return variable == other.variable && indeces == other.indeces;
+    }
+};
+
+inline uint qHash(const ArrayItemKey & key)
+{
+    uint result = ::qHash(quintptr(key.variable));
+    for (int i=0; i<key.indeces.size(); i++) {
+        result = result * 31u + uint(key.indeces[i]);
+    }
+    return result;
+}
+
 class KumVariableItem {
     friend class KumVariablesModel;
 public:
@@ -46,6 +68,7 @@ private:
     QString array1Representation(const QVector<int> & indeces, int maxItems, int & readItems) const;
     QString array2Representation(const QVector<int> & indeces, int maxItems, int & readItems) const;
     QString array3Representation(const QVector<int> & indeces, int maxItems, int & readItems) const;
+    QString displayText() const;
 
     Type _type;
     const VM::Variable * _variable;
@@ -54,6 +77,12 @@ private:
     QVector<int> _indeces;
     QString _algorithmName;
     quint64 _framePointer;
+
+    // Array children are materialized by chunks as view scrolls
+    int _fetchedRows;
+    // Display text is built once and dropped when value changes
+    QString _text;
+    bool _textValid;
 };
 
 class KumVariablesModel : public QAbstractItemModel
@@ -67,6 +96,8 @@ public:
     int columnCount(const QModelIndex &parent) const;
     QVariant data(const QModelIndex &index, int role) const;
     Qt::ItemFlags flags(const QModelIndex &index) const;
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
 signals:
     
 public slots:
@@ -81,16 +112,34 @@ protected:
     QModelIndex topLevelIndex(int row) const;
 
     void clear();
-    void emitValueChanged(const VM::Variable & variable, const QVector<int> & indeces);
+    void beginArrayInitialize(const VM::Variable & variable, int count);
+    void endArrayInitialize(const VM::Variable & variable);
+
+    /** Marks shown items of variable or array element changed,
+     *  they are updated by flushChanges */
+    void noticeValueChanged(const VM::Variable & variable, const QVector<int> & indeces);
+
+    /** Emits dataChanged for items changed since last call. If VM
+     *  changed something without notice (e.g. stepping over call),
+     *  all shown items are updated */
+    void flushChanges();
 
 private:
     QFont mainEditorFont() const;
+    int arrayRowsCount(const KumVariableItem * item) const;
+    KumVariableItem * findItem(const VM::Variable * variable, const QVector<int> & indeces) const;
 
     std::shared_ptr<VM::KumirVM> _vm;
     std::shared_ptr<VM::CriticalSectionLocker> mutex_;
     QHash<QModelIndex, QModelIndex> parents_;
     mutable QList<KumVariableItem*> cache_;
+    mutable QList<KumVariableItem*> tableItems_;
+    mutable QHash<const VM::Variable*, KumVariableItem*> variableItems_;
+    mutable QHash<ArrayItemKey, KumVariableItem*> arrayItems_;
     mutable QHash<KumVariableItem*, QModelIndex> modelIndeces_;
+    QSet<KumVariableItem*> changedItems_;
+    quint64 noticedGeneration_;
+    QModelIndex initializingArrayIndex_;
 };
 
 
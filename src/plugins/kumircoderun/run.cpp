@@ -37,6 +37,10 @@ Run::Run(QObject *parent) :
     _runMode = Shared::RunInterface::RM_ToEnd;
     stdInBuffer_ = 0;
     supportBreakpoints_ = true;
+    jitGenerator_ = 0;
+    jitRunning_ = false;
+    jitInput_ = 0;
+    jitOutput_ = 0;
 
     vm->setDebuggingHandler(this);
 
@@ -112,6 +116,19 @@ void Run::runBlind()
     start();
 }
 
+void Run::runJit(Kumir::AbstractInputBuffer *input, Kumir::AbstractOutputBuffer *output)
+{
+    stoppingFlag_ = false;
+    breakHitFlag_ = false;
+    ignoreLineChangeFlag_ = false;
+    _runMode = Shared::RunInterface::RM_ToEnd;
+    jitRunning_ = true;
+    jitError_.clear();
+    jitInput_ = input;
+    jitOutput_ = output;
+    start();
+}
+
 void Run::runContinuous()
 {
     _runMode = Shared::RunInterface::RM_ToEnd;
@@ -167,27 +184,12 @@ void Run::debuggerNoticeBeforeArrayInitialize(const Variable & variable,
     int firstStart = bounds[0];
     int firstEnd = bounds[1];
     int count = firstEnd - firstStart + 1;
-    QModelIndex variableIndex;
-    KumVariableItem * item = nullptr;
-    for (int i=0; i<_variablesModel->cache_.size(); i++) {
-        KumVariableItem * it = _variablesModel->cache_[i];
-        if (it->itemType() == KumVariableItem::Variable) {
-            if (it->variable() == &variable) {
-                item = it;
-                break;
-            }
-        }
-    }
-    if (item && _variablesModel->modelIndeces_.contains(item)) {
-        variableIndex = _variablesModel->modelIndeces_[item];
-    }
-    _variablesModel->beginInsertRows(variableIndex, 0, count - 1);
+    _variablesModel->beginArrayInitialize(variable, count);
 }
 
 void Run::debuggerNoticeAfterArrayInitialize(const Variable & variable)
 {
-    _variablesModel->endInsertRows();
-    _variablesModel->emitValueChanged(variable, QVector<int>());
+    _variablesModel->endArrayInitialize(variable);
 }
 
 void Run::debuggerNoticeOnValueChanged(const Variable & variable, const int * indeces)
@@ -197,7 +199,7 @@ void Run::debuggerNoticeOnValueChanged(const Variable & variable, const int * in
             : QVector<int>(indeces[3]);
     if (ind.size() > 0)
         ::memcpy(ind.data(), indeces, indeces[3] * sizeof(int));
-    _variablesModel->emitValueChanged(variable, ind);
+    _variablesModel->noticeValueChanged(variable, ind);
 }
 
 void Run::debuggerNoticeOnBreakpointHit(const String &filename, const quint32 lineNo)
@@ -317,11 +319,10 @@ void Run::removeAllBreakpoints()
     vm->removeAllBreakpoints();
 }
 
-void Run::insertOrChangeBreakpoint(bool enabled, const QString &fileName, quint32 lineNo, quint32 ignoreCount, const QString &condition)
+void Run::insertOrChangeBreakpoint(bool enabled, const QString &fileName, quint32 lineNo, quint32 ignoreCount, const VM::BreakpointCondition &condition)
 {
     const String wFileName = fileName.toStdWString();
-    const String wCondition = condition.toStdWString();
-    vm->insertOrChangeBreakpoint(enabled, wFileName, lineNo, ignoreCount, wCondition);
+    vm->insertOrChangeBreakpoint(enabled, wFileName, lineNo, ignoreCount, condition);
 }
 
 void Run::insertSingleHitBreakpoint(const QString &fileName, quint32 lineNo)
@@ -336,8 +337,23 @@ void Run::removeBreakpoint(const QString &fileName, quint32 lineNo)
     vm->removeBreakpoint(wFileName, lineNo);
 }
 
+void Run::runJitProgram()
+{
+    // Native code can't be paused or stepped, so it runs until
+    // finished, runtime error or input request cancelled by user
+    jitGenerator_->runInProcess(jitProgram_, QStringList(), jitInput_, jitOutput_, jitError_);
+    if (jitError_.length() > 0 && !stoppingFlag_) {
+        emit error(jitError_);
+    }
+    emit aboutToStop();
+}
+
 void Run::run()
 {    
+    if (jitRunning_) {
+        runJitProgram();
+        return;
+    }
     while (vm->hasMoreInstructions()) {
         if (mustStop()) {
             break;
@@ -368,8 +384,12 @@ void Run::run()
 //        emit lineChanged(vm->effectiveLineNo());
 //        emit error(QString::fromStdWString(vm->error()));
 //    }
+    if (programFinished && profiler_) {
+        showProfileHeatmap();
+    }
     if (programFinished)
         Kumir::finalizeStandardLibrary();
+    _variablesModel->flushChanges();
     emit aboutToStop();
 }
 
@@ -410,6 +430,42 @@ void Run::setEntryPointToTest()
     vm->setEntryPoint(KumirVM::EP_Testing);
 }
 
+void Run::setJitProgram(Shared::GeneratorInterface *generator, const AST::DataPtr &tree)
+{
+    jitGenerator_ = generator;
+    jitProgram_ = tree;
+}
+
+void Run::setProfilingEnabled(bool enabled)
+{
+    if (enabled && !profiler_) {
+        profiler_.reset(new VM::Profiler);
+    }
+    else if (!enabled) {
+        profiler_.reset();
+    }
+    vm->setProfiler(profiler_.get());
+}
+
+void Run::showProfileHeatmap()
+{
+    // Share of executed instructions per line of main program,
+    // hot lines are shown in red
+    profiler_->finish();
+    const quint64 total = profiler_->totalInstructions();
+    if (0u == total) {
+        return;
+    }
+    const std::map<int, uint64_t> lines = profiler_->lineCounts(0);
+    for (std::map<int, uint64_t>::const_iterator it = lines.begin(); it != lines.end(); ++it) {
+        const double percent = 100.0 * it->second / total;
+        const int barLength = qBound(1, qRound(percent / 10.0), 10);
+        const QString text = QString(barLength, QChar(0x2588)) +
+                QString(" %1%").arg(percent, 0, 'f', 1);
+        emit marginTextReplace(it->first, text, percent >= 10.0);
+    }
+}
+
 bool Run::isTestingRun() const
 {
     return vm->entryPoint() == KumirVM::EP_Testing;
@@ -417,8 +473,10 @@ bool Run::isTestingRun() const
 
 QString Run::error() const
 {
-    return programLoadError_.length() > 0
-            ? programLoadError_ : QString::fromStdWString(vm->error());
+    if (programLoadError_.length() > 0) {
+        return programLoadError_;
+    }
+    return jitRunning_ ? jitError_ : QString::fromStdWString(vm->error());
 }
 
 bool Run::hasTestingAlgorithm() const
@@ -429,6 +487,8 @@ bool Run::hasTestingAlgorithm() const
 
 void Run::reset()
 {
+    jitRunning_ = false;
+    jitError_.clear();
     breakHitFlag_ = false;
     ignoreLineChangeFlag_ = false;
     vm->reset();
@@ -436,6 +496,9 @@ void Run::reset()
 
 bool Run::hasMoreInstructions() const
 {
+    if (jitRunning_) {
+        return isRunning();
+    }
     return vm->hasMoreInstructions();
 }
 
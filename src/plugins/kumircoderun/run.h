@@ -6,6 +6,7 @@
 #include <kumir2-libs/vm/vm.hpp>
 #include <kumir2/actorinterface.h>
 #include <kumir2/runinterface.h>
+#include <kumir2/generatorinterface.h>
 #include "kumvariablesmodel.h"
 #include "guirun.h"
 #include <memory>
@@ -70,6 +71,10 @@ public:
 
     void setEntryPointToMain();
     void setEntryPointToTest();
+    void setJitProgram(Shared::GeneratorInterface * generator, const AST::DataPtr & tree);
+    inline bool hasJitProgram() const { return jitGenerator_ && jitProgram_; }
+    void setProfilingEnabled(bool enabled);
+    inline const VM::Profiler * profiler() const { return profiler_.get(); }
     bool hasMoreInstructions() const;
     void reset();
     void evaluateNextInstruction();
@@ -89,6 +94,7 @@ public slots:
     void runStepIn();
     void runToEnd();
     void runBlind();
+    void runJit(Kumir::AbstractInputBuffer * input, Kumir::AbstractOutputBuffer * output);
     void runContinuous();
     void runInCurrentThread();
 
@@ -115,7 +121,7 @@ public slots:
     void handlePauseRequest();
 
     void removeAllBreakpoints();
-    void insertOrChangeBreakpoint(bool enabled, const QString &fileName, quint32 lineNo, quint32 ignoreCount, const QString &condition);
+    void insertOrChangeBreakpoint(bool enabled, const QString &fileName, quint32 lineNo, quint32 ignoreCount, const VM::BreakpointCondition &condition);
     void insertSingleHitBreakpoint(const QString &fileName, quint32 lineNo);
     void removeBreakpoint(const QString &fileName, quint32 lineNo);
 
@@ -140,6 +146,8 @@ signals:
 
 protected :
     void run();
+    void runJitProgram();
+    void showProfileHeatmap();
 
     Shared::RunInterface::RunMode _runMode;
 
@@ -174,6 +182,15 @@ protected :
     bool supportBreakpoints_;
     QMap<BreakpointLocation,BreakpointData> breakpoints_;
 
+    Shared::GeneratorInterface * jitGenerator_;
+    AST::DataPtr jitProgram_;
+    bool jitRunning_;
+    QString jitError_;
+    Kumir::AbstractInputBuffer * jitInput_;
+    Kumir::AbstractOutputBuffer * jitOutput_;
+
+    std::shared_ptr<VM::Profiler> profiler_;
+
 };
 
 
@@ -2,6 +2,7 @@
 #include "runplugin.h"
 #include "run.h"
 #include <kumir2-libs/extensionsystem/pluginmanager.h>
+#include <kumir2/analizer_compilerinterface.h>
 #include <iostream>
 #include <sstream>
 #include <locale.h>
@@ -55,6 +56,7 @@ KumirRunPlugin::KumirRunPlugin()
     , gui_(nullptr)
     , simulatedInputBuffer_(nullptr)
     , simulatedOutputBuffer_(nullptr)
+    , sourceHelper_(nullptr)
 {
     connect (this, SIGNAL(finishInput(QVariantList)), pRun_, SIGNAL(finishInput(QVariantList)));
 
@@ -74,6 +76,7 @@ KumirRunPlugin::KumirRunPlugin()
              this, SIGNAL(replaceMarginText(int,QString,bool)));
     connect (pRun_, SIGNAL(breakpointHit(QString,int)), this, SLOT(handleBreakpointHit(QString,int)));
     onlyOneTryToInput_ = false;
+    useJit_ = false;
 }
 
 unsigned long int KumirRunPlugin::stepsCounted() const
@@ -95,6 +98,7 @@ bool KumirRunPlugin::loadProgram(const RunnableProgram &program)
 {
     const QString programFileName = program.sourceFileName.isEmpty()
             ? program.executableFileName : program.sourceFileName;
+    programTree_ = program.abstractSyntaxTree;
     bool ok = false;
     std::list<char> buffer;
     for (int i=0; i<program.executableData.size(); i++)
@@ -107,6 +111,9 @@ bool KumirRunPlugin::loadProgram(const RunnableProgram &program)
             ? "" : QFileInfo(programFileName).absoluteDir().absolutePath();
     pRun_->setProgramDirectory(programDirName);
     pRun_->programLoaded = ok;
+    if (useJit_) {
+        pRun_->setJitProgram(jitGenerator(), program.abstractSyntaxTree);
+    }
     return ok;
 }
 
@@ -393,7 +400,26 @@ void KumirRunPlugin::runBlind()
         pRun_->reset();
         done_ = false;
     }
-    pRun_->runBlind();
+    if (pRun_->hasJitProgram()) {
+        pRun_->runJit(simulatedInputBuffer_? simulatedInputBuffer_ : defaultInputBuffer_,
+                      simulatedOutputBuffer_? simulatedOutputBuffer_ : defaultOutputBuffer_);
+    }
+    else {
+        pRun_->runBlind();
+    }
+}
+
+Shared::GeneratorInterface * KumirRunPlugin::jitGenerator() const
+{
+    using namespace ExtensionSystem;
+    QList<Shared::GeneratorInterface*> generators =
+            PluginManager::instance()->findPlugins<Shared::GeneratorInterface>();
+    foreach (Shared::GeneratorInterface * generator, generators) {
+        if (generator->hasInProcessRunSupport()) {
+            return generator;
+        }
+    }
+    return nullptr;
 }
 
 void KumirRunPlugin::runStepInto()
@@ -452,7 +478,58 @@ void KumirRunPlugin::removeAllBreakpoints()
 
 void KumirRunPlugin::insertOrChangeBreakpoint(bool enabled, const QString &fileName, quint32 lineNo, quint32 ignoreCount, const QString &condition)
 {
-    pRun_->insertOrChangeBreakpoint(enabled, fileName, lineNo, ignoreCount, condition);
+    VM::BreakpointCondition compiledCondition;
+    if (!condition.trimmed().isEmpty()) {
+        QString error;
+        if (!compileBreakpointCondition(lineNo, condition, compiledCondition, error)) {
+            // Breakpoint stops unconditionally, so user can fix condition
+            qWarning() << "Breakpoint condition at line" << lineNo + 1 << "ignored:" << error;
+        }
+    }
+    pRun_->insertOrChangeBreakpoint(enabled, fileName, lineNo, ignoreCount, compiledCondition);
+}
+
+void KumirRunPlugin::setSourceHelper(Shared::Analizer::HelperInterface *helper)
+{
+    sourceHelper_ = helper;
+}
+
+bool KumirRunPlugin::compileBreakpointCondition(quint32 lineNo, const QString &text,
+                                                VM::BreakpointCondition &condition, QString &error) const
+{
+    using namespace Shared;
+    // Condition is parsed by the same analizer instance, which made
+    // program tree, and generated by bytecode generator for that tree
+    QObject * analizerObject = dynamic_cast<QObject*>(sourceHelper_);
+    Analizer::ASTCompilerInterface * compiler = analizerObject
+            ? qobject_cast<Analizer::ASTCompilerInterface*>(analizerObject) : nullptr;
+    GeneratorInterface * generator =
+            ExtensionSystem::PluginManager::instance()->findPlugin<GeneratorInterface>("KumirCodeGenerator");
+    if (!compiler || !generator || !programTree_) {
+        error = tr("Breakpoint conditions are not supported for this program");
+        return false;
+    }
+
+    AST::ModulePtr module;
+    AST::AlgorithmPtr algorithm;
+    const AST::ExpressionPtr expression =
+            compiler->parseExpression(int(lineNo), text, module, algorithm, error);
+    if (!expression) {
+        return false;
+    }
+    QByteArray data;
+    generator->generateBreakpointCondition(programTree_, module, algorithm, expression, data, error);
+    if (!error.isEmpty()) {
+        return false;
+    }
+
+    std::list<char> buffer(data.constBegin(), data.constEnd());
+    String loadError;
+    if (!VM::KumirVM::loadBreakpointConditionFromBinaryBuffer(buffer, condition, loadError)) {
+        error = QString::fromStdWString(loadError);
+        return false;
+    }
+    return true;
 }
 
 void KumirRunPlugin::insertSingleHitBreakpoint(const QString &fileName, quint32 lineNo)
@@ -713,6 +790,8 @@ QString KumirRunPlugin::initialize(const QStringList &configurationArguments,
     pRun_->programLoaded = false;
     const bool noBreakpoints = configurationArguments.contains("nobreakpoints");
     pRun_->setSupportBreakpoints(!noBreakpoints);
+    useJit_ = configurationArguments.contains("jit");
+    pRun_->setProfilingEnabled(configurationArguments.contains("profile"));
     qRegisterMetaType<QVariant::Type>("QVariant::Type");
     qRegisterMetaType< QList<QVariant::Type> >("QList<QVariant::Type>");
     qRegisterMetaType<Shared::RunInterface::StopReason>("Shared::RunInterface::StopReason");
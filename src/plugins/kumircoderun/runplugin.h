@@ -5,10 +5,16 @@
 #include <kumir2-libs/extensionsystem/kplugin.h>
 #include <kumir2-libs/extensionsystem/pluginspec.h>
 #include <kumir2/runinterface.h>
+#include <kumir2/generatorinterface.h>
+#include <kumir2/analizer_helperinterface.h>
 #include "commonrun.h"
 #include "consolerun.h"
 #include "guirun.h"
 
+namespace VM {
+struct BreakpointCondition;
+}
+
 namespace KumirCodeRun {
 
 
@@ -66,6 +72,7 @@ public:
 
     void setStdInTextStream(QTextStream *);
     void setStdOutTextStream(QTextStream *);
+    void setSourceHelper(Shared::Analizer::HelperInterface * helper);
 
 public slots:
     void runProgramInCurrentThread(bool useTestingEntryPoint = false);
@@ -96,9 +103,13 @@ protected:
     void prepareCommonRun();
     void prepareConsoleRun();
     void prepareGuiRun();
+    Shared::GeneratorInterface * jitGenerator() const;
+    bool compileBreakpointCondition(quint32 lineNo, const QString & text,
+                                    VM::BreakpointCondition & condition, QString & error) const;
     QDateTime loadedVersion_;
     bool done_;
     bool onlyOneTryToInput_;
+    bool useJit_; // run blind using native code generator
 
 protected slots:
     void handleThreadFinished();
@@ -133,6 +144,10 @@ private:
     Gui::SimulatedOutputBuffer * simulatedOutputBuffer_;
     Kumir::AbstractOutputBuffer * defaultOutputBuffer_;
 
+    // Used to compile breakpoint conditions
+    Shared::Analizer::HelperInterface * sourceHelper_;
+    AST::DataPtr programTree_;
+
 
 };
 
@@ -22,6 +22,7 @@ KumirCompilerToolPlugin::KumirCompilerToolPlugin()
     , analizer_(nullptr)
     , generator_(nullptr)
     , useAnsiWindowsOutput_(true)
+    , runInProcess_(false)
 {
 }
 
@@ -47,6 +48,11 @@ KumirCompilerToolPlugin::acceptableCommandLineParameters() const
                   tr("Explicitly set output file name"),
                   QVariant::String, false
                   );
+    result << CommandLineParameter(
+                  false,
+                  'r', "run",
+                  tr("Run program in current process instead of writing executable (if generator supports it)")
+                  );
 
     // Startup parameters
 
@@ -57,6 +63,13 @@ KumirCompilerToolPlugin::acceptableCommandLineParameters() const
                   QVariant::String,
                   true
                   );
+    result << CommandLineParameter(
+                  false,
+                  tr("PROGRAM_ARG_%1"),
+                  tr("Program argument after -- separator (in conjuntion with -r flag)"),
+                  QVariant::String,
+                  false
+                  );
     return result;
 }
 
@@ -72,9 +85,18 @@ QString KumirCompilerToolPlugin::initialize(
     analizer_ = manager->findPlugin<AnalizerInterface>();
     generator_ = manager->findPlugin<GeneratorInterface>();
 
+    // Tool options come first; program arguments are only those
+    // following explicit '--' separator
+    bool programArgumentsStarted = false;
     for (int i=1; i<qApp->arguments().size(); i++) {
         const QString arg = qApp->arguments()[i];
-        if ( !arg.startsWith("-") && !arg.startsWith("[") && arg.endsWith(".kum")) {
+        if (programArgumentsStarted) {
+            programArguments_ << arg;
+        }
+        else if ("--" == arg) {
+            programArgumentsStarted = true;
+        }
+        else if ( !arg.startsWith("-") && !arg.startsWith("[") && arg.endsWith(".kum")) {
             sourceFileName_ = arg;
         }
     }
@@ -86,6 +108,11 @@ QString KumirCompilerToolPlugin::initialize(
     useAnsiWindowsOutput_ = runtimeArguments.hasFlag('a');
     sourceFileEncoding_ = runtimeArguments.value('e').toString();
     outFileName_ = runtimeArguments.value('o').toString();
+    runInProcess_ = runtimeArguments.hasFlag('r');
+
+    if (runInProcess_ && !generator_->hasInProcessRunSupport()) {
+        return tr("Error: in-process run is not supported by code generator");
+    }
 
     return QString();
 }
@@ -143,6 +170,25 @@ void KumirCompilerToolPlugin::start()
             std::cerr << std::endl;
         }
 
+        if (runInProcess_) {
+            if (!errors.isEmpty()) {
+                qApp->setProperty("returnCode", 1);
+                return;
+            }
+            QString runError;
+            const int status = generator_->runInProcess(ast, programArguments_, 0, 0, runError);
+            if (runError.length() > 0) {
+#ifdef Q_OS_WIN32
+                QTextCodec * cp866 = QTextCodec::codecForName("CP866");
+                fprintf(stderr, "%s\n", cp866->fromUnicode(runError).constData());
+#else
+                std::cerr << runError.toLocal8Bit().data() << std::endl;
+#endif
+            }
+            qApp->setProperty("returnCode", status);
+            return;
+        }
+
         QString suffix;
         QString mimeType;
         QByteArray outData;
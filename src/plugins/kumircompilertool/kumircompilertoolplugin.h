@@ -36,6 +36,8 @@ private:
     QString sourceFileEncoding_;
     bool useAnsiWindowsOutput_;
     QString outFileName_;
+    bool runInProcess_;
+    QStringList programArguments_;
 
 
 };
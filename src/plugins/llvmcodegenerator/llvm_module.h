@@ -42,6 +42,9 @@ public:
     QByteArray textRepresentation() const;
     QByteArray binaryRepresentation() const;
 
+    // Passes ownership of module, for example to JIT execution engine
+    inline llvm::Module * release() { return d.release(); }
+
     operator bool() const;
     bool operator == (const ModuleRef other) const;
 
@@ -3,6 +3,7 @@
 
 #include <QtPlugin>
 #include <QProcess>
+#include <QMutex>
 #if QT_VERSION >= 0x050000
 #include <QProcessEnvironment>
 #endif
@@ -25,6 +26,23 @@
 #include <llvm/Support/TargetSelect.h>
 
 #include <llvm/IR/PassManager.h>
+#if LLVM_VERSION_MINOR >= 7
+#include <llvm/IR/LegacyPassManager.h>
+#else
+#include <llvm/PassManager.h>
+#endif
+#include <llvm/Transforms/IPO.h>
+#include <llvm/Transforms/IPO/PassManagerBuilder.h>
+
+#include <llvm/ExecutionEngine/ExecutionEngine.h>
+#include <llvm/ExecutionEngine/MCJIT.h>
+#include <llvm/Support/DynamicLibrary.h>
+
+#include "stdlib_c.h"
+
+#ifdef Q_OS_UNIX
+#include <dlfcn.h>
+#endif
 
 
 #include <iostream>
@@ -113,7 +131,52 @@ void LLVMCodeGeneratorPlugin::generateExecutable(
             QString & fileSuffix
             )
 {
-    d->reset(createMain_, debugLevel_);
+    QString error;
+    LLVM::ModuleRef reparsedModule =
+            createModule(tree, createMain_, linkAllUnits_, linkStdLib_, error);
+
+    if (!reparsedModule) {
+        std::cerr << error.toUtf8().constData() << std::endl;
+        qApp->setProperty("returnCode", 5);
+        qApp->quit();
+        return;
+    }
+
+    if (textForm_) {
+        out = reparsedModule.textRepresentation();
+        mimeType = "text/llvm";
+        fileSuffix = ".ll";
+        return;
+    }
+
+    const QByteArray binBufData = reparsedModule.binaryRepresentation();
+
+    if (!runToolChain_) {
+        out = binBufData;
+        mimeType = "binary/llvm";
+        fileSuffix = ".bc";
+        return;
+    }
+
+    out = runExternalToolsToGenerateExecutable(binBufData);
+    mimeType = "executable";
+#ifndef Q_OS_WIN32
+    fileSuffix = "";
+#else
+    fileSuffix = ".exe";
+#endif
+
+}
+
+LLVM::ModuleRef LLVMCodeGeneratorPlugin::createModule(
+        const AST::DataPtr tree,
+        bool createMain,
+        bool linkAllUnits,
+        bool linkStdLib,
+        QString & error
+        )
+{
+    d->reset(createMain, debugLevel_);
 
     const QList<AST::ModulePtr> & modules = tree->modules;
     QList<AST::ModulePtr> kmodules;
@@ -124,21 +187,19 @@ void LLVMCodeGeneratorPlugin::generateExecutable(
         {
             const QString & kumFileName = kmod->header.name;
             if (!compileExternalUnit(kumFileName)) {
-                qApp->setProperty("returnCode", 5);
-                qApp->quit();
-                return;
+                error = QString::fromUtf8(
+                            "Не могу скомпилировать внешний модуль: %1"
+                            ).arg(kumFileName);
+                return LLVM::ModuleRef();
             }
             const QString bcFileName =
                     kumFileName.left(kumFileName.length()-4) + ".bc";
             QFile unitFile(bcFileName);
             if (!unitFile.open(QIODevice::ReadOnly)) {
-                const QString message = QString::fromUtf8(
-                            "Не могу прочитать файл: "
+                error = QString::fromUtf8(
+                            "Не могу прочитать файл: %1"
                             ).arg(bcFileName);
-                std::cerr << message.toUtf8().constData() << std::endl;
-                qApp->setProperty("returnCode", 5);
-                qApp->quit();
-                return;
+                return LLVM::ModuleRef();
             }
             const QByteArray unitBytes = unitFile.readAll();
             unitFile.close();
@@ -152,13 +213,10 @@ void LLVMCodeGeneratorPlugin::generateExecutable(
 
             if (!unitModule)
             {
-                const QString message = QString::fromUtf8(
-                            "Файл внешнего модуля поврежден: "
+                error = QString::fromUtf8(
+                            "Файл внешнего модуля поврежден: %1"
                             ).arg(bcFileName);
-                std::cerr << message.toUtf8().constData() << std::endl;
-                qApp->setProperty("returnCode", 5);
-                qApp->quit();
-                return;
+                return LLVM::ModuleRef();
             }
             d->createExternsTable(unitModule, "__kumir_function_");
             usedUnits.push_back(std::move(unitModule));
@@ -211,40 +269,149 @@ void LLVMCodeGeneratorPlugin::generateExecutable(
                 bufData, d->context_);
 
 
-    if (linkAllUnits_) {
+    if (linkAllUnits) {
         for (int i=0; i<usedUnits.size(); i++) {
             usedUnits[i].linkInto(reparsedModule);
         }
     }
 
-    if (linkStdLib_) {
+    if (linkStdLib) {
         d->getStdLibModule().linkInto(reparsedModule);
     }
 
-    if (textForm_) {
-        out = reparsedModule.textRepresentation();
-        mimeType = "text/llvm";
-        fileSuffix = ".ll";
-        return;
+    return reparsedModule;
+}
+
+bool LLVMCodeGeneratorPlugin::hasInProcessRunSupport() const
+{
+#ifdef Q_OS_UNIX
+    return true;
+#else
+    // Runtime symbols are not exported from plugin DLL
+    return false;
+#endif
+}
+
+bool LLVMCodeGeneratorPlugin::initializeJit(QString & error)
+{
+    static QMutex mutex;
+    static bool initialized = false;
+    static QString initializationError;
+    QMutexLocker lock(&mutex);
+    if (initialized) {
+        error = initializationError;
+        return initializationError.isEmpty();
     }
+    initialized = true;
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+    llvm::InitializeNativeTargetAsmParser();
+#ifdef Q_OS_UNIX
+    // Plugin is loaded with local symbols visibility, so make runtime
+    // functions linked into it visible to JIT-compiled code
+    Dl_info info;
+    if (0 == dladdr(reinterpret_cast<void*>(&__kumir_run_in_process), &info) || !info.dli_fname) {
+        initializationError = "Can't locate runtime library";
+    }
+    else {
+        std::string loadError;
+        if (llvm::sys::DynamicLibrary::LoadLibraryPermanently(info.dli_fname, &loadError)) {
+            initializationError = QString::fromLocal8Bit(loadError.c_str());
+        }
+    }
+#endif
+    error = initializationError;
+    return initializationError.isEmpty();
+}
 
-    const QByteArray binBufData = reparsedModule.binaryRepresentation();
+void LLVMCodeGeneratorPlugin::optimizeModule(llvm::Module *module)
+{
+#if LLVM_VERSION_MINOR >= 7
+    llvm::legacy::FunctionPassManager functionPasses(module);
+    llvm::legacy::PassManager modulePasses;
+#else
+    llvm::FunctionPassManager functionPasses(module);
+    llvm::PassManager modulePasses;
+#endif
+    llvm::PassManagerBuilder builder;
+    builder.OptLevel = 2;
+    builder.Inliner = llvm::createFunctionInliningPass();
+    builder.populateFunctionPassManager(functionPasses);
+    builder.populateModulePassManager(modulePasses);
+
+    functionPasses.doInitialization();
+    for (llvm::Module::iterator it = module->begin(); it != module->end(); ++it) {
+        functionPasses.run(*it);
+    }
+    functionPasses.doFinalization();
+    modulePasses.run(*module);
+}
 
-    if (!runToolChain_) {
-        out = binBufData;
-        mimeType = "binary/llvm";
-        fileSuffix = ".bc";
-        return;
+int LLVMCodeGeneratorPlugin::runInProcess(
+        const AST::DataPtr tree,
+        const QStringList & arguments,
+        Kumir::AbstractInputBuffer * input,
+        Kumir::AbstractOutputBuffer * output,
+        QString & error
+        )
+{
+    if (!hasInProcessRunSupport() || !initializeJit(error)) {
+        return -1;
     }
 
-    out = runExternalToolsToGenerateExecutable(binBufData);
-    mimeType = "executable";
-#ifndef Q_OS_WIN32
-    fileSuffix = "";
+    LLVM::ModuleRef module = createModule(tree, true, true, false, error);
+    if (!module) {
+        return -1;
+    }
+    // Runtime leaves generated code by C++ exception on 'стоп' and errors
+    llvm::Module * rawModule = module.rawPtr();
+    for (llvm::Module::iterator it = rawModule->begin(); it != rawModule->end(); ++it) {
+        it->removeFnAttr(llvm::Attribute::NoUnwind);
+    }
+    optimizeModule(rawModule);
+
+    std::string engineError;
+#if LLVM_VERSION_MINOR >= 6
+    llvm::EngineBuilder engineBuilder(std::unique_ptr<llvm::Module>(module.release()));
 #else
-    fileSuffix = ".exe";
+    llvm::EngineBuilder engineBuilder(module.release());
+    engineBuilder.setUseMCJIT(true);
 #endif
+    engineBuilder.setEngineKind(llvm::EngineKind::JIT);
+    engineBuilder.setErrorStr(&engineError);
+    engineBuilder.setOptLevel(llvm::CodeGenOpt::Default);
+    std::unique_ptr<llvm::ExecutionEngine> engine(engineBuilder.create());
+    if (!engine) {
+        error = QString::fromLocal8Bit(engineError.c_str());
+        return -1;
+    }
+    engine->finalizeObject();
+
+    typedef int (*MainFunction)(int, char**);
+    MainFunction entryPoint = reinterpret_cast<MainFunction>(
+                engine->getFunctionAddress("main"));
+    if (!entryPoint) {
+        error = "No entry point in program";
+        return -1;
+    }
+
+    // Runtime uses argv[0] to find program directory
+    QList<QByteArray> argumentsData;
+    argumentsData << (QDir::currentPath() + "/" + QCoreApplication::applicationName()).toUtf8();
+    foreach (const QString & argument, arguments) {
+        argumentsData << argument.toUtf8();
+    }
+    std::vector<char*> argv;
+    for (int i=0; i<argumentsData.size(); i++) {
+        argv.push_back(argumentsData[i].data());
+    }
+    argv.push_back(0);
 
+    std::string runtimeError;
+    const int status = __kumir_run_in_process(entryPoint, argumentsData.size(), &argv[0],
+                                              input, output, runtimeError);
+    error = QString::fromUtf8(runtimeError.c_str());
+    return status;
 }
 
 bool LLVMCodeGeneratorPlugin::compileExternalUnit(const QString &fileName)
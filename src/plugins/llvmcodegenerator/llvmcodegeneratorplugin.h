@@ -9,6 +9,8 @@
 
 #include <llvm/ADT/Triple.h>
 
+#include "llvm_module.h"
+
 namespace LLVMCodeGenerator {
 
 class LLVMCodeGeneratorPlugin
@@ -40,10 +42,26 @@ public:
     inline void setTemporaryDir(const QString &, bool ) {}
     inline void updateSettings(const QStringList &) {}
 
+    bool hasInProcessRunSupport() const;
+    int runInProcess(
+            const AST::DataPtr tree,
+            const QStringList & arguments,
+            Kumir::AbstractInputBuffer * input,
+            Kumir::AbstractOutputBuffer * output,
+            QString & error
+            );
+
 protected:
     QString initialize(const QStringList &configurationArguments,
                        const ExtensionSystem::CommandLine &runtimeArguments);
     static void fixMultipleTypeDeclarations(QByteArray & data);
+    LLVM::ModuleRef createModule(const AST::DataPtr tree,
+                                 bool createMain,
+                                 bool linkAllUnits,
+                                 bool linkStdLib,
+                                 QString & error);
+    static void optimizeModule(llvm::Module * module);
+    static bool initializeJit(QString & error);
     void start();
     void stop();
 
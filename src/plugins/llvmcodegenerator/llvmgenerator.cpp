@@ -18,6 +18,7 @@
 #include <llvm/IR/ValueSymbolTable.h>
 #include <llvm/IR/Value.h>
 #include <llvm/IR/Attributes.h>
+#include <llvm/IR/Intrinsics.h>
 
 
 #include <llvm/Bitcode/ReaderWriter.h>
@@ -552,9 +553,14 @@ void LLVMGenerator::addFunction(const AST::AlgorithmPtr kfunc, bool createBody)
                 LLVM::TypeRef ty = kvar->dimension > 0u
                         ? getArrayType() : getScalarType();
                 llvm::Value * arg = CreateAlloca(builder, ty, cname, BeforeTerminator);
-                LLVM::FunctionRef initFunc = kvar->dimension == 0u
-                        ? kumirCreateUndefinedScalar_ : kumirCreateUndefinedArray_;
-                initFunc.createCallInstruction(&builder, arg);
+                if (0u == kvar->dimension && isNativeScalarType(kvar->baseType.kind)) {
+                    createUndefinedNativeScalar(builder, arg, kvar->baseType.kind);
+                }
+                else {
+                    LLVM::FunctionRef initFunc = kvar->dimension == 0u
+                            ? kumirCreateUndefinedScalar_ : kumirCreateUndefinedArray_;
+                    initFunc.createCallInstruction(&builder, arg);
+                }
             }
         }
 
@@ -892,9 +898,29 @@ llvm::Value* LLVMGenerator::createVarInitialize(llvm::IRBuilder<> &builder, cons
 void LLVMGenerator::createAssign(llvm::IRBuilder<> &builder, const AST::StatementPtr &st, const AST::AlgorithmPtr & alg)
 {
     const AST::ExpressionPtr rvalue = st->expressions.at(0);
+    const AST::ExpressionPtr lvalue = st->expressions.size() > 1
+            ? st->expressions.at(1) : AST::ExpressionPtr();
+    const bool nativeLvalue = lvalue && isNativeScalar(lvalue) && (
+                lvalue->kind == AST::ExprVariable || (
+                    lvalue->kind == AST::ExprArrayElement &&
+                    lvalue->variable->dimension == lvalue->operands.size() &&
+                    hasNativeArrayIndices(lvalue)
+                    )
+                );
+    if (nativeLvalue && isNativeScalar(rvalue))
+    {
+        const AST::VariableBaseType type = lvalue->baseType.kind;
+        llvm::Value * value = calculateNative(builder, rvalue, type);
+        llvm::Value * llvm_lvalue = lvalue->kind == AST::ExprVariable
+                ? calculate(builder, lvalue, true)
+                : createNativeArrayElementPtr(builder, lvalue, false);
+        Q_ASSERT(llvm_lvalue);
+        storeNativeScalar(builder, llvm_lvalue, value, type);
+        createFreeTempScalars(builder);
+        return;
+    }
     llvm::Value * llvm_rvalue = calculate(builder, rvalue);
-    if (st->expressions.size() > 1) {
-        const AST::ExpressionPtr lvalue = st->expressions.at(1);        
+    if (lvalue) {
         llvm::Value * llvm_lvalue = calculate(builder, lvalue, true);
         Q_ASSERT(llvm_lvalue);
         LLVM::FunctionRef storeFunc;
@@ -1158,6 +1184,12 @@ void LLVMGenerator::createLoop(llvm::IRBuilder<> &builder, const AST::StatementP
     llvm::Value * times = 0;
     llvm::Value * end_cond = 0;
     llvm::Value * loop_variable = 0;
+    llvm::Value * counter = 0;
+    llvm::Value * next_value = 0;
+    const bool nativeFor = loop.type == AST::LoopFor && loop.forVariable &&
+            isNativeScalar(loop.fromValue) && isNativeScalar(loop.toValue) &&
+            (!loop.stepValue || isNativeScalar(loop.stepValue));
+    const bool nativeTimes = loop.type == AST::LoopTimes && isNativeScalar(loop.timesValue);
 
     // --- loop structure
     loopCounter_ ++;
@@ -1205,6 +1237,27 @@ void LLVMGenerator::createLoop(llvm::IRBuilder<> &builder, const AST::StatementP
 //        }
         loop_variable = findVariableAtCurrentContext(kvar);
         Q_ASSERT(loop_variable);
+    }
+    if (nativeFor) {
+        // Counter is kept in stack slot, so nested and recursive loops
+        // do not need runtime counters stack
+        llvm::Type * intType = getNativeType(AST::TypeInteger);
+        for_from = calculateNative(builder, loop.fromValue, AST::TypeInteger);
+        for_to = calculateNative(builder, loop.toValue, AST::TypeInteger);
+        for_step = loop.stepValue
+                ? calculateNative(builder, loop.stepValue, AST::TypeInteger)
+                : llvm::ConstantInt::getSigned(intType, 1);
+        counter = CreateAlloca(builder, LLVM::TypeRef::getGeneric(LLVM::TypeRef::TY_Int, context_),
+                               basicName + "counter", BeforeTerminator);
+        builder.CreateStore(builder.CreateSub(for_from, for_step), counter);
+    }
+    else if (nativeTimes) {
+        times = calculateNative(builder, loop.timesValue, AST::TypeInteger);
+        counter = CreateAlloca(builder, LLVM::TypeRef::getGeneric(LLVM::TypeRef::TY_Int, context_),
+                               basicName + "counter", BeforeTerminator);
+        builder.CreateStore(times, counter);
+    }
+    else if (loop.type == AST::LoopFor && loop.forVariable) {
         for_from = calculate(builder, loop.fromValue);
         Q_ASSERT(for_from);
         if (loop.fromValue->kind != AST::ExprVariable)
@@ -1238,7 +1291,25 @@ void LLVMGenerator::createLoop(llvm::IRBuilder<> &builder, const AST::StatementP
     // --- loop pre-check
     builder.SetInsertPoint(loop_begin);
     llvm::Value * loop_pre_check = 0;
-    if (loop.type == AST::LoopFor && loop_variable && for_from && for_to) {
+    if (nativeFor) {
+        next_value = builder.CreateAdd(builder.CreateLoad(counter), for_step);
+        builder.CreateStore(next_value, counter);
+        llvm::Value * ascending = builder.CreateAnd(builder.CreateICmpSLE(for_from, next_value),
+                                                    builder.CreateICmpSLE(next_value, for_to));
+        llvm::Value * descending = builder.CreateAnd(builder.CreateICmpSLE(for_to, next_value),
+                                                     builder.CreateICmpSLE(next_value, for_from));
+        llvm::Value * positiveStep = builder.CreateICmpSGE(for_step,
+                                                           llvm::ConstantInt::getSigned(for_step->getType(), 0));
+        loop_pre_check = builder.CreateSelect(positiveStep, ascending, descending,
+                                              std::string(basicName + "for_check"));
+    }
+    else if (nativeTimes) {
+        llvm::Value * left = builder.CreateLoad(counter);
+        builder.CreateStore(builder.CreateSub(left, llvm::ConstantInt::getSigned(left->getType(), 1)), counter);
+        loop_pre_check = builder.CreateICmpSGT(left, llvm::ConstantInt::getSigned(left->getType(), 0),
+                                               std::string(basicName + "times_check"));
+    }
+    else if (loop.type == AST::LoopFor && loop_variable && for_from && for_to) {
         loop_pre_check = kumirLoopForCheckCounter_.createCallInstruction(&builder, loop_variable);
         loop_pre_check->setName(std::string(basicName + "for_check"));
     }
@@ -1248,10 +1319,7 @@ void LLVMGenerator::createLoop(llvm::IRBuilder<> &builder, const AST::StatementP
         loop_pre_check->setName(std::string(basicName + "times_check"));
     }
     else if (loop.type == AST::LoopWhile && loop.whileCondition) {
-        Q_ASSERT(kumirScalarAsBool_);
-        llvm::Value* lcond = calculate(builder, loop.whileCondition);
-        loop_pre_check = kumirScalarAsBool_.createCallInstruction(&builder, lcond);
-        loop_pre_check->setName(std::string(basicName + "while_check"));
+        loop_pre_check = calculateCondition(builder, loop.whileCondition);
     }
 
     createFreeTempScalars(builder);
@@ -1265,6 +1333,9 @@ void LLVMGenerator::createLoop(llvm::IRBuilder<> &builder, const AST::StatementP
     // --- loop body
     currentBlock_ = loop_body;
     builder.SetInsertPoint(loop_body);
+    if (nativeFor) {
+        storeNativeScalar(builder, loop_variable, next_value, AST::TypeInteger);
+    }
     addFunctionBody(loop.body, alg);
     builder.SetInsertPoint(currentBlock_); // might be changed via inner block
     if (currentBlock_->size() && currentBlock_->back().isTerminator()) {
@@ -1278,16 +1349,9 @@ void LLVMGenerator::createLoop(llvm::IRBuilder<> &builder, const AST::StatementP
     // --- check for end condition
     builder.SetInsertPoint(loop_end);
     if (loop.endCondition) {
-        llvm::Value * endCond = calculate(builder, loop.endCondition);
-        if (loop.endCondition->kind != AST::ExprVariable) {
-            endCond->setName(std::string(basicName + "end_condition"));
-        }
-        Q_ASSERT(endCond);
-        Q_ASSERT(kumirScalarAsBool_);
-        llvm::CallInst * endBoolCondInst = kumirScalarAsBool_.createCallInstruction(&builder, endCond);
-        endBoolCondInst->setName(std::string(basicName+"end_condition_boolean"));
-        llvm::Value * endBoolCond = endBoolCondInst;
+        llvm::Value * endBoolCond = calculateCondition(builder, loop.endCondition);
         Q_ASSERT(endBoolCond);
+        createFreeTempScalars(builder);
         builder.CreateCondBr(endBoolCond,
                              loop_clean, // True
                              loop_begin // False
@@ -1329,7 +1393,7 @@ void LLVMGenerator::createLoop(llvm::IRBuilder<> &builder, const AST::StatementP
 
     // --- clean counters if need
     builder.SetInsertPoint(loop_clean);
-    if (loop.type == AST::LoopFor || loop.type == AST::LoopTimes) {
+    if ((loop.type == AST::LoopFor || loop.type == AST::LoopTimes) && !nativeFor && !nativeTimes) {
         kumirLoopEndCounter_.createCallInstruction(&builder);
     }
     createFreeTempScalars(builder);
@@ -1367,14 +1431,7 @@ void LLVMGenerator::createIfThenElse(llvm::IRBuilder<> &builder, const AST::Stat
 
     // --- calculate condition
     Q_ASSERT(thenSpec.condition);
-    llvm::Value * cond = calculate(builder, thenSpec.condition);
-    Q_ASSERT(cond);
-    if (thenSpec.condition->kind != AST::ExprVariable)
-        cond->setName(std::string(basicName + "condition"));
-    Q_ASSERT(kumirScalarAsBool_);
-    llvm::CallInst * condBoolCall = kumirScalarAsBool_.createCallInstruction(&builder, cond);
-    condBoolCall->setName(std::string(basicName + "condition_boolean"));
-    llvm::Value * condBool = condBoolCall;
+    llvm::Value * condBool = calculateCondition(builder, thenSpec.condition);
     Q_ASSERT(condBool);
     createFreeTempScalars(builder);
     builder.CreateCondBr(condBool, then, elze);
@@ -1515,15 +1572,7 @@ void LLVMGenerator::createSwitchCaseElse(llvm::IRBuilder<> &builder, const AST::
             kumirAbortOnError_.createCallInstruction(&builder, lerr);
         }
         if (spec.condition) {
-            llvm::Value * cond = calculate(builder, spec.condition);
-            Q_ASSERT(cond);
-            if (spec.condition->kind != AST::ExprVariable)
-                cond->setName(caze->getName() + "_condition");
-            Q_ASSERT(kumirScalarAsBool_);
-            llvm::CallInst* condBoolInst =
-                    kumirScalarAsBool_.createCallInstruction(&builder, cond);
-            condBoolInst->setName(cond->getName() + std::string("_boolean"));
-            llvm::Value * condBool = condBoolInst;
+            llvm::Value * condBool = calculateCondition(builder, spec.condition);
             Q_ASSERT(condBool);
             createFreeTempScalars(builder);
             builder.CreateCondBr(condBool, body, nextBlock);
@@ -1668,6 +1717,402 @@ llvm::Value * LLVMGenerator::calculate(llvm::IRBuilder<> &builder, const AST::Ex
     return result;
 }
 
+bool LLVMGenerator::isNativeScalarType(const AST::VariableBaseType type)
+{
+    return AST::TypeInteger == type || AST::TypeReal == type || AST::TypeBoolean == type;
+}
+
+bool LLVMGenerator::isNativeScalar(const AST::ExpressionPtr &ex)
+{
+    return ex && 0u == ex->dimension && isNativeScalarType(ex->baseType.kind);
+}
+
+llvm::Type * LLVMGenerator::getNativeType(const AST::VariableBaseType type)
+{
+    if (AST::TypeInteger == type) {
+        return llvm::Type::getInt32Ty(*context_);
+    }
+    else if (AST::TypeReal == type) {
+        return llvm::Type::getDoubleTy(*context_);
+    }
+    else {
+        return llvm::Type::getInt1Ty(*context_);
+    }
+}
+
+llvm::Value * LLVMGenerator::createScalarFieldPtr(Builder &builder, llvm::Value *scalar, unsigned field)
+{
+#if LLVM_VERSION_MINOR >= 7
+    return builder.CreateStructGEP(nullptr, scalar, field);
+#else
+    return builder.CreateStructGEP(scalar, field);
+#endif
+}
+
+void LLVMGenerator::createRuntimeCheck(Builder &builder, llvm::Value *condition, LLVM::FunctionRef onFailure, llvm::Value *argument)
+{
+    llvm::BasicBlock * failed = llvm::BasicBlock::Create(*context_, "check_failed", currentFunction_.rawPtr());
+    llvm::BasicBlock * passed = llvm::BasicBlock::Create(*context_, "check_passed", currentFunction_.rawPtr());
+    builder.CreateCondBr(condition, passed, failed);
+
+    builder.SetInsertPoint(failed);
+    if (argument) {
+        onFailure.createCallInstruction(&builder, argument);
+    }
+    else {
+        onFailure.createCallInstruction(&builder);
+    }
+    builder.CreateBr(passed); // never reached as runtime aborts
+
+    builder.SetInsertPoint(passed);
+    currentBlock_ = passed;
+}
+
+llvm::Value * LLVMGenerator::loadNativeScalar(Builder &builder, llvm::Value *scalar, const AST::VariableBaseType type, bool checkDefined)
+{
+    if (checkDefined) {
+        llvm::Value * defined = builder.CreateLoad(createScalarFieldPtr(builder, scalar, 0));
+        llvm::Value * isDefined = builder.CreateICmpNE(defined, llvm::ConstantInt::get(defined->getType(), 0));
+        createRuntimeCheck(builder, isDefined, kumirCheckValueDefined_, scalar);
+    }
+
+    llvm::Value * data = createScalarFieldPtr(builder, scalar, 2);
+    if (AST::TypeBoolean == type) {
+        llvm::Value * value = builder.CreateLoad(builder.CreateBitCast(data, llvm::Type::getInt8PtrTy(*context_)));
+        return builder.CreateICmpNE(value, llvm::ConstantInt::get(value->getType(), 0));
+    }
+    else {
+        return builder.CreateLoad(builder.CreateBitCast(data, getNativeType(type)->getPointerTo()));
+    }
+}
+
+static void storeScalarHeader(LLVMGenerator * generator, LLVMGenerator::Builder &builder,
+                              llvm::Value *scalar, const AST::VariableBaseType type, bool defined)
+{
+    __kumir_scalar_type typee = __KUMIR_BOOL;
+    if (AST::TypeInteger == type) {
+        typee = __KUMIR_INT;
+    }
+    else if (AST::TypeReal == type) {
+        typee = __KUMIR_REAL;
+    }
+
+    llvm::Value * definedPtr = generator->createScalarFieldPtr(builder, scalar, 0);
+    llvm::Type * definedType = llvm::cast<llvm::PointerType>(definedPtr->getType())->getElementType();
+    builder.CreateStore(llvm::ConstantInt::get(definedType, defined ? 1 : 0), definedPtr);
+
+    llvm::Value * typePtr = generator->createScalarFieldPtr(builder, scalar, 1);
+    llvm::Type * typeType = llvm::cast<llvm::PointerType>(typePtr->getType())->getElementType();
+    builder.CreateStore(llvm::ConstantInt::get(typeType, typee), typePtr);
+}
+
+void LLVMGenerator::storeNativeScalar(Builder &builder, llvm::Value *scalar, llvm::Value *value, const AST::VariableBaseType type)
+{
+    storeScalarHeader(this, builder, scalar, type, true);
+
+    llvm::Value * data = createScalarFieldPtr(builder, scalar, 2);
+    if (AST::TypeBoolean == type) {
+        llvm::Type * byteType = llvm::Type::getInt8Ty(*context_);
+        builder.CreateStore(builder.CreateZExt(value, byteType),
+                            builder.CreateBitCast(data, byteType->getPointerTo()));
+    }
+    else {
+        builder.CreateStore(value, builder.CreateBitCast(data, getNativeType(type)->getPointerTo()));
+    }
+}
+
+void LLVMGenerator::createUndefinedNativeScalar(Builder &builder, llvm::Value *scalar, const AST::VariableBaseType type)
+{
+    storeScalarHeader(this, builder, scalar, type, false);
+}
+
+llvm::Value * LLVMGenerator::createNativeConversion(Builder &builder, llvm::Value *value, const AST::VariableBaseType from, const AST::VariableBaseType to)
+{
+    if (from == to) {
+        return value;
+    }
+    else if (AST::TypeInteger == from && AST::TypeReal == to) {
+        return builder.CreateSIToFP(value, getNativeType(to));
+    }
+    Q_ASSERT_X(false, "LLVMGenerator::createNativeConversion", "Unsupported conversion");
+    return value;
+}
+
+llvm::Value * LLVMGenerator::calculateNative(Builder &builder, const AST::ExpressionPtr &ex, const AST::VariableBaseType type)
+{
+    Q_ASSERT(isNativeScalar(ex));
+    llvm::Value * result = 0;
+    if (ex->useFromCache || ex->keepInCache) {
+        // Cached values are shared between statements, so keep them boxed
+        result = loadNativeScalar(builder, calculate(builder, ex), ex->baseType.kind);
+    }
+    else if (ex->kind == AST::ExprConst) {
+        if (AST::TypeInteger == ex->baseType.kind) {
+            result = llvm::ConstantInt::getSigned(getNativeType(AST::TypeInteger), ex->constant.toInt());
+        }
+        else if (AST::TypeReal == ex->baseType.kind) {
+            result = llvm::ConstantFP::get(*context_, llvm::APFloat(ex->constant.toDouble()));
+        }
+        else {
+            result = ex->constant.toBool()
+                    ? llvm::ConstantInt::getTrue(*context_)
+                    : llvm::ConstantInt::getFalse(*context_);
+        }
+    }
+    else if (ex->kind == AST::ExprVariable) {
+        result = loadNativeScalar(builder, findVariableAtCurrentContext(ex->variable), ex->baseType.kind);
+    }
+    else if (ex->kind == AST::ExprSubexpression) {
+        result = createNativeSubExpression(builder, ex);
+    }
+    else if (ex->kind == AST::ExprArrayElement &&
+             ex->operands.size() == ex->variable->dimension &&
+             hasNativeArrayIndices(ex))
+    {
+        llvm::Value * element = createNativeArrayElementPtr(builder, ex, true);
+        result = loadNativeScalar(builder, element, ex->baseType.kind, false);
+    }
+    if (!result) {
+        // Function calls, array elements with non-native indices and
+        // not supported operators are evaluated by runtime into boxed scalars
+        result = loadNativeScalar(builder, calculate(builder, ex), ex->baseType.kind);
+    }
+    return createNativeConversion(builder, result, ex->baseType.kind, type);
+}
+
+llvm::Value * LLVMGenerator::calculateCondition(Builder &builder, const AST::ExpressionPtr &ex)
+{
+    if (isNativeScalar(ex)) {
+        return calculateNative(builder, ex, AST::TypeBoolean);
+    }
+    llvm::Value * cond = calculate(builder, ex);
+    Q_ASSERT(cond);
+    Q_ASSERT(kumirScalarAsBool_);
+    return kumirScalarAsBool_.createCallInstruction(&builder, cond);
+}
+
+llvm::Value * LLVMGenerator::createNativeSubExpression(Builder &builder, const AST::ExpressionPtr &ex)
+{
+    const AST::ExpressionOperator op = ex->operatorr;
+    if (op == AST::OpAnd || op == AST::OpOr) {
+        if (2 == ex->operands.size() && isNativeScalar(ex->operands[0]) && isNativeScalar(ex->operands[1])) {
+            return createNativeShortCircuitOperation(builder, ex);
+        }
+        return 0;
+    }
+    if (op == AST::OpPower || op == AST::OpNone) {
+        return 0;
+    }
+    for (int i=0; i<ex->operands.size(); i++) {
+        if (!isNativeScalar(ex->operands[i])) {
+            return 0;
+        }
+    }
+
+    if (1 == ex->operands.size()) {
+        const AST::VariableBaseType type = ex->operands[0]->baseType.kind;
+        if (op == AST::OpNot && AST::TypeBoolean == type) {
+            return builder.CreateNot(calculateNative(builder, ex->operands[0], type));
+        }
+        else if (op == AST::OpSubstract && AST::TypeInteger == type) {
+            return builder.CreateNeg(calculateNative(builder, ex->operands[0], type));
+        }
+        else if (op == AST::OpSubstract && AST::TypeReal == type) {
+            // Same as runtime's 0.0-x, which gives +0.0 (not -0.0) for zero
+            llvm::Value * zero = llvm::ConstantFP::get(*context_, llvm::APFloat(0.0));
+            return builder.CreateFSub(zero, calculateNative(builder, ex->operands[0], type));
+        }
+        return 0;
+    }
+    if (2 != ex->operands.size()) {
+        return 0;
+    }
+
+    const AST::VariableBaseType leftType = ex->operands[0]->baseType.kind;
+    const AST::VariableBaseType rightType = ex->operands[1]->baseType.kind;
+    const bool isComparison = op == AST::OpEqual || op == AST::OpNotEqual ||
+            op == AST::OpLess || op == AST::OpGreater ||
+            op == AST::OpLessOrEqual || op == AST::OpGreaterOrEqual;
+    const bool isBoolOperands = AST::TypeBoolean == leftType || AST::TypeBoolean == rightType;
+    if (!isComparison && op != AST::OpSumm && op != AST::OpSubstract &&
+            op != AST::OpMultiply && op != AST::OpDivision)
+    {
+        return 0;
+    }
+
+    if (isBoolOperands) {
+        if (leftType != rightType || (op != AST::OpEqual && op != AST::OpNotEqual)) {
+            return 0;
+        }
+        llvm::Value * l = calculateNative(builder, ex->operands[0], AST::TypeBoolean);
+        llvm::Value * r = calculateNative(builder, ex->operands[1], AST::TypeBoolean);
+        return op == AST::OpEqual ? builder.CreateICmpEQ(l, r) : builder.CreateICmpNE(l, r);
+    }
+
+    // Integer arithmetics is performed only on both integer operands,
+    // as well as runtime does; division always produces real value
+    const AST::VariableBaseType operandsType =
+            AST::TypeInteger == leftType && AST::TypeInteger == rightType && op != AST::OpDivision
+            ? AST::TypeInteger : AST::TypeReal;
+    llvm::Value * l = calculateNative(builder, ex->operands[0], operandsType);
+    llvm::Value * r = calculateNative(builder, ex->operands[1], operandsType);
+
+    if (isComparison) {
+        if (AST::TypeInteger == operandsType) {
+            switch (op) {
+            case AST::OpEqual:          return builder.CreateICmpEQ(l, r);
+            case AST::OpNotEqual:       return builder.CreateICmpNE(l, r);
+            case AST::OpLess:           return builder.CreateICmpSLT(l, r);
+            case AST::OpGreater:        return builder.CreateICmpSGT(l, r);
+            case AST::OpLessOrEqual:    return builder.CreateICmpSLE(l, r);
+            default:                    return builder.CreateICmpSGE(l, r);
+            }
+        }
+        else {
+            switch (op) {
+            case AST::OpEqual:          return builder.CreateFCmpOEQ(l, r);
+            case AST::OpNotEqual:       return builder.CreateFCmpUNE(l, r);
+            case AST::OpLess:           return builder.CreateFCmpOLT(l, r);
+            case AST::OpGreater:        return builder.CreateFCmpOGT(l, r);
+            case AST::OpLessOrEqual:    return builder.CreateFCmpOLE(l, r);
+            default:                    return builder.CreateFCmpOGE(l, r);
+            }
+        }
+    }
+
+    if (AST::TypeInteger == operandsType) {
+        llvm::Intrinsic::ID id = llvm::Intrinsic::sadd_with_overflow;
+        if      (op == AST::OpSubstract)    id = llvm::Intrinsic::ssub_with_overflow;
+        else if (op == AST::OpMultiply)     id = llvm::Intrinsic::smul_with_overflow;
+        std::vector<llvm::Type*> types(1, getNativeType(AST::TypeInteger));
+        llvm::Function * intrinsic = llvm::Intrinsic::getDeclaration(currentModule_.rawPtr(), id, types);
+        llvm::Value * args[2] = { l, r };
+        llvm::Value * pair = builder.CreateCall(intrinsic, llvm::ArrayRef<llvm::Value*>(args, 2));
+        llvm::Value * overflow = builder.CreateExtractValue(pair, 1);
+        createRuntimeCheck(builder, builder.CreateNot(overflow), kumirAbortOnIntegerOverflow_);
+        return builder.CreateExtractValue(pair, 0);
+    }
+
+    llvm::Value * result = 0;
+    if (op == AST::OpSumm) {
+        result = builder.CreateFAdd(l, r);
+    }
+    else if (op == AST::OpSubstract) {
+        result = builder.CreateFSub(l, r);
+    }
+    else if (op == AST::OpMultiply) {
+        result = builder.CreateFMul(l, r);
+    }
+    else {
+        llvm::Value * zero = llvm::ConstantFP::get(*context_, llvm::APFloat(0.0));
+        createRuntimeCheck(builder, builder.CreateFCmpUNE(r, zero), kumirAbortOnDivisionByZero_);
+        result = builder.CreateFDiv(l, r);
+    }
+    // x-x is zero for finite x only
+    llvm::Value * zero = llvm::ConstantFP::get(*context_, llvm::APFloat(0.0));
+    llvm::Value * finite = builder.CreateFCmpOEQ(builder.CreateFSub(result, result), zero);
+    createRuntimeCheck(builder, finite, kumirAbortOnRealOverflow_);
+    return result;
+}
+
+llvm::Value * LLVMGenerator::createNativeShortCircuitOperation(Builder &builder, const AST::ExpressionPtr &ex)
+{
+    const bool isAnd = ex->operatorr == AST::OpAnd;
+    llvm::Value * left = calculateNative(builder, ex->operands[0], AST::TypeBoolean);
+    llvm::BasicBlock * leftDone = builder.GetInsertBlock();
+    llvm::BasicBlock * checkNext = llvm::BasicBlock::Create(*context_,
+                                                            isAnd ? "sc_and_check_next" : "sc_or_check_next",
+                                                            currentFunction_.rawPtr());
+    llvm::BasicBlock * done = llvm::BasicBlock::Create(*context_,
+                                                       isAnd ? "sc_and_done" : "sc_or_done",
+                                                       currentFunction_.rawPtr());
+    if (isAnd) {
+        builder.CreateCondBr(left, checkNext, done);
+    }
+    else {
+        builder.CreateCondBr(left, done, checkNext);
+    }
+
+    builder.SetInsertPoint(checkNext);
+    currentBlock_ = checkNext;
+    llvm::Value * right = calculateNative(builder, ex->operands[1], AST::TypeBoolean);
+    llvm::BasicBlock * rightDone = builder.GetInsertBlock();
+    builder.CreateBr(done);
+
+    builder.SetInsertPoint(done);
+    currentBlock_ = done;
+    llvm::PHINode * result = builder.CreatePHI(llvm::Type::getInt1Ty(*context_), 2);
+    result->addIncoming(left, leftDone);
+    result->addIncoming(right, rightDone);
+    return result;
+}
+
+bool LLVMGenerator::hasNativeArrayIndices(const AST::ExpressionPtr &ex)
+{
+    if (AST::ExprArrayElement != ex->kind || 0u == ex->variable->dimension) {
+        return false;
+    }
+    for (int i=0; i<ex->variable->dimension; i++) {
+        const AST::ExpressionPtr & indexOperand = ex->operands[i];
+        if (!isNativeScalar(indexOperand) || AST::TypeInteger != indexOperand->baseType.kind) {
+            return false;
+        }
+    }
+    return true;
+}
+
+llvm::Value * LLVMGenerator::createArrayDescriptorLoad(Builder &builder, llvm::Value *array, unsigned field, unsigned dim)
+{
+    llvm::Type * indexType = llvm::Type::getInt32Ty(*context_);
+    llvm::Value * indices[3] = {
+        llvm::ConstantInt::get(indexType, 0),
+        llvm::ConstantInt::get(indexType, field),
+        llvm::ConstantInt::get(indexType, dim)
+    };
+    return builder.CreateLoad(builder.CreateInBoundsGEP(array, llvm::ArrayRef<llvm::Value*>(indices, 3)));
+}
+
+llvm::Value * LLVMGenerator::createNativeArrayElementPtr(Builder &builder, const AST::ExpressionPtr &ex, bool valueExpected)
+{
+    // __kumir_array fields: dim, size_left, size_right, shape_left, shape_right, data
+    llvm::Value * array = findVariableAtCurrentContext(ex->variable);
+    Q_ASSERT(array);
+    const unsigned dimension = ex->variable->dimension;
+    llvm::Value * inBounds = 0;
+    llvm::Value * offset = 0;
+    for (unsigned d=0; d<dimension; d++) {
+        llvm::Value * index = calculateNative(builder, ex->operands[d], AST::TypeInteger);
+        llvm::Value * shapeLeft = createArrayDescriptorLoad(builder, array, 3, d);
+        llvm::Value * shapeRight = createArrayDescriptorLoad(builder, array, 4, d);
+        llvm::Value * indexInBounds = builder.CreateAnd(builder.CreateICmpSGE(index, shapeLeft),
+                                                        builder.CreateICmpSLE(index, shapeRight));
+        inBounds = inBounds ? builder.CreateAnd(inBounds, indexInBounds) : indexInBounds;
+
+        // Row-major offset: data is allocated for size_left..size_right range
+        llvm::Value * sizeLeft = createArrayDescriptorLoad(builder, array, 1, d);
+        llvm::Value * position = builder.CreateNSWSub(index, sizeLeft);
+        if (offset) {
+            llvm::Value * sizeRight = createArrayDescriptorLoad(builder, array, 2, d);
+            llvm::Value * extent = builder.CreateNSWAdd(builder.CreateNSWSub(sizeRight, sizeLeft),
+                                                        llvm::ConstantInt::get(position->getType(), 1));
+            offset = builder.CreateNSWAdd(builder.CreateNSWMul(offset, extent), position);
+        }
+        else {
+            offset = position;
+        }
+    }
+    createRuntimeCheck(builder, inBounds, kumirAbortOnArrayIndexOutOfRange_);
+
+    llvm::Value * data = builder.CreateLoad(createScalarFieldPtr(builder, array, 5));
+    llvm::Value * element = builder.CreateInBoundsGEP(data, offset);
+    if (valueExpected) {
+        llvm::Value * defined = builder.CreateLoad(createScalarFieldPtr(builder, element, 0));
+        llvm::Value * isDefined = builder.CreateICmpNE(defined, llvm::ConstantInt::get(defined->getType(), 0));
+        createRuntimeCheck(builder, isDefined, kumirAbortOnUndefinedArrayElement_);
+    }
+    return element;
+}
+
 llvm::Value * LLVMGenerator::createArrayElementGet(llvm::IRBuilder<> &builder, const AST::ExpressionPtr &ex, bool isLvalue, AllocaPlace allocaPlace)
 {
     allocaPlace = BeforeTerminator;
@@ -1677,7 +2122,10 @@ llvm::Value * LLVMGenerator::createArrayElementGet(llvm::IRBuilder<> &builder, c
     args.reserve(20);
     llvm::Value * elemPtr = CreateAlloca(builder, getScalarType().pointerTo(), "", allocaPlace);
     Q_ASSERT(elemPtr);
-    if (ex->variable->dimension > 0u) {
+    if (hasNativeArrayIndices(ex)) {
+        builder.CreateStore(createNativeArrayElementPtr(builder, ex, !isLvalue), elemPtr);
+    }
+    else if (ex->variable->dimension > 0u) {
         args.push_back(elemPtr);
         if (!isLvalue) {
             args.push_back(llvm::ConstantInt::getTrue(*context_));
@@ -2111,6 +2559,14 @@ llvm::Value * LLVMGenerator::createSubExpession(llvm::IRBuilder<> &builder, cons
                                            ex->keepInCache? FunctionBegin : BeforeTerminator
                                            );
     }
+    if (isNativeScalar(ex)) {
+        llvm::Value * value = createNativeSubExpression(builder, ex);
+        if (value) {
+            llvm::Value * result = CreateAlloca(builder, getScalarType(), "", ex->keepInCache? FunctionBegin : BeforeTerminator);
+            storeNativeScalar(builder, result, value, ex->baseType.kind);
+            return result;
+        }
+    }
     QVector<llvm::Value*> operands(ex->operands.size());
 
     for (int i=0; i<ex->operands.size(); i++) {
@@ -2452,6 +2908,21 @@ void LLVMGenerator::readStdLibFunctions()
     kumirAbortOnError_ = stdlibModule_.getFunction("__kumir_abort_on_error");
     Q_ASSERT(kumirAbortOnError_);
 
+    kumirAbortOnIntegerOverflow_ = stdlibModule_.getFunction("__kumir_abort_on_integer_overflow");
+    Q_ASSERT(kumirAbortOnIntegerOverflow_);
+
+    kumirAbortOnRealOverflow_ = stdlibModule_.getFunction("__kumir_abort_on_real_overflow");
+    Q_ASSERT(kumirAbortOnRealOverflow_);
+
+    kumirAbortOnDivisionByZero_ = stdlibModule_.getFunction("__kumir_abort_on_division_by_zero");
+    Q_ASSERT(kumirAbortOnDivisionByZero_);
+
+    kumirAbortOnArrayIndexOutOfRange_ = stdlibModule_.getFunction("__kumir_abort_on_array_index_out_of_range");
+    Q_ASSERT(kumirAbortOnArrayIndexOutOfRange_);
+
+    kumirAbortOnUndefinedArrayElement_ = stdlibModule_.getFunction("__kumir_abort_on_undefined_array_element");
+    Q_ASSERT(kumirAbortOnUndefinedArrayElement_);
+
     kumirSetCurrentLineNumber_ = stdlibModule_.getFunction("__kumir_set_current_line_number");
     Q_ASSERT(kumirSetCurrentLineNumber_);
 
@@ -97,6 +97,31 @@ public:
     llvm::Value* createStringSliceGet(llvm::IRBuilder<> & builder, const AST::ExpressionPtr & ex, bool isLvalue, AllocaPlace allocaPlace);
     llvm::Value* findVariableAtCurrentContext(const AST::VariablePtr & var);
     void createFreeTempScalars(llvm::IRBuilder<> & builder);
+
+    // Native (unboxed) scalars: int, real and bool values in expressions,
+    // assignments and loop counters are computed as plain SSA values.
+    // Boxed __kumir_scalar storage is kept for variables, so LLVM can
+    // promote it to registers unless it escapes to stdlib or actor calls
+    static bool isNativeScalar(const AST::ExpressionPtr & ex);
+    static bool isNativeScalarType(const AST::VariableBaseType type);
+    llvm::Type* getNativeType(const AST::VariableBaseType type);
+    llvm::Value* calculateNative(Builder & builder, const AST::ExpressionPtr & ex, const AST::VariableBaseType type);
+    llvm::Value* calculateCondition(Builder & builder, const AST::ExpressionPtr & ex);
+    llvm::Value* createNativeSubExpression(Builder & builder, const AST::ExpressionPtr & ex);
+    llvm::Value* createNativeShortCircuitOperation(Builder & builder, const AST::ExpressionPtr & ex);
+    llvm::Value* createNativeConversion(Builder & builder, llvm::Value * value, const AST::VariableBaseType from, const AST::VariableBaseType to);
+    llvm::Value* createScalarFieldPtr(Builder & builder, llvm::Value * scalar, unsigned field);
+    llvm::Value* loadNativeScalar(Builder & builder, llvm::Value * scalar, const AST::VariableBaseType type, bool checkDefined = true);
+    void storeNativeScalar(Builder & builder, llvm::Value * scalar, llvm::Value * value, const AST::VariableBaseType type);
+    void createUndefinedNativeScalar(Builder & builder, llvm::Value * scalar, const AST::VariableBaseType type);
+    void createRuntimeCheck(Builder & builder, llvm::Value * condition, LLVM::FunctionRef onFailure, llvm::Value * argument = 0);
+
+    // Array elements indexed by native integers are addressed inline:
+    // bounds are read from __kumir_array descriptor and checked in place,
+    // so loop-invariant loads and checks are visible to LLVM optimizer
+    static bool hasNativeArrayIndices(const AST::ExpressionPtr & ex);
+    llvm::Value* createArrayDescriptorLoad(Builder & builder, llvm::Value * array, unsigned field, unsigned dim);
+    llvm::Value* createNativeArrayElementPtr(Builder & builder, const AST::ExpressionPtr & ex, bool valueExpected);
     void createOutputValue(Builder & builder, const QString & name, llvm::Value * value, const AST::VariableBaseType type, const bool isArray);
     void createInputValue(Builder & builder, const QString & name, llvm::Value * value, const AST::VariableBaseType type, const bool isArray);
 
@@ -202,6 +227,11 @@ public:
 
     LLVM::FunctionRef kumirAssert_;
     LLVM::FunctionRef kumirAbortOnError_;
+    LLVM::FunctionRef kumirAbortOnIntegerOverflow_;
+    LLVM::FunctionRef kumirAbortOnRealOverflow_;
+    LLVM::FunctionRef kumirAbortOnDivisionByZero_;
+    LLVM::FunctionRef kumirAbortOnArrayIndexOutOfRange_;
+    LLVM::FunctionRef kumirAbortOnUndefinedArrayElement_;
     LLVM::FunctionRef kumirSetCurrentLineNumber_;
     LLVM::FunctionRef kumirCheckValueDefined_;
     LLVM::FunctionRef kumirHalt_;
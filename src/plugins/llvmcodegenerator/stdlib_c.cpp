@@ -223,10 +223,45 @@ EXTERN void __kumir_modify_string(__kumir_stringref * lvalue, const __kumir_scal
 
 static int32_t __kumir_current_line_number = -1;
 
+// In-process (JIT) run must return control to caller instead of
+// terminating the whole application. It is left by C++ exception,
+// so destructors of runtime frames between caller and the point of
+// exit are called. Generated functions are not marked nounwind
+// in this mode (see LLVMCodeGeneratorPlugin::runInProcess).
+#if defined(__EXCEPTIONS) || defined(__cpp_exceptions) || defined(_CPPUNWIND)
+#   define KUMIR_IN_PROCESS_RUN_SUPPORTED
+#endif
+
+struct __kumir_in_process_exit {
+    int status;
+};
+
+static bool __kumir_in_process = false;
+static std::wstring __kumir_in_process_error;
+static Kumir::AbstractOutputBuffer * __kumir_in_process_output = 0;
+
+static void __kumir_exit(int status)
+{
+#ifdef KUMIR_IN_PROCESS_RUN_SUPPORTED
+    if (__kumir_in_process) {
+        __kumir_in_process_exit exitRequest;
+        exitRequest.status = status;
+        throw exitRequest;
+    }
+#endif
+    exit(status);
+}
+
 EXTERN void __kumir_halt()
 {
     const std::wstring message =
             Kumir::Core::fromUtf8("\nСТОП.");
+    if (__kumir_in_process) {
+        if (__kumir_in_process_output) {
+            __kumir_in_process_output->writeRawString(message);
+        }
+        __kumir_exit(0);
+    }
     Kumir::Encoding enc = Kumir::UTF8;
 #if defined(WIN32) || defined(_WIN32)
     enc = Kumir::CP866;
@@ -234,7 +269,7 @@ EXTERN void __kumir_halt()
     Kumir::EncodingError encodingError;
     const std::string loc_message = Kumir::Coder::encode(enc, message, encodingError);
     std::cout << loc_message;
-    exit(0);
+    __kumir_exit(0);
 }
 
 static int __kumir_call_stack_size = 0;
@@ -253,14 +288,23 @@ EXTERN void __kumir_pop_call_stack_counter()
     __kumir_call_stack_size --;
 }
 
-static void __kumir_handle_abort()
+static std::wstring __kumir_abort_message()
 {
-    const std::wstring message = __kumir_current_line_number == -1
+    return __kumir_current_line_number == -1
             ? Kumir::Core::fromUtf8("ОШИБКА ВЫПОЛНЕНИЯ: ") + Kumir::Core::getError()
             : Kumir::Core::fromUtf8("ОШИБКА ВЫПОЛНЕНИЯ В СТРОКЕ ") +
               Kumir::Converter::sprintfInt(__kumir_current_line_number, 10, 0, 0) +
               Kumir::Core::fromAscii(": ") +
               Kumir::Core::getError();
+}
+
+static void __kumir_handle_abort()
+{
+    const std::wstring message = __kumir_abort_message();
+    if (__kumir_in_process) {
+        __kumir_in_process_error = message;
+        __kumir_exit(1);
+    }
     Kumir::Encoding enc = Kumir::UTF8;
 #if defined(WIN32) || defined(_WIN32)
     enc = Kumir::CP866;
@@ -268,7 +312,7 @@ static void __kumir_handle_abort()
     Kumir::EncodingError encodingError;
     const std::string loc_message = Kumir::Coder::encode(enc, message, encodingError);
     std::cerr << loc_message << std::endl;
-    exit(1);
+    __kumir_exit(1);
 }
 
 EXTERN void __kumir_set_current_line_number(const int32_t line_no)
@@ -1693,6 +1737,31 @@ EXTERN void __kumir_abort_on_error(const char * message)
     Kumir::Core::abort(Kumir::Core::fromUtf8(std::string(message)));
 }
 
+EXTERN void __kumir_abort_on_integer_overflow()
+{
+    Kumir::Core::abort(Kumir::Core::fromUtf8("Целочисленное переполнение"));
+}
+
+EXTERN void __kumir_abort_on_real_overflow()
+{
+    Kumir::Core::abort(Kumir::Core::fromUtf8("Вещественное переполнение"));
+}
+
+EXTERN void __kumir_abort_on_division_by_zero()
+{
+    Kumir::Core::abort(Kumir::Core::fromUtf8("Деление на ноль"));
+}
+
+EXTERN void __kumir_abort_on_array_index_out_of_range()
+{
+    Kumir::Core::abort(Kumir::Core::fromUtf8("Выход за границу таблицы"));
+}
+
+EXTERN void __kumir_abort_on_undefined_array_element()
+{
+    Kumir::Core::abort(Kumir::Core::fromUtf8("Значение элемента таблицы не определено"));
+}
+
 EXTERN void __kumir_init_stdlib()
 {
     // Set stack size some greater...
@@ -2627,3 +2696,55 @@ EXTERN void Kumir_Standard_Library___init__()
     Kumir::initStandardLibrary();
 }
 
+int __kumir_run_in_process(int (*entryPoint)(int, char **), int argc, char **argv,
+                           Kumir::AbstractInputBuffer *input, Kumir::AbstractOutputBuffer *output,
+                           std::string &error)
+{
+    __kumir_current_line_number = -1;
+    __kumir_call_stack_size = 0;
+    __kumir_pipe_mode = false;
+    __kumir_main_arguments.clear();
+    __kumir_in_process_error.clear();
+    while (!for_counters.empty()) {
+        for_counters.pop();
+    }
+    Kumir::Files::setConsoleInputBuffer(input);
+    Kumir::Files::setConsoleOutputBuffer(output);
+    __kumir_in_process_output = output;
+
+    int status = 0;
+#ifdef KUMIR_IN_PROCESS_RUN_SUPPORTED
+    __kumir_in_process = true;
+    try {
+        status = entryPoint(argc, argv);
+    }
+    catch (const __kumir_in_process_exit & exitRequest) {
+        status = exitRequest.status;
+    }
+    __kumir_in_process = false;
+#else
+    (void) entryPoint; (void) argc; (void) argv;
+    __kumir_in_process_error = Kumir::Core::fromAscii("In-process run requires C++ exceptions support");
+    status = -1;
+#endif
+
+    // The application is reused for the next run, so files, buffers and
+    // redirections left by this program must not survive it, just as
+    // the VM cleans them up at the end of a run
+    Kumir::Core::AbortHandler = 0;
+    Kumir::finalizeStandardLibrary();
+    Kumir::Core::AbortHandler = &__kumir_handle_abort;
+    if (__kumir_in_process_error.empty() && Kumir::Core::getError().length() > 0) {
+        __kumir_current_line_number = -1;
+        __kumir_in_process_error = __kumir_abort_message();
+        status = 1;
+    }
+
+    Kumir::Files::setConsoleInputBuffer(nullptr);
+    Kumir::Files::setConsoleOutputBuffer(nullptr);
+    __kumir_in_process_output = 0;
+    Kumir::EncodingError encodingError;
+    error = Kumir::Coder::encode(Kumir::UTF8, __kumir_in_process_error, encodingError);
+    return status;
+}
+
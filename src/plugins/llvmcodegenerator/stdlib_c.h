@@ -57,6 +57,11 @@ EXTERN void __kumir_set_main_arguments(int argc, char ** argv);
 EXTERN void __kumir_set_current_line_number(const int32_t line_no);
 EXTERN void __kumir_assert(const __kumir_scalar * assumption);
 EXTERN void __kumir_abort_on_error(const char * message);
+EXTERN void __kumir_abort_on_integer_overflow();
+EXTERN void __kumir_abort_on_real_overflow();
+EXTERN void __kumir_abort_on_division_by_zero();
+EXTERN void __kumir_abort_on_array_index_out_of_range();
+EXTERN void __kumir_abort_on_undefined_array_element();
 
 EXTERN void __kumir_operator_eq(__kumir_scalar * result, const __kumir_scalar * left, const __kumir_scalar * right);
 EXTERN void __kumir_operator_ls(__kumir_scalar * result, const __kumir_scalar * left, const __kumir_scalar * right);
@@ -293,6 +298,17 @@ EXTERN void Files_get_console(__kumir_scalar * result);
 EXTERN void Files_operator_neq(__kumir_scalar * result, const __kumir_scalar * a, const __kumir_scalar * b);
 EXTERN void Files_operator_eq(__kumir_scalar * result, const __kumir_scalar * a, const __kumir_scalar * b);
 
+#ifdef __cplusplus
+#include <string>
+namespace Kumir { class AbstractInputBuffer; class AbstractOutputBuffer; }
+
+// Runs JIT-compiled 'main' within current process using console buffers
+// provided; runtime errors and 'стоп' return here instead of exit()
+int __kumir_run_in_process(int (*entryPoint)(int, char**), int argc, char ** argv,
+                           Kumir::AbstractInputBuffer * input, Kumir::AbstractOutputBuffer * output,
+                           std::string & error);
+#endif
+
 
 
 #endif // STDLIB_C_H
@@ -0,0 +1,64 @@
+/*
+ * Converts Robot fields from text (.fil) to binary (.rfb) format.
+ *
+ * Usage: fil2rfb FILE.fil [FILE.fil ...]
+ *        fil2rfb -o OUT.rfb FILE.fil
+ */
+
+#include "../../actors/robot/cfield.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+
+#include <stdio.h>
+
+using ActorRobot::ConsoleField;
+
+static int convert(const QString &inFileName, const QString &outFileName)
+{
+    ConsoleField field(1, 1);
+    const int error = field.loadFromFile(inFileName);
+    if (0 != error) {
+        fprintf(stderr, "%s: load error %d\n", qPrintable(inFileName), error);
+        return 1;
+    }
+    QFile out(outFileName);
+    if (!out.open(QIODevice::WriteOnly)) {
+        fprintf(stderr, "%s: %s\n", qPrintable(outFileName), qPrintable(out.errorString()));
+        return 1;
+    }
+    out.write(field.toBinary());
+    out.close();
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    QStringList inFileNames;
+    QString outFileName;
+    for (int i = 1; i < argc; i++) {
+        const QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg == "-o" && i + 1 < argc) {
+            outFileName = QString::fromLocal8Bit(argv[++i]);
+        }
+        else {
+            inFileNames.append(arg);
+        }
+    }
+    if (inFileNames.isEmpty() || (!outFileName.isEmpty() && inFileNames.size() > 1)) {
+        fprintf(stderr, "Usage: %s FILE.fil [FILE.fil ...]\n"
+                        "       %s -o OUT.%s FILE.fil\n",
+                argv[0], argv[0], ActorRobot::BINARY_FIELD_SUFFIX);
+        return 127;
+    }
+    int result = 0;
+    foreach (const QString &inFileName, inFileNames) {
+        const QFileInfo fi(inFileName);
+        const QString out = outFileName.isEmpty()
+                ? fi.path() + "/" + fi.completeBaseName() + "." + ActorRobot::BINARY_FIELD_SUFFIX
+                : outFileName;
+        result |= convert(inFileName, out);
+    }
+    return result;
+}
@@ -55,11 +55,13 @@ int usage(const char * programName)
         message  = Core::fromUtf8("Вызов:");
         message.push_back(_n);
         message += Core::fromUtf8("\t")+Core::fromUtf8(std::string(programName));
-        message += Core::fromUtf8(" [-ansi] ИМЯФАЙЛА.kod [ПАРАМ1 [ПАРАМ2 ... [ПАРАМn]]]");
+        message += Core::fromUtf8(" [-ansi] [--profile ПРОФИЛЬ.json] ИМЯФАЙЛА.kod [ПАРАМ1 [ПАРАМ2 ... [ПАРАМn]]]");
         message.push_back(_n);
         message.push_back(_n);
         message += Core::fromUtf8("\t-ansi\t\tИспользовть кодировку 1251 вместо 866 в терминале (только для Windows)");
         message.push_back(_n);
+        message += Core::fromUtf8("\t--profile ПРОФИЛЬ.json\tЗаписать профиль выполнения и стеки вызовов (ПРОФИЛЬ.folded)");
+        message.push_back(_n);
         message += Core::fromUtf8("\tИМЯФАЙЛА.kod\tИмя выполнеяемой программы");
         message.push_back(_n);
         message += Core::fromUtf8("\tПАРАМ1...ПАРАМn\tАргументы главного алгоритма Кумир-программы");
@@ -69,11 +71,13 @@ int usage(const char * programName)
         message  = Core::fromUtf8("Usage:");
         message.push_back(_n);
         message += Core::fromUtf8("\t")+Core::fromUtf8(std::string(programName));
-        message += Core::fromUtf8(" [-ansi] FILENAME.kod [ARG1 [ARG2 ... [ARGn]]]");
+        message += Core::fromUtf8(" [-ansi] [--profile PROFILE.json] FILENAME.kod [ARG1 [ARG2 ... [ARGn]]]");
         message.push_back(_n);
         message.push_back(_n);
         message += Core::fromUtf8("\t-ansi\t\tUse codepage 1251 instead of 866 in console (Windows only)");
         message.push_back(_n);
+        message += Core::fromUtf8("\t--profile PROFILE.json\tWrite execution profile and collapsed call stacks (PROFILE.folded)");
+        message.push_back(_n);
         message += Core::fromUtf8("\tFILENAME.kod\tKumir runtime file name");
         message.push_back(_n);
         message += Core::fromUtf8("\tARG1...ARGn\tKumir program main algorithm arguments");
@@ -109,6 +113,34 @@ int showErrorMessage(const String & message, int code) {
     }
 }
 
+static bool writeProfile(VM::Profiler & profiler, const std::string & fileName)
+{
+    profiler.finish();
+    std::ofstream json(fileName.c_str(), std::ios::out|std::ios::binary);
+    json << profiler.toJson();
+    json.close();
+    if (!json) {
+        std::cerr << "Can't write profile file: " << fileName << std::endl;
+        return false;
+    }
+    std::string stacksFileName = fileName;
+    static const std::string dotJson(".json");
+    if (stacksFileName.length() > dotJson.length() &&
+            stacksFileName.substr(stacksFileName.length()-dotJson.length()) == dotJson)
+    {
+        stacksFileName.resize(stacksFileName.length()-dotJson.length());
+    }
+    stacksFileName += ".folded";
+    std::ofstream stacks(stacksFileName.c_str(), std::ios::out|std::ios::binary);
+    stacks << profiler.toCollapsedStacks();
+    stacks.close();
+    if (!stacks) {
+        std::cerr << "Can't write profile file: " << stacksFileName << std::endl;
+        return false;
+    }
+    return true;
+}
+
 bool IsPluginExtern(const Bytecode::TableElem & e) {
     bool isExtern = e.type==Bytecode::EL_EXTERN;
     bool isKumirModule = e.fileName.length()>4 &&
@@ -185,6 +217,7 @@ int main(int argc, char *argv[])
     std::deque<std::string> args;
     bool testingMode = false;
     bool quietMode = false;
+    std::string profileFileName;
     for (int i=1; i<argc; i++) {
         std::string  arg(argv[i]);
         if (arg.length()==0)
@@ -194,6 +227,7 @@ int main(int argc, char *argv[])
         static const std::string minus_minus_testing("--test");
         static const std::string minus_p("-p");
         static const std::string minus_minus_pipe("--pipe");
+        static const std::string minus_minus_profile("--profile");
         if (programName.empty()) {
             if (arg==minus_t || arg==minus_minus_testing) {
                 testingMode = true;
@@ -204,6 +238,9 @@ int main(int argc, char *argv[])
             else if (arg==minus_ansi) {
                 IO::LOCALE_ENCODING = LOCALE = CP1251;
             }
+            else if (arg==minus_minus_profile && i+1<argc) {
+                profileFileName = std::string(argv[++i]);
+            }
             else {
                 programName = arg;
             }
@@ -287,6 +324,10 @@ int main(int argc, char *argv[])
         }
         vm.setEntryPoint(VM::KumirVM::EP_Testing);
     }
+    VM::Profiler profiler;
+    if (!profileFileName.empty()) {
+        vm.setProfiler(&profiler);
+    }
     vm.reset();
     vm.setDebugOff(true);
 
@@ -308,11 +349,18 @@ int main(int argc, char *argv[])
             else {
                 message = RUNTIME_ERROR + vm.error();
             }
+            if (!profileFileName.empty()) {
+                writeProfile(profiler, profileFileName);
+            }
             return showErrorMessage(message, 120);
             return 120;
         }
     }
 
+    if (!profileFileName.empty() && !writeProfile(profiler, profileFileName)) {
+        return 1;
+    }
+
     if (testingMode)
         return vm.returnCode();
     else
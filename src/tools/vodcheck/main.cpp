@@ -0,0 +1,75 @@
+/*
+ * Finds minimal number of commands to solve Vodoley task by breadth-first
+ * search over vessels states and optionally checks a solution length.
+ *
+ * Usage: vodcheck [-s] TASK.vod [COMMANDS_COUNT]
+ *   -s              print optimal solution, one command per line
+ *   COMMANDS_COUNT  number of commands in checked solution; exit code
+ *                   is 0 if it is optimal, 1 if it is longer and 3 if it
+ *                   is shorter than possible (so the count is wrong)
+ * Exit code is 2 if the task has no solution or can not be checked.
+ */
+
+#include "../../actors/vodoley/cvodoley.h"
+
+#include <QStringList>
+
+#include <stdio.h>
+
+using ActorVodoley::ConsoleVodoley;
+
+int main(int argc, char *argv[])
+{
+    bool printSolution = false;
+    QStringList arguments;
+    for (int i = 1; i < argc; i++) {
+        const QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg == "-s") {
+            printSolution = true;
+        }
+        else {
+            arguments.append(arg);
+        }
+    }
+    bool countGiven = false;
+    int count = 0;
+    if (arguments.size() == 2) {
+        count = arguments[1].toInt(&countGiven);
+    }
+    if (arguments.isEmpty() || arguments.size() > 2 || (arguments.size() == 2 && !countGiven)) {
+        fprintf(stderr, "Usage: %s [-s] TASK.vod [COMMANDS_COUNT]\n", argv[0]);
+        return 127;
+    }
+
+    ConsoleVodoley vodoley;
+    const QString error = vodoley.loadFromFile(arguments[0]);
+    if (!error.isEmpty()) {
+        fprintf(stderr, "%s: %s\n", qPrintable(arguments[0]), error.toLocal8Bit().constData());
+        return 2;
+    }
+    QList<ConsoleVodoley::Command> solution;
+    const int optimal = vodoley.optimalSolution(printSolution ? &solution : 0);
+    if (-1 == optimal) {
+        fprintf(stderr, "%s: no solution\n", qPrintable(arguments[0]));
+        return 2;
+    }
+    else if (optimal < 0) {
+        fprintf(stderr, "%s: too large to check\n", qPrintable(arguments[0]));
+        return 2;
+    }
+    printf("%d\n", optimal);
+    if (printSolution) {
+        foreach (const ConsoleVodoley::Command &command, solution) {
+            printf("%s\n", ConsoleVodoley::commandName(command).toLocal8Bit().constData());
+        }
+    }
+    if (countGiven) {
+        if (count < optimal) {
+            fprintf(stderr, "%s: %d commands is less than minimal %d\n",
+                    qPrintable(arguments[0]), count, optimal);
+            return 3;
+        }
+        return count == optimal ? 0 : 1;
+    }
+    return 0;
+}
@@ -158,6 +158,30 @@ def print_difference(gsdata, data, title):
         out.write(data + '\n')
 
 
+def check_written_file(dirname, filename):
+    "Compares a file written by program with ../new_standards/DIR/NAME.kum.file, if any"
+    gs_name = "../new_standards/" + dirname + "/" + filename + ".file"
+    if not os.path.exists(gs_name):
+        return
+    data_name = "../" + dirname + "/" + filename[0:-4] + ".txt"
+    if not os.path.exists(data_name):
+        out.write("File " + data_name + " not written by " + filename + "\n")
+        out.write("----------------------------\n")
+        return
+    f = open(data_name, 'r')
+    data = f.read()
+    f.close()
+    os.remove(data_name)
+    if data.startswith("\xEF\xBB\xBF"):
+        data = data[3:]
+    f = open(gs_name, 'r')
+    gsdata = f.read()
+    f.close()
+    if gsdata != data:
+        print_difference(gsdata, data, "written file for " + filename)
+        out.write("----------------------------\n")
+
+
 def ask_difference(filename, data, title):
     f = open(filename, 'r')
     gsdata = f.read()
@@ -283,6 +307,7 @@ def process_file(filename):
         if old_rterror != new_rterror:
             print_difference(old_rterror, new_rterror, "runtime error for " + filename)
             out.write("----------------------------\n")
+    check_written_file(dirname, filename)
 
 
 def chunkIt(seq, num):
@@ -409,6 +434,7 @@ def process_dir(dirname):
                 if old_rterror != new_rterror:
                     print_difference(old_rterror, new_rterror, "runtime error for " + filename)
                     out.write("----------------------------\n")
+        check_written_file(dirname, filename)
 
 
 if __name__ == "__main__":